@@ -0,0 +1,123 @@
+/*
+  Pop'n Convertible Arcade Style Controller Project
+ 
+  Copyright 2011 Sam Wong (Sam /@/ hellosam /./ net)
+
+  This work is licensed under the Creative Commons Attribution 3.0 
+  Hong Kong License. 
+
+  To view a copy of this license, visit 
+  http://creativecommons.org/licenses/by/3.0/hk/ or send a letter to 
+  Creative Commons, 444 Castro Street, Suite 900, 
+  Mountain View, California, 94041, USA.  
+*/
+
+#include "Boot.h"
+#include "Telemetry.h"
+#include "Watchdog.h"
+
+#include <LUFA/Scheduler/DeadlineScheduler.h>
+
+#include <util/atomic.h>
+#include <stdbool.h>
+
+/// Microseconds per scheduler tick (8 at 8MHz)
+#define BOOT_US_PER_TICK (64000000UL / F_CPU)
+
+/// Milestone times, in microseconds
+static uint32_t times[BOOT_MARK_COUNT];
+/// [Bitmap] Milestones stamped so far
+static uint8_t marked;
+/// [Bitmap] Milestones reached in an ISR, yet to be stamped
+static volatile uint8_t pending;
+/// Set once every milestone is stamped
+static volatile bool done;
+/// Scheduler ticks since Boot_Start(), up to lastTick
+static uint32_t ticks;
+static uint16_t lastTick;
+
+/** Call right after DeadlineScheduler_Init() */
+void Boot_Start(void)
+{
+    lastTick = DeadlineScheduler_GetTime();
+}
+
+/** Ticks since Boot_Start(); at least every ~0.5s or the timer laps. Main thread only. */
+static uint32_t Boot_Now(void)
+{
+    uint16_t tick = DeadlineScheduler_GetTime();
+
+    ticks += (uint16_t) (tick - lastTick);
+    lastTick = tick;
+
+    return ticks;
+}
+
+/** Stamp a milestone the first time it is reached; main thread only */
+void Boot_Mark(uint8_t mark)
+{
+    if (!(marked & (1 << mark)))
+    {
+        times[mark] = Boot_Now() * BOOT_US_PER_TICK;
+        marked |= (1 << mark);
+    }
+}
+
+/** Note a milestone reached in an ISR, for the next Boot_Poll() to stamp */
+void Boot_MarkFromISR(uint8_t mark)
+{
+    pending |= (1 << mark);
+}
+
+/** Stamp the milestones reached in ISRs, and keep the tick count running until the boot is over */
+void Boot_Poll(void)
+{
+    uint8_t reached;
+    uint8_t mark;
+
+    if (done)
+      return;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        reached = pending;
+        pending = 0;
+    }
+
+    for (mark = 0; mark < BOOT_MARK_COUNT; mark++)
+    {
+        if (reached & (1 << mark))
+          Boot_Mark(mark);
+    }
+
+    Boot_Now();
+
+    if (marked == (1 << BOOT_MARK_COUNT) - 1)
+    {
+        // The stamps are complete before the SOF event can see done
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+        {
+            done = true;
+        }
+    }
+}
+
+#if defined(TELEMETRY_ENABLED)
+/** Send the stamps, then the reset record, once the boot is over. From the SOF event, the single telemetry producer. */
+void Boot_StartOfFrame(void)
+{
+    static bool sent;
+
+    if (sent || !done)
+      return;
+
+    Telemetry_SendFrame(TELEMETRY_FRAME_BOOT, (const uint8_t*) times, sizeof(times));
+    Watchdog_SendReset();
+    sent = true;
+}
+#endif
+
+const uint32_t* Boot_GetTimes(void)
+{
+    return times;
+}
@@ -0,0 +1,57 @@
+/*
+  Pop'n Convertible Arcade Style Controller Project
+ 
+  Copyright 2011 Sam Wong (Sam /@/ hellosam /./ net)
+
+  This work is licensed under the Creative Commons Attribution 3.0 
+  Hong Kong License. 
+
+  To view a copy of this license, visit 
+  http://creativecommons.org/licenses/by/3.0/hk/ or send a letter to 
+  Creative Commons, 444 Castro Street, Suite 900, 
+  Mountain View, California, 94041, USA.  
+*/
+
+#ifndef _BOOT_H_
+#define _BOOT_H_
+
+#include <stdint.h>
+
+/** Cold boot timing.
+ *
+ * Each milestone of the power-on path is stamped once, in microseconds
+ * since the scheduler timer started (right after the clock prescaler is
+ * set). Timer 1 only counts to ~0.5s, so Boot_Poll() folds its ticks into
+ * a 32-bit count from the report task until the last milestone. With
+ * TELEMETRY_ENABLED the stamps are then sent as a TELEMETRY_FRAME_BOOT by
+ * Boot_StartOfFrame(), followed by the watchdog's TELEMETRY_FRAME_RESET,
+ * as telemetry only has the SOF event as producer.
+ *
+ * Timer 1 may not be read from an ISR (see DeadlineScheduler.h), so a
+ * milestone reached in an ISR is passed to Boot_MarkFromISR(), and only
+ * stamped by the next Boot_Poll(): up to a report task period late.
+ *
+ * The bus reset and configuration times mostly measure the host; the
+ * time from configured to first report is the firmware's own.
+ */
+
+/// Milestones, in the order they normally happen
+enum
+{
+    BOOT_MARK_USB_ATTACHED,
+    BOOT_MARK_BUS_RESET,
+    BOOT_MARK_CONFIGURED,
+    BOOT_MARK_FIRST_REPORT,
+    BOOT_MARK_COUNT
+};
+
+void Boot_Start(void);
+void Boot_Poll(void);
+void Boot_Mark(uint8_t mark);
+void Boot_MarkFromISR(uint8_t mark);
+#if defined(TELEMETRY_ENABLED)
+void Boot_StartOfFrame(void);
+#endif
+const uint32_t* Boot_GetTimes(void);
+
+#endif
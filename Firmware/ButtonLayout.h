@@ -0,0 +1,80 @@
+/*
+  Pop'n Convertible Arcade Style Controller Project
+ 
+  Copyright 2011 Sam Wong (Sam /@/ hellosam /./ net)
+
+  This work is licensed under the Creative Commons Attribution 3.0 
+  Hong Kong License. 
+
+  To view a copy of this license, visit 
+  http://creativecommons.org/licenses/by/3.0/hk/ or send a letter to 
+  Creative Commons, 444 Castro Street, Suite 900, 
+  Mountain View, California, 94041, USA.  
+*/
+
+#ifndef _BUTTONLAYOUT_H_
+#define _BUTTONLAYOUT_H_
+
+/** Button report layout, the one place it is defined.
+ *
+ * Each table lists a player's buttons in report bit order, as the HID
+ * keyboard usage each one reports. The report descriptors, the report
+ * sizes and the report packer in PopnAsc.c are all expanded from these
+ * tables at compile time, so adding, removing or reordering a button is
+ * a one-line change here. Reports are one bit per button, padded to
+ * whole bytes.
+ */
+
+/// Usages of the player 1 buttons (HID_REPORTID_BUTTONS)
+#define PLAYER1_BUTTONS(X)                                                   \
+    X(0x1E) /* Keyboard 1 and ! */                                           \
+    X(0x1F) /* Keyboard 2 and @ */                                           \
+    X(0x20) /* Keyboard 3 and # */                                           \
+    X(0x21) /* Keyboard 4 and $ */                                           \
+    X(0x22) /* Keyboard 5 and % */                                           \
+    X(0x23) /* Keyboard 6 and ^ */                                           \
+    X(0x24) /* Keyboard 7 and & */                                           \
+    X(0x25) /* Keyboard 8 and * */                                           \
+    X(0x26) /* Keyboard 9 and ( */
+
+/// Usages of the player 2 buttons (TWO_PLAYER_ENABLED), which follow player 1's inputs
+#define PLAYER2_BUTTONS(X)                                                   \
+    X(0x59) /* Keypad 1 and End */                                           \
+    X(0x5A) /* Keypad 2 and Down Arrow */                                    \
+    X(0x5B) /* Keypad 3 and PageDn */                                        \
+    X(0x5C) /* Keypad 4 and Left Arrow */                                    \
+    X(0x5D) /* Keypad 5 */                                                   \
+    X(0x5E) /* Keypad 6 and Right Arrow */                                   \
+    X(0x5F) /* Keypad 7 and Home */                                          \
+    X(0x60) /* Keypad 8 and Up Arrow */                                      \
+    X(0x61) /* Keypad 9 and PageUp */
+
+#define BUTTON_LAYOUT_ONE(Usage)        + 1
+#define BUTTON_LAYOUT_INPUT(Usage)      0x09, (Usage), 0x81, 0x02,
+
+/// Number of buttons in a table; usable in #if
+#define BUTTON_LAYOUT_COUNT(Table)      (0 Table(BUTTON_LAYOUT_ONE))
+
+/// Report bytes of a number of buttons, and the mask of the bits used in the last byte
+#define BUTTON_REPORT_BYTES(Count)      (((Count) + 7) / 8)
+#define BUTTON_REPORT_PADDING(Count)    (BUTTON_REPORT_BYTES(Count) * 8 - (Count))
+#define BUTTON_REPORT_LAST_MASK(Count)  (0xFF >> BUTTON_REPORT_PADDING(Count))
+
+/** HID report items of a table's buttons, one bit each; follow with BUTTON_REPORT_PADDING_ITEMS
+ *  when BUTTON_REPORT_PADDING() is not zero. Each button is its own one-bit INPUT, so any usages
+ *  work in any order, and parsers with a short usage stack (LUFA's holds 8) never see a list.
+ */
+#define BUTTON_REPORT_ITEMS(Table)                                           \
+    0x05, 0x07,                    /* USAGE_PAGE (Keyboard) */               \
+    0x15, 0x00,                    /* LOGICAL_MINIMUM (0) */                 \
+    0x25, 0x01,                    /* LOGICAL_MAXIMUM (1) */                 \
+    0x75, 0x01,                    /* REPORT_SIZE (1) */                     \
+    0x95, 0x01,                    /* REPORT_COUNT (1) */                    \
+    Table(BUTTON_LAYOUT_INPUT)     /* USAGE (...), INPUT (Data,Var,Abs) */
+
+#define BUTTON_REPORT_PADDING_ITEMS(Table)                                   \
+    0x75, BUTTON_REPORT_PADDING(BUTTON_LAYOUT_COUNT(Table)), /* REPORT_SIZE */ \
+    0x95, 0x01,                    /* REPORT_COUNT (1) */                    \
+    0x81, 0x03,                    /* INPUT (Cnst,Var,Abs) */
+
+#endif
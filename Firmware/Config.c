@@ -0,0 +1,271 @@
+/*
+  Pop'n Convertible Arcade Style Controller Project
+ 
+  Copyright 2011 Sam Wong (Sam /@/ hellosam /./ net)
+
+  This work is licensed under the Creative Commons Attribution 3.0 
+  Hong Kong License. 
+
+  To view a copy of this license, visit 
+  http://creativecommons.org/licenses/by/3.0/hk/ or send a letter to 
+  Creative Commons, 444 Castro Street, Suite 900, 
+  Mountain View, California, 94041, USA.  
+*/
+
+#include "Config.h"
+#include "PopnAsc.h"
+#include "Remap.h"
+#include "Pattern.h"
+#include "HallInputs.h"
+#include "Console.h"
+
+#include <avr/io.h>
+#include <avr/eeprom.h>
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+#include <util/atomic.h>
+#include <util/crc16.h>
+#include <stddef.h>
+#include <string.h>
+
+
+typedef struct
+{
+    /// Incremented on every save; the newest slot has the highest (wrapping) value
+    uint8_t Sequence;
+    Config_t Config;
+    /// CRC-16 of Sequence and Config
+    uint16_t Crc;
+} ConfigSlot_t;
+
+static ConfigSlot_t EEMEM slots[CONFIG_SLOT_COUNT];
+
+static const Config_t PROGMEM defaultConfig =
+{
+    .Version          = CONFIG_VERSION,
+    .DebounceDownTime = DEBOUNCE_DOWN_TIME,
+    .DebounceUpTime   = DEBOUNCE_UP_TIME,
+    .ReportMode       = CONFIG_REPORT_MODE_KEYBOARD,
+    .ButtonMap        = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 },
+    .HallActuation    = HALL_DEFAULT_ACTUATION,
+    .HallSensitivity  = HALL_DEFAULT_SENSITIVITY,
+};
+
+ConfigTables_t configTables;
+
+/// Block in use, with the sequence number and CRC it is (being) saved with
+static ConfigSlot_t active;
+/// Slot being written, or the newest slot when idle
+static uint8_t activeSlot;
+/// Bytes of active written so far; sizeof(active) when idle
+static volatile uint8_t writeIndex = sizeof(ConfigSlot_t);
+/// Result of the last feature report command
+static uint8_t status;
+
+static uint16_t Config_SlotCrc(const ConfigSlot_t* slot)
+{
+    const uint8_t* data = (const uint8_t*) slot;
+    uint16_t crc = 0xFFFF;
+    uint8_t i;
+
+    for (i = 0; i < offsetof(ConfigSlot_t, Crc); i++)
+    {
+        crc = _crc16_update(crc, data[i]);
+    }
+
+    return crc;
+}
+
+/** Check a block for values the scan path cannot use */
+static bool Config_IsValid(const Config_t* config)
+{
+    uint8_t i;
+
+    if (config->DebounceDownTime == 0 || config->DebounceUpTime == 0)
+      return false;
+#if defined(MIDI_ENABLED)
+    if (config->ReportMode != CONFIG_REPORT_MODE_KEYBOARD && config->ReportMode != CONFIG_REPORT_MODE_MIDI)
+      return false;
+#else
+    if (config->ReportMode != CONFIG_REPORT_MODE_KEYBOARD)
+      return false;
+#endif
+    if (config->HallSensitivity == 0)
+      return false;
+
+    for (i = 0; i < CONFIG_MAPPED_BUTTONS; i++)
+    {
+        if (config->ButtonMap[i] >= CONFIG_MAPPED_BUTTONS && config->ButtonMap[i] != CONFIG_UNMAPPED)
+          return false;
+    }
+
+    return true;
+}
+
+/** Compile the active block into configTables */
+static void Config_Compile(void)
+{
+    const Config_t* config = &active.Config;
+    ConfigTables_t tables;
+
+    tables.DebounceDownTime = config->DebounceDownTime;
+    tables.DebounceUpTime   = config->DebounceUpTime;
+    tables.ReportMode       = config->ReportMode;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        configTables = tables;
+    }
+
+    Remap_Compile(config->ButtonMap);
+
+#if defined(HALL_INPUTS)
+    {
+        uint8_t i;
+
+        for (i = 0; i < HALL_CHANNEL_COUNT; i++)
+        {
+            HallInputs_SetThresholds(i, config->HallActuation, config->HallSensitivity);
+        }
+    }
+#endif
+}
+
+/** Load the newest valid slot, or the defaults, and compile it */
+void Config_Init(void)
+{
+    ConfigSlot_t slot;
+    bool found = false;
+    uint8_t i;
+
+    for (i = 0; i < CONFIG_SLOT_COUNT; i++)
+    {
+        eeprom_read_block(&slot, &slots[i], sizeof(slot));
+
+        if (slot.Crc != Config_SlotCrc(&slot) || slot.Config.Version != CONFIG_VERSION ||
+            !Config_IsValid(&slot.Config))
+        {
+            continue;
+        }
+
+        // Sequence numbers wrap; valid slots are never more than
+        // CONFIG_SLOT_COUNT apart, so a signed difference orders them
+        if (!found || (int8_t) (slot.Sequence - active.Sequence) > 0)
+        {
+            active = slot;
+            activeSlot = i;
+            found = true;
+        }
+    }
+
+    if (!found)
+    {
+        memcpy_P(&active.Config, &defaultConfig, sizeof(Config_t));
+        active.Sequence = 0;
+        activeSlot = CONFIG_SLOT_COUNT - 1;
+    }
+
+    Config_Compile();
+}
+
+/** Start saving the active block into the slot after the newest one */
+static void Config_Save(void)
+{
+    active.Sequence++;
+    active.Crc = Config_SlotCrc(&active);
+
+    if (++activeSlot == CONFIG_SLOT_COUNT)
+      activeSlot = 0;
+
+    writeIndex = 0;
+    EECR |= _BV(EERIE);
+}
+
+void Config_CreateFeatureReport(uint8_t* data)
+{
+    data[0] = status;
+    memcpy(&data[1], &active.Config, sizeof(Config_t));
+}
+
+const Config_t* Config_GetActive(void)
+{
+    return &active.Config;
+}
+
+/** Check, use and save a block; returns a CONFIG_STATUS_* */
+uint8_t Config_Apply(const Config_t* config)
+{
+    if (writeIndex != sizeof(ConfigSlot_t))
+      return CONFIG_STATUS_BUSY;
+    if (config->Version != CONFIG_VERSION)
+      return CONFIG_STATUS_BAD_VERSION;
+    if (!Config_IsValid(config))
+      return CONFIG_STATUS_BAD_VALUE;
+
+    active.Config = *config;
+    Config_Compile();
+    Config_Save();
+
+    return CONFIG_STATUS_OK;
+}
+
+void Config_ProcessFeatureReport(const uint8_t* data, uint16_t size)
+{
+    Config_t config;
+
+    if (size < 1)
+      return;
+
+    switch (data[0])
+    {
+        case CONFIG_COMMAND_WRITE:
+            if (size < 1 + sizeof(Config_t))
+            {
+                status = CONFIG_STATUS_BAD_VALUE;
+                break;
+            }
+
+            memcpy(&config, &data[1], sizeof(Config_t));
+            status = Config_Apply(&config);
+            break;
+        case CONFIG_COMMAND_DEFAULTS:
+            memcpy_P(&config, &defaultConfig, sizeof(Config_t));
+            status = Config_Apply(&config);
+            break;
+        case CONFIG_COMMAND_PATTERN:
+            status = (size < 3) ? CONFIG_STATUS_BAD_VALUE : Pattern_Select(data[1], data[2]);
+            break;
+        default:
+            status = CONFIG_STATUS_BAD_COMMAND;
+            break;
+    }
+
+    // Command in the high byte, CONFIG_STATUS_* in the low byte
+    CONSOLE_LOG("config ", ((uint16_t) data[0] << 8) | status);
+}
+
+/** Write the next byte of the active block which differs from EEPROM */
+ISR(EE_READY_vect)
+{
+    const uint8_t* data = (const uint8_t*) &active;
+    uint8_t* address = (uint8_t*) &slots[activeSlot];
+    uint8_t index = writeIndex;
+
+    // Unchanged bytes cost no wear and no write time
+    while (index < sizeof(ConfigSlot_t) && eeprom_read_byte(address + index) == data[index])
+    {
+        index++;
+    }
+
+    if (index < sizeof(ConfigSlot_t))
+    {
+        eeprom_write_byte(address + index, data[index]);
+        index++;
+    }
+    else
+    {
+        EECR &= ~_BV(EERIE);
+    }
+
+    writeIndex = index;
+}
@@ -0,0 +1,107 @@
+/*
+  Pop'n Convertible Arcade Style Controller Project
+ 
+  Copyright 2011 Sam Wong (Sam /@/ hellosam /./ net)
+
+  This work is licensed under the Creative Commons Attribution 3.0 
+  Hong Kong License. 
+
+  To view a copy of this license, visit 
+  http://creativecommons.org/licenses/by/3.0/hk/ or send a letter to 
+  Creative Commons, 444 Castro Street, Suite 900, 
+  Mountain View, California, 94041, USA.  
+*/
+
+#ifndef _CONFIG_H_
+#define _CONFIG_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/** Runtime configuration, kept in EEPROM and set over a HID feature report.
+ *
+ * The block is stored with a sequence number and CRC-16 in one of
+ * CONFIG_SLOT_COUNT EEPROM slots. Each save goes to the slot after the
+ * newest one, so wear is spread over all slots, and a save torn by a
+ * power loss only costs that slot: the previous one still passes its CRC.
+ * At boot the newest valid slot is loaded, or the defaults if none is.
+ *
+ * The block is never read on the scan path. Config_Init() and accepted
+ * writes compile it into configTables, the remap tables (see Remap.h) and
+ * the hall thresholds, which is all the scan path reads.
+ *
+ * EEPROM writes are driven by the EE_READY interrupt one byte at a time
+ * (~3.4ms each), so a save never stalls USB.
+ *
+ * Feature report (HID_REPORTID_CONFIG, CONFIG_FEATURE_REPORT_SIZE bytes):
+ *  SET: Byte 0:  CONFIG_COMMAND_*
+ *       Byte 1-: Config_t, for CONFIG_COMMAND_WRITE
+ *  GET: Byte 0:  CONFIG_STATUS_* of the last command
+ *       Byte 1-: Config_t in use
+ */
+
+/// Layout version of Config_t; bump when the layout changes
+#define CONFIG_VERSION 1
+
+/// Inputs covered by ButtonMap, starting from input 0
+#define CONFIG_MAPPED_BUTTONS 16
+
+/// Value in ButtonMap for an input which is not reported
+#define CONFIG_UNMAPPED 0xFF
+
+/// EEPROM slots used for wear leveling
+#define CONFIG_SLOT_COUNT 16
+
+/// Feature report payload size, excluding the report ID
+#define CONFIG_FEATURE_REPORT_SIZE 32
+
+/// Feature report SET commands
+#define CONFIG_COMMAND_WRITE    0x01
+#define CONFIG_COMMAND_DEFAULTS 0x02
+/// Byte 1: debug button PATTERN_*, byte 2: step time in ms (see Pattern.h); not saved
+#define CONFIG_COMMAND_PATTERN  0x03
+
+/// Feature report GET status
+#define CONFIG_STATUS_OK          0x00
+#define CONFIG_STATUS_BUSY        0x01
+#define CONFIG_STATUS_BAD_VERSION 0x02
+#define CONFIG_STATUS_BAD_VALUE   0x03
+#define CONFIG_STATUS_BAD_COMMAND 0x04
+
+/// Report modes
+#define CONFIG_REPORT_MODE_KEYBOARD 0
+/// Note events on the USB-MIDI interface instead of keys; needs MIDI_ENABLED
+#define CONFIG_REPORT_MODE_MIDI     1
+
+typedef struct
+{
+    uint8_t Version;
+    /// Debounce after a press and after a release, in milliseconds (1 to 255)
+    uint8_t DebounceDownTime;
+    uint8_t DebounceUpTime;
+    /// CONFIG_REPORT_MODE_*
+    uint8_t ReportMode;
+    /// Report bit (0 to 15) of each input, or CONFIG_UNMAPPED
+    uint8_t ButtonMap[CONFIG_MAPPED_BUTTONS];
+    /// Hall-effect actuation depth and rapid trigger sensitivity, for every button
+    uint8_t HallActuation;
+    uint8_t HallSensitivity;
+} Config_t;
+
+/** Config_t compiled into the form the scan path uses */
+typedef struct
+{
+    uint8_t DebounceDownTime;
+    uint8_t DebounceUpTime;
+    uint8_t ReportMode;
+} ConfigTables_t;
+
+extern ConfigTables_t configTables;
+
+void Config_Init(void);
+void Config_CreateFeatureReport(uint8_t* data);
+void Config_ProcessFeatureReport(const uint8_t* data, uint16_t size);
+const Config_t* Config_GetActive(void);
+uint8_t Config_Apply(const Config_t* config);
+
+#endif
@@ -0,0 +1,479 @@
+/*
+  Pop'n Convertible Arcade Style Controller Project
+ 
+  Copyright 2011 Sam Wong (Sam /@/ hellosam /./ net)
+
+  This work is licensed under the Creative Commons Attribution 3.0 
+  Hong Kong License. 
+
+  To view a copy of this license, visit 
+  http://creativecommons.org/licenses/by/3.0/hk/ or send a letter to 
+  Creative Commons, 444 Castro Street, Suite 900, 
+  Mountain View, California, 94041, USA.  
+*/
+
+#include "ConfigDrive.h"
+#include "Config.h"
+#include "Descriptors.h"
+#include "Watchdog.h"
+
+#include <LUFA/Drivers/USB/USB.h>
+
+#include <avr/pgmspace.h>
+#include <stddef.h>
+#include <string.h>
+
+/// Volume layout, in blocks: boot sector, one FAT, a 16-entry root directory, then the data area
+#define DRIVE_FAT_BLOCK      1
+#define DRIVE_ROOT_BLOCK     2
+#define DRIVE_DATA_BLOCK     3
+#define DRIVE_ROOT_ENTRIES   16
+
+/// CONFIG.TXT lines: name padded to NAME_LENGTH, '=', 3 digits, CR LF
+#define DRIVE_NAME_LENGTH    16
+#define DRIVE_LINE_LENGTH    (DRIVE_NAME_LENGTH + 1 + 3 + 2)
+#define DRIVE_FILE_SIZE      (DRIVE_LINE_LENGTH * (sizeof(fields) / sizeof(fields[0])))
+
+typedef struct
+{
+    char Name[DRIVE_NAME_LENGTH];
+    /// Byte offset in Config_t
+    uint8_t Offset;
+} ConfigDriveField_t;
+
+static const ConfigDriveField_t PROGMEM fields[] =
+{
+    { "DEBOUNCE_DOWN_MS", offsetof(Config_t, DebounceDownTime) },
+    { "DEBOUNCE_UP_MS",   offsetof(Config_t, DebounceUpTime) },
+    { "REPORT_MODE",      offsetof(Config_t, ReportMode) },
+    { "MAP_INPUT_01",     offsetof(Config_t, ButtonMap) + 0 },
+    { "MAP_INPUT_02",     offsetof(Config_t, ButtonMap) + 1 },
+    { "MAP_INPUT_03",     offsetof(Config_t, ButtonMap) + 2 },
+    { "MAP_INPUT_04",     offsetof(Config_t, ButtonMap) + 3 },
+    { "MAP_INPUT_05",     offsetof(Config_t, ButtonMap) + 4 },
+    { "MAP_INPUT_06",     offsetof(Config_t, ButtonMap) + 5 },
+    { "MAP_INPUT_07",     offsetof(Config_t, ButtonMap) + 6 },
+    { "MAP_INPUT_08",     offsetof(Config_t, ButtonMap) + 7 },
+    { "MAP_INPUT_09",     offsetof(Config_t, ButtonMap) + 8 },
+    { "MAP_INPUT_10",     offsetof(Config_t, ButtonMap) + 9 },
+    { "MAP_INPUT_11",     offsetof(Config_t, ButtonMap) + 10 },
+    { "MAP_INPUT_12",     offsetof(Config_t, ButtonMap) + 11 },
+    { "MAP_INPUT_13",     offsetof(Config_t, ButtonMap) + 12 },
+    { "MAP_INPUT_14",     offsetof(Config_t, ButtonMap) + 13 },
+    { "MAP_INPUT_15",     offsetof(Config_t, ButtonMap) + 14 },
+    { "MAP_INPUT_16",     offsetof(Config_t, ButtonMap) + 15 },
+    { "HALL_ACTUATION",   offsetof(Config_t, HallActuation) },
+    { "HALL_SENSITIVITY", offsetof(Config_t, HallSensitivity) },
+};
+
+/** Boot sector up to the end of the extended BPB; the rest is zero but for the 0x55AA signature */
+static const uint8_t PROGMEM bootSector[] =
+{
+    0xEB, 0x3C, 0x90,                              // Jump
+    'M', 'S', 'W', 'I', 'N', '4', '.', '1',        // OEM name
+    CONFIG_DRIVE_BLOCK_SIZE & 0xFF, CONFIG_DRIVE_BLOCK_SIZE >> 8,
+    1,                                             // Sectors per cluster
+    DRIVE_FAT_BLOCK, 0,                            // Reserved sectors
+    1,                                             // FATs
+    DRIVE_ROOT_ENTRIES, 0,                         // Root directory entries
+    CONFIG_DRIVE_BLOCKS & 0xFF, CONFIG_DRIVE_BLOCKS >> 8,
+    0xF8,                                          // Media: fixed disk
+    DRIVE_ROOT_BLOCK - DRIVE_FAT_BLOCK, 0,         // Sectors per FAT
+    1, 0,                                          // Sectors per track
+    1, 0,                                          // Heads
+    0, 0, 0, 0,                                    // Hidden sectors
+    0, 0, 0, 0,                                    // Large sector count
+    0x80,                                          // Drive number
+    0,
+    0x29,                                          // Extended boot signature
+    0x16, 0x02, 0x01, 0x20,                        // Volume serial number
+    'P', 'O', 'P', 'N', 'A', 'S', 'C', ' ', ' ', ' ', ' ',
+    'F', 'A', 'T', '1', '2', ' ', ' ', ' ',
+};
+
+/** Start of the FAT: media and end-of-chain entries 0 and 1, then CONFIG.TXT in cluster 2 alone */
+static const uint8_t PROGMEM fatStart[] = { 0xF8, 0xFF, 0xFF, 0xFF, 0x0F };
+
+/** Root directory: the volume label, then CONFIG.TXT without its size (bytes 28-31) */
+static const uint8_t PROGMEM rootStart[] =
+{
+    'P', 'O', 'P', 'N', 'A', 'S', 'C', ' ', ' ', ' ', ' ', 0x08, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    'C', 'O', 'N', 'F', 'I', 'G', ' ', ' ', 'T', 'X', 'T', 0x20, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 0,
+};
+
+static const SCSI_Inquiry_Response_t PROGMEM inquiryData =
+    {
+        .DeviceType          = 0x00,
+        .PeripheralQualifier = 0,
+
+        .Removable           = true,
+
+        .Version             = 0,
+
+        .ResponseDataFormat  = 2,
+        .NormACA             = false,
+        .TrmTsk              = false,
+        .AERC                = false,
+
+        .AdditionalLength    = 0x1F,
+
+        .SoftReset           = false,
+        .CmdQue              = false,
+        .Linked              = false,
+        .Sync                = false,
+        .WideBus16Bit        = false,
+        .WideBus32Bit        = false,
+        .RelAddr             = false,
+
+        .VendorID            = "PopnAsc",
+        .ProductID           = "Config Drive",
+        .RevisionID          = {'0','.','0','1'},
+    };
+
+/** LUFA Mass Storage Class driver interface configuration and state information. */
+static USB_ClassInfo_MS_Device_t ConfigDrive_MS_Interface =
+    {
+        .Config =
+            {
+                .InterfaceNumber           = CONFIG_DRIVE_INTERFACE,
+
+                .DataINEndpointNumber      = CONFIG_DRIVE_IN_EPNUM,
+                .DataINEndpointSize        = CONFIG_DRIVE_EPSIZE,
+                .DataINEndpointDoubleBank  = false,
+
+                .DataOUTEndpointNumber     = CONFIG_DRIVE_OUT_EPNUM,
+                .DataOUTEndpointSize       = CONFIG_DRIVE_EPSIZE,
+                .DataOUTEndpointDoubleBank = false,
+
+                .TotalLUNs                 = 1,
+            },
+    };
+
+/// Sense of the last failed command, for REQUEST SENSE
+static uint8_t senseKey;
+static uint8_t senseCode;
+
+/// Configuration being assembled from the lines of a WRITE command
+static Config_t staged;
+static bool stagedChanged;
+
+/// Line parser state: name characters so far, or the value once past '='
+static char lineName[DRIVE_NAME_LENGTH];
+static uint8_t lineNameLength;
+static uint16_t lineValue;
+static uint8_t lineDigits;
+/// Field of the line, or 0xFF if the name is unknown; 0xFE before '='
+static uint8_t lineField;
+
+#define LINE_IN_NAME 0xFE
+#define LINE_INVALID 0xFF
+
+void ConfigDrive_Init(void)
+{
+    senseKey = SCSI_SENSE_KEY_GOOD;
+    senseCode = SCSI_ASENSE_NO_ADDITIONAL_INFORMATION;
+}
+
+bool ConfigDrive_ConfigureEndpoints(void)
+{
+    return MS_Device_ConfigureEndpoints(&ConfigDrive_MS_Interface);
+}
+
+void ConfigDrive_ProcessControlRequest(void)
+{
+    MS_Device_ProcessControlRequest(&ConfigDrive_MS_Interface);
+}
+
+void ConfigDrive_USBTask(void)
+{
+    MS_Device_USBTask(&ConfigDrive_MS_Interface);
+}
+
+/** Byte of CONFIG.TXT */
+static uint8_t ConfigDrive_FileByte(uint16_t offset)
+{
+    const ConfigDriveField_t* field = &fields[offset / DRIVE_LINE_LENGTH];
+    uint8_t column = offset % DRIVE_LINE_LENGTH;
+    uint8_t value;
+    char c;
+
+    if (column < DRIVE_NAME_LENGTH)
+    {
+        c = pgm_read_byte(&field->Name[column]);
+        return c ? c : ' ';
+    }
+
+    value = ((const uint8_t*) Config_GetActive())[pgm_read_byte(&field->Offset)];
+
+    switch (column - DRIVE_NAME_LENGTH)
+    {
+        case 0:  return '=';
+        case 1:  return '0' + value / 100;
+        case 2:  return '0' + (value / 10) % 10;
+        case 3:  return '0' + value % 10;
+        case 4:  return '\r';
+        default: return '\n';
+    }
+}
+
+/** Byte of the volume at an offset into a block */
+static uint8_t ConfigDrive_ReadByte(uint16_t block, uint16_t offset)
+{
+    switch (block)
+    {
+        case 0:
+            if (offset < sizeof(bootSector))
+              return pgm_read_byte(&bootSector[offset]);
+            if (offset >= CONFIG_DRIVE_BLOCK_SIZE - 2)
+              return (offset & 1) ? 0xAA : 0x55;
+            return 0;
+        case DRIVE_FAT_BLOCK:
+            return (offset < sizeof(fatStart)) ? pgm_read_byte(&fatStart[offset]) : 0;
+        case DRIVE_ROOT_BLOCK:
+            if (offset < sizeof(rootStart))
+              return pgm_read_byte(&rootStart[offset]);
+            if (offset < sizeof(rootStart) + 4)
+              return ((uint32_t) DRIVE_FILE_SIZE >> ((offset - sizeof(rootStart)) * 8)) & 0xFF;
+            return 0;
+        case DRIVE_DATA_BLOCK:
+            return (offset < DRIVE_FILE_SIZE) ? ConfigDrive_FileByte(offset) : 0;
+        default:
+            return 0;
+    }
+}
+
+/** Parse one byte written to the data area */
+static void ConfigDrive_ParseByte(uint8_t c)
+{
+    uint8_t i;
+
+    if (c == '\r' || c == '\n' || c == 0)
+    {
+        // End of line: store the value if the whole line made sense
+        if (lineField < LINE_IN_NAME && lineDigits != 0 && lineValue <= 0xFF)
+        {
+            ((uint8_t*) &staged)[pgm_read_byte(&fields[lineField].Offset)] = lineValue;
+            stagedChanged = true;
+        }
+
+        lineNameLength = 0;
+        lineField = LINE_IN_NAME;
+        return;
+    }
+
+    if (lineField == LINE_IN_NAME)
+    {
+        if (c != '=')
+        {
+            // Padding spaces are dropped; a name that is too long matches nothing
+            if (c != ' ' && lineNameLength <= DRIVE_NAME_LENGTH)
+            {
+                if (lineNameLength < DRIVE_NAME_LENGTH)
+                  lineName[lineNameLength] = c;
+                lineNameLength++;
+            }
+            return;
+        }
+
+        lineField = LINE_INVALID;
+        lineValue = 0;
+        lineDigits = 0;
+
+        for (i = 0; i < sizeof(fields) / sizeof(fields[0]) && lineNameLength <= DRIVE_NAME_LENGTH; i++)
+        {
+            if (strnlen_P(fields[i].Name, DRIVE_NAME_LENGTH) == lineNameLength &&
+                memcmp_P(lineName, fields[i].Name, lineNameLength) == 0)
+            {
+                lineField = i;
+                break;
+            }
+        }
+    }
+    else if (c >= '0' && c <= '9' && lineDigits < 3)
+    {
+        lineValue = lineValue * 10 + (c - '0');
+        lineDigits++;
+    }
+    else if (c != ' ')
+    {
+        lineField = LINE_INVALID;
+    }
+}
+
+/** Send blocks of the volume, generating each packet as it goes */
+static bool ConfigDrive_Read(uint32_t block, uint16_t count)
+{
+    uint16_t offset;
+    uint8_t i;
+
+    while (count--)
+    {
+        for (offset = 0; offset < CONFIG_DRIVE_BLOCK_SIZE; offset += CONFIG_DRIVE_EPSIZE)
+        {
+            if (Endpoint_WaitUntilReady() != ENDPOINT_READYWAIT_NoError ||
+                ConfigDrive_MS_Interface.State.IsMassStoreReset)
+            {
+                return false;
+            }
+
+            for (i = 0; i < CONFIG_DRIVE_EPSIZE; i++)
+            {
+                Endpoint_Write_8(ConfigDrive_ReadByte(block, offset + i));
+            }
+
+            Endpoint_ClearIN();
+            Watchdog_Progress(WATCHDOG_OP_DRIVE_READ);
+        }
+
+        ConfigDrive_MS_Interface.State.CommandBlock.DataTransferLength -= CONFIG_DRIVE_BLOCK_SIZE;
+        block++;
+    }
+
+    return true;
+}
+
+/** Take in written blocks, parsing those in the data area */
+static bool ConfigDrive_Write(uint32_t block, uint16_t count)
+{
+    uint16_t offset;
+    uint8_t i;
+
+    while (count--)
+    {
+        for (offset = 0; offset < CONFIG_DRIVE_BLOCK_SIZE; offset += CONFIG_DRIVE_EPSIZE)
+        {
+            if (Endpoint_WaitUntilReady() != ENDPOINT_READYWAIT_NoError ||
+                ConfigDrive_MS_Interface.State.IsMassStoreReset)
+            {
+                return false;
+            }
+
+            for (i = 0; i < CONFIG_DRIVE_EPSIZE; i++)
+            {
+                uint8_t c = Endpoint_Read_8();
+
+                if (block >= DRIVE_DATA_BLOCK)
+                  ConfigDrive_ParseByte(c);
+            }
+
+            Endpoint_ClearOUT();
+            Watchdog_Progress(WATCHDOG_OP_DRIVE_WRITE);
+        }
+
+        ConfigDrive_MS_Interface.State.CommandBlock.DataTransferLength -= CONFIG_DRIVE_BLOCK_SIZE;
+        block++;
+    }
+
+    return true;
+}
+
+/** READ (10) and WRITE (10) */
+static bool ConfigDrive_ReadWrite(const uint8_t* cdb, bool isRead)
+{
+    uint32_t block = ((uint32_t) cdb[2] << 24) | ((uint32_t) cdb[3] << 16) | ((uint16_t) cdb[4] << 8) | cdb[5];
+    uint16_t count = ((uint16_t) cdb[7] << 8) | cdb[8];
+    bool result;
+
+    if (block >= CONFIG_DRIVE_BLOCKS || count > CONFIG_DRIVE_BLOCKS - block)
+    {
+        senseKey = SCSI_SENSE_KEY_ILLEGAL_REQUEST;
+        senseCode = SCSI_ASENSE_LOGICAL_BLOCK_ADDRESS_OUT_OF_RANGE;
+        return false;
+    }
+
+    if (isRead)
+      return ConfigDrive_Read(block, count);
+
+    staged = *Config_GetActive();
+    stagedChanged = false;
+    lineNameLength = 0;
+    lineField = LINE_IN_NAME;
+
+    result = ConfigDrive_Write(block, count);
+
+    // A last line without a line break still counts
+    ConfigDrive_ParseByte('\n');
+
+    if (result && stagedChanged)
+      Config_Apply(&staged);
+
+    return result;
+}
+
+/** Send a reply of up to length bytes, no more than the host asked for */
+static void ConfigDrive_Reply(const void* data, uint8_t length, bool fromFlash)
+{
+    uint32_t remaining = ConfigDrive_MS_Interface.State.CommandBlock.DataTransferLength;
+
+    if (length > remaining)
+      length = remaining;
+
+    if (fromFlash)
+      Endpoint_Write_PStream_LE(data, length, NULL);
+    else
+      Endpoint_Write_Stream_LE(data, length, NULL);
+
+    Endpoint_ClearIN();
+    ConfigDrive_MS_Interface.State.CommandBlock.DataTransferLength -= length;
+}
+
+bool CALLBACK_MS_Device_SCSICommandReceived(USB_ClassInfo_MS_Device_t* const MSInterfaceInfo)
+{
+    const uint8_t* cdb = MSInterfaceInfo->State.CommandBlock.SCSICommandData;
+    uint8_t reply[18];
+    bool success = true;
+
+    switch (cdb[0])
+    {
+        case SCSI_CMD_INQUIRY:
+            ConfigDrive_Reply(&inquiryData, (cdb[4] < sizeof(inquiryData)) ? cdb[4] : sizeof(inquiryData), true);
+            break;
+        case SCSI_CMD_REQUEST_SENSE:
+            memset(reply, 0, sizeof(reply));
+            reply[0] = 0x70;
+            reply[2] = senseKey;
+            reply[7] = 10;
+            reply[12] = senseCode;
+            ConfigDrive_Reply(reply, (cdb[4] < sizeof(reply)) ? cdb[4] : sizeof(reply), false);
+            break;
+        case SCSI_CMD_READ_CAPACITY_10:
+            // Last block and block size, big endian
+            memset(reply, 0, 8);
+            reply[2] = (CONFIG_DRIVE_BLOCKS - 1) >> 8;
+            reply[3] = (CONFIG_DRIVE_BLOCKS - 1) & 0xFF;
+            reply[6] = CONFIG_DRIVE_BLOCK_SIZE >> 8;
+            reply[7] = CONFIG_DRIVE_BLOCK_SIZE & 0xFF;
+            ConfigDrive_Reply(reply, 8, false);
+            break;
+        case SCSI_CMD_MODE_SENSE_6:
+            // No mode pages, not write protected
+            memset(reply, 0, 4);
+            reply[0] = 3;
+            ConfigDrive_Reply(reply, 4, false);
+            break;
+        case SCSI_CMD_READ_10:
+        case SCSI_CMD_WRITE_10:
+            success = ConfigDrive_ReadWrite(cdb, cdb[0] == SCSI_CMD_READ_10);
+            break;
+        case SCSI_CMD_TEST_UNIT_READY:
+        case SCSI_CMD_PREVENT_ALLOW_MEDIUM_REMOVAL:
+        case SCSI_CMD_SEND_DIAGNOSTIC:
+        case SCSI_CMD_VERIFY_10:
+            MSInterfaceInfo->State.CommandBlock.DataTransferLength = 0;
+            break;
+        default:
+            senseKey = SCSI_SENSE_KEY_ILLEGAL_REQUEST;
+            senseCode = SCSI_ASENSE_INVALID_COMMAND;
+            return false;
+    }
+
+    if (success && cdb[0] != SCSI_CMD_REQUEST_SENSE)
+    {
+        senseKey = SCSI_SENSE_KEY_GOOD;
+        senseCode = SCSI_ASENSE_NO_ADDITIONAL_INFORMATION;
+    }
+
+    return success;
+}
@@ -0,0 +1,52 @@
+/*
+  Pop'n Convertible Arcade Style Controller Project
+ 
+  Copyright 2011 Sam Wong (Sam /@/ hellosam /./ net)
+
+  This work is licensed under the Creative Commons Attribution 3.0 
+  Hong Kong License. 
+
+  To view a copy of this license, visit 
+  http://creativecommons.org/licenses/by/3.0/hk/ or send a letter to 
+  Creative Commons, 444 Castro Street, Suite 900, 
+  Mountain View, California, 94041, USA.  
+*/
+
+#ifndef _CONFIGDRIVE_H_
+#define _CONFIGDRIVE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/** USB mass storage drive holding the configuration as a text file.
+ *
+ * The drive is a 32KB FAT12 volume with a single file, CONFIG.TXT, one
+ * "NAME=value" line per Config_t field. Nothing of it is stored: each
+ * byte of the boot sector, FAT, root directory and file is computed from
+ * its block and offset as it is written to the endpoint, so no 512-byte
+ * sector buffer is needed. Lines have a fixed width, which keeps the file
+ * size constant and any byte of the file a division away.
+ *
+ * Writes to the data area are parsed as they stream in, whatever cluster
+ * the host puts them in: every "NAME=value" line updates a staged copy of
+ * the configuration, which is applied and saved with Config_Apply() at the
+ * end of the WRITE command. Lines that do not parse, and writes to the
+ * boot sector, FAT and directory, are ignored, so reading the file back
+ * always shows the configuration in use. An invalid set of values (see
+ * Config.h) is rejected whole.
+ *
+ * LUFA's mass storage class driver waits on the host while a command is
+ * in progress, so reports pause while the host reads or writes the drive.
+ * The drive is for tuning, not for play.
+ */
+
+/// Drive geometry: 512-byte blocks, one per cluster
+#define CONFIG_DRIVE_BLOCK_SIZE  512
+#define CONFIG_DRIVE_BLOCKS      64
+
+void ConfigDrive_Init(void);
+bool ConfigDrive_ConfigureEndpoints(void);
+void ConfigDrive_ProcessControlRequest(void);
+void ConfigDrive_USBTask(void);
+
+#endif
@@ -0,0 +1,231 @@
+/*
+  Pop'n Convertible Arcade Style Controller Project
+ 
+  Copyright 2011 Sam Wong (Sam /@/ hellosam /./ net)
+
+  This work is licensed under the Creative Commons Attribution 3.0 
+  Hong Kong License. 
+
+  To view a copy of this license, visit 
+  http://creativecommons.org/licenses/by/3.0/hk/ or send a letter to 
+  Creative Commons, 444 Castro Street, Suite 900, 
+  Mountain View, California, 94041, USA.  
+*/
+
+#include "Console.h"
+#include "Descriptors.h"
+
+#include <LUFA/Drivers/USB/USB.h>
+#include <LUFA/Drivers/Misc/SPSCRingBuffer.h>
+
+#include <util/atomic.h>
+#include <string.h>
+
+/** LUFA CDC Class driver interface configuration and state information. Only its control request
+ *  handling and endpoint setup are used; data goes through Console_USBTask().
+ */
+static USB_ClassInfo_CDC_Device_t Console_CDC_Interface =
+    {
+        .Config =
+            {
+                .ControlInterfaceNumber         = CONSOLE_CCI_INTERFACE,
+
+                .DataINEndpointNumber           = CONSOLE_TX_EPNUM,
+                .DataINEndpointSize             = CONSOLE_TXRX_EPSIZE,
+                .DataINEndpointDoubleBank       = false,
+
+                .DataOUTEndpointNumber          = CONSOLE_RX_EPNUM,
+                .DataOUTEndpointSize            = CONSOLE_TXRX_EPSIZE,
+                .DataOUTEndpointDoubleBank      = false,
+
+                .NotificationEndpointNumber     = CONSOLE_NOTIFICATION_EPNUM,
+                .NotificationEndpointSize       = CONSOLE_NOTIFICATION_EPSIZE,
+                .NotificationEndpointDoubleBank = false,
+            },
+    };
+
+static uint8_t bufferData[CONSOLE_BUFFER_SIZE];
+static SPSCRingBuffer_t buffer = SPSC_RINGBUFFER_INITIALIZER(bufferData);
+
+/// Bytes dropped because the ring was full, saturating
+static volatile uint16_t dropped;
+/// Drop count last noted in the output
+static uint16_t droppedNoted;
+/// Set when the last packet was full, so the transfer needs a short packet to end
+static bool needZLP;
+
+/// Characters Console_Log() adds to a message: 4 hex digits and CR LF
+#define CONSOLE_LOG_SUFFIX 6
+
+/// Start of the line noting the drop count
+static const char PROGMEM dropNote[] = "\r\n!drop ";
+
+void Console_Init(void)
+{
+    SPSCRingBuffer_InitBuffer(&buffer, bufferData, CONSOLE_BUFFER_SIZE);
+    dropped = 0;
+    droppedNoted = 0;
+}
+
+bool Console_ConfigureEndpoints(void)
+{
+    needZLP = false;
+    return CDC_Device_ConfigureEndpoints(&Console_CDC_Interface);
+}
+
+void Console_ProcessControlRequest(void)
+{
+    CDC_Device_ProcessControlRequest(&Console_CDC_Interface);
+}
+
+/** Queue bytes from RAM or flash, or drop them all if they do not fit.
+ *  Writers may be in any context, so they are serialized with interrupts
+ *  held off for the copy; the ring itself only has one consumer.
+ */
+static bool Console_Queue(const uint8_t* data, uint8_t length, bool fromFlash)
+{
+    bool queued = false;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        if (SPSCRingBuffer_GetFreeCount(&buffer) >= length)
+        {
+            while (length--)
+            {
+                SPSCRingBuffer_Insert(&buffer, fromFlash ? pgm_read_byte(data) : *data);
+                data++;
+            }
+            queued = true;
+        }
+        else if ((uint16_t) (dropped + length) >= dropped)
+        {
+            dropped += length;
+        }
+        else
+        {
+            dropped = 0xFFFF;
+        }
+    }
+
+    return queued;
+}
+
+bool Console_Write(const void* data, uint8_t length)
+{
+    return Console_Queue((const uint8_t*) data, length, false);
+}
+
+bool Console_Print(const char* string)
+{
+    return Console_Queue((const uint8_t*) string, strlen(string), false);
+}
+
+bool Console_PrintP(const char* string)
+{
+    return Console_Queue((const uint8_t*) string, strlen_P(string), true);
+}
+
+/** Four upper case hex digits of value, not terminated */
+static void Console_FormatHex(char* text, uint16_t value)
+{
+    uint8_t i;
+
+    for (i = 4; i-- > 0; )
+    {
+        uint8_t digit = value & 0x0F;
+
+        text[i] = (digit < 10) ? ('0' + digit) : ('A' - 10 + digit);
+        value >>= 4;
+    }
+}
+
+bool Console_PrintHex(uint16_t value)
+{
+    char text[4];
+
+    Console_FormatHex(text, value);
+    return Console_Write(text, sizeof(text));
+}
+
+/** Queue a message from flash, the value in hex and a line break as one
+ *  write, so that the line is sent or dropped whole. A message too long
+ *  for CONSOLE_LOG_LENGTH is cut short.
+ */
+bool Console_Log(const char* message, uint16_t value)
+{
+    char line[CONSOLE_LOG_LENGTH];
+    uint8_t length = strlen_P(message);
+
+    if (length > CONSOLE_LOG_LENGTH - CONSOLE_LOG_SUFFIX)
+      length = CONSOLE_LOG_LENGTH - CONSOLE_LOG_SUFFIX;
+
+    memcpy_P(line, message, length);
+    Console_FormatHex(&line[length], value);
+    line[length + 4] = '\r';
+    line[length + 5] = '\n';
+
+    return Console_Write(line, length + CONSOLE_LOG_SUFFIX);
+}
+
+uint16_t Console_GetDropped(void)
+{
+    uint16_t result;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        result = dropped;
+    }
+
+    return result;
+}
+
+/** Move queued bytes into the IN bank if it is free. Never waits. */
+void Console_USBTask(void)
+{
+    uint16_t droppedNow;
+    uint8_t* span;
+    uint8_t length;
+    uint8_t count = 0;
+    uint8_t i;
+
+    if ((USB_DeviceState != DEVICE_STATE_Configured) || !(Console_CDC_Interface.State.LineEncoding.BaudRateBPS))
+      return;
+
+    Endpoint_SelectEndpoint(CONSOLE_RX_EPNUM);
+    if (Endpoint_IsOUTReceived())
+      Endpoint_ClearOUT();
+
+    // Only when the note fits, as a dropped note would count as a new drop;
+    // a writer may still take the room first, and then the next try notes both
+    droppedNow = Console_GetDropped();
+    if (droppedNow != droppedNoted && SPSCRingBuffer_GetFreeCount(&buffer) >= sizeof(dropNote) - 1 + CONSOLE_LOG_SUFFIX)
+    {
+        if (Console_Log(dropNote, droppedNow))
+          droppedNoted = droppedNow;
+    }
+
+    Endpoint_SelectEndpoint(CONSOLE_TX_EPNUM);
+    if (!(Endpoint_IsINReady()))
+      return;
+
+    while (count < CONSOLE_TXRX_EPSIZE && (length = SPSCRingBuffer_GetReadSpan(&buffer, &span)) != 0)
+    {
+        if (length > CONSOLE_TXRX_EPSIZE - count)
+          length = CONSOLE_TXRX_EPSIZE - count;
+
+        for (i = 0; i < length; i++)
+        {
+            Endpoint_Write_8(span[i]);
+        }
+
+        // Free the bytes only once they are in the bank
+        SPSCRingBuffer_CommitRead(&buffer, length);
+        count += length;
+    }
+
+    if (count || needZLP)
+    {
+        Endpoint_ClearIN();
+        needZLP = (count == CONSOLE_TXRX_EPSIZE);
+    }
+}
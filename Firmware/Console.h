@@ -0,0 +1,62 @@
+/*
+  Pop'n Convertible Arcade Style Controller Project
+ 
+  Copyright 2011 Sam Wong (Sam /@/ hellosam /./ net)
+
+  This work is licensed under the Creative Commons Attribution 3.0 
+  Hong Kong License. 
+
+  To view a copy of this license, visit 
+  http://creativecommons.org/licenses/by/3.0/hk/ or send a letter to 
+  Creative Commons, 444 Castro Street, Suite 900, 
+  Mountain View, California, 94041, USA.  
+*/
+
+#ifndef _CONSOLE_H_
+#define _CONSOLE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <avr/pgmspace.h>
+
+/** CDC-ACM debug console, next to the HID interface in a composite device.
+ *
+ * Text is queued into a ring buffer from any context and sent by
+ * Console_USBTask() from the report task, after the HID report. Unlike
+ * CDC_Device_SendByte() and CDC_Device_Flush(), nothing here waits for
+ * the host: writes that do not fit the ring are dropped whole and counted,
+ * and the task only fills the IN bank when it is free. A note with the
+ * drop count is queued as soon as there is room for it again.
+ *
+ * Events are logged with CONSOLE_LOG() as one line each, a message and a
+ * 16-bit value in hex, which compiles to nothing without the console.
+ *
+ * Anything the host sends is discarded.
+ */
+
+/// Ring buffer size; a power of two up to 128
+#ifndef CONSOLE_BUFFER_SIZE
+#define CONSOLE_BUFFER_SIZE 64
+#endif
+
+/// Longest line Console_Log() writes, message included
+#define CONSOLE_LOG_LENGTH 32
+
+#if defined(DEBUG_CONSOLE_ENABLED)
+#define CONSOLE_LOG(message, value) Console_Log(PSTR(message), (value))
+#else
+#define CONSOLE_LOG(message, value) do { } while (0)
+#endif
+
+void Console_Init(void);
+bool Console_ConfigureEndpoints(void);
+void Console_ProcessControlRequest(void);
+void Console_USBTask(void);
+bool Console_Write(const void* data, uint8_t length);
+bool Console_Print(const char* string);
+bool Console_PrintP(const char* string);
+bool Console_PrintHex(uint16_t value);
+bool Console_Log(const char* message, uint16_t value);
+uint16_t Console_GetDropped(void);
+
+#endif
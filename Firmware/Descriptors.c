@@ -41,12 +41,44 @@
 
 /** HID class report descriptor. 
  *
- * IN Report:
- * Byte 1: 
- *      Bit status of key 1 to 8 (Active High)
- * Byte 2: 
- *      Bit status of key 9 (Active High)
- *      7 reserved bits.
+ * IN Report (HID_REPORTID_BUTTONS), generated from PLAYER1_BUTTONS:
+ * Byte 1-: 
+ *      Bit status of each button, in table order (Active High)
+ *      Reserved bits up to the byte boundary.
+ *
+ * Feature Report (HID_REPORTID_CONFIG), in its own vendor collection so
+ * that it stays reachable while the OS holds the keyboard:
+ * Byte 1-32:
+ *      Configuration command or status, see Config.h
+ *
+ * With CONFIG_REPORT_MODE_MIDI the IN report stays at zero, see Midi.h.
+ *
+ * Feature Report (HID_REPORTID_STATS), in the same vendor collection:
+ * Byte 1-32:
+ *      Switch statistics page or command, see Stats.h
+ *
+ * Feature Report (HID_REPORTID_MEMORY), in the same vendor collection:
+ * Byte 1-32:
+ *      RAM usage and stack high-water mark, see Memory.h
+ *
+ * Feature Report (HID_REPORTID_PASSTHROUGH), with PASSTHROUGH_INPUTS only:
+ * Byte 1-32:
+ *      Bridge frame counts and latency, see Passthrough.h
+ *
+ * Feature Report (HID_REPORTID_WATCHDOG), in the same vendor collection:
+ * Byte 1-32:
+ *      Cause of the last reset, see Watchdog.h
+ *
+ * Feature Report (HID_REPORTID_SCHEDULER), in the same vendor collection:
+ * Byte 1-32:
+ *      Task start latencies and deadline misses, see PopnAsc.h
+ *
+ * Feature Report (HID_REPORTID_MIDI), with MIDI_ENABLED only:
+ * Byte 1-32:
+ *      MIDI events sent and dropped, see Midi.h
+ *
+ * Player 2 (TWO_PLAYER_ENABLED) is a second keyboard interface with its own
+ * endpoint and Player2Report, so hosts see two controllers.
  */
 const USB_Descriptor_HIDReport_Datatype_t PROGMEM KeyboardReport[] =
 {
@@ -54,19 +86,70 @@ const USB_Descriptor_HIDReport_Datatype_t PROGMEM KeyboardReport[] =
     0x09, 0x06,                    // USAGE (Keyboard)
     0xa1, 0x01,                    // COLLECTION (Application)
 
-    0x05, 0x07,                    //   USAGE_PAGE (Keyboard)
-    0x19, 0x1E,                    //   USAGE_MINIMUM (Keyboard 1 and !)
-    0x29, 0x26,                    //   USAGE_MAXIMUM (Keyboard 9 and ()
+    0x85, 0x01,                    //   REPORT_ID (1)
+    BUTTON_REPORT_ITEMS(PLAYER1_BUTTONS)
+#if BUTTON_REPORT_PADDING(PLAYER1_BUTTON_COUNT) > 0
+    BUTTON_REPORT_PADDING_ITEMS(PLAYER1_BUTTONS)
+#endif
+    0xc0,                          // END_COLLECTION
+
+    0x06, 0x00, 0xff,              // USAGE_PAGE (Vendor Defined Page 1)
+    0x09, 0x01,                    // USAGE (Vendor Usage 1)
+    0xa1, 0x01,                    // COLLECTION (Application)
+    0x85, 0x02,                    //   REPORT_ID (2)
+    0x09, 0x02,                    //   USAGE (Vendor Usage 2)
     0x15, 0x00,                    //   LOGICAL_MINIMUM (0)
-    0x25, 0x01,                    //   LOGICAL_MAXIMUM (1)
-    0x75, 0x01,                    //   REPORT_SIZE (1)
-    0x95, 0x09,                    //   REPORT_COUNT (9)
-    0x81, 0x02,                    //   INPUT (Data,Var,Abs)
-    0x75, 0x07,                    //   REPORT_SIZE (7)
-    0x95, 0x01,                    //   REPORT_COUNT (1)
-    0x81, 0x03,                    //   INPUT (Cnst,Var,Abs) 
+    0x26, 0xff, 0x00,              //   LOGICAL_MAXIMUM (255)
+    0x75, 0x08,                    //   REPORT_SIZE (8)
+    0x95, 0x20,                    //   REPORT_COUNT (32)
+    0xb1, 0x02,                    //   FEATURE (Data,Var,Abs)
+    0x85, 0x03,                    //   REPORT_ID (3)
+    0x09, 0x03,                    //   USAGE (Vendor Usage 3)
+    0xb1, 0x02,                    //   FEATURE (Data,Var,Abs)
+    0x85, 0x04,                    //   REPORT_ID (4)
+    0x09, 0x04,                    //   USAGE (Vendor Usage 4)
+    0xb1, 0x02,                    //   FEATURE (Data,Var,Abs)
+#if defined(PASSTHROUGH_INPUTS)
+    0x85, 0x05,                    //   REPORT_ID (5)
+    0x09, 0x05,                    //   USAGE (Vendor Usage 5)
+    0xb1, 0x02,                    //   FEATURE (Data,Var,Abs)
+#endif
+    0x85, 0x06,                    //   REPORT_ID (6)
+    0x09, 0x06,                    //   USAGE (Vendor Usage 6)
+    0xb1, 0x02,                    //   FEATURE (Data,Var,Abs)
+    0x85, 0x07,                    //   REPORT_ID (7)
+    0x09, 0x07,                    //   USAGE (Vendor Usage 7)
+    0xb1, 0x02,                    //   FEATURE (Data,Var,Abs)
+#if defined(MIDI_ENABLED)
+    0x85, 0x08,                    //   REPORT_ID (8)
+    0x09, 0x08,                    //   USAGE (Vendor Usage 8)
+    0xb1, 0x02,                    //   FEATURE (Data,Var,Abs)
+#endif
+    0xc0                           // END_COLLECTION
+};
+
+#if defined(TWO_PLAYER_ENABLED)
+/** HID class report descriptor of player 2: the button report alone, without a report ID.
+ *
+ * IN Report, generated from PLAYER2_BUTTONS:
+ * Byte 1-: 
+ *      Bit status of each button, in table order (Active High)
+ *      Reserved bits up to the byte boundary.
+ *
+ * Keys are keypad 1 to 9, so the two players do not type the same keys.
+ */
+const USB_Descriptor_HIDReport_Datatype_t PROGMEM Player2Report[] =
+{
+    0x05, 0x01,                    // USAGE_PAGE (Generic Desktop)
+    0x09, 0x06,                    // USAGE (Keyboard)
+    0xa1, 0x01,                    // COLLECTION (Application)
+    BUTTON_REPORT_ITEMS(PLAYER2_BUTTONS)
+#if BUTTON_REPORT_PADDING(PLAYER2_BUTTON_COUNT) > 0
+    BUTTON_REPORT_PADDING_ITEMS(PLAYER2_BUTTONS)
+#endif
     0xc0                           // END_COLLECTION
 };
+#endif
 
 /** Device descriptor structure.
  */
@@ -75,9 +158,15 @@ const USB_Descriptor_Device_t PROGMEM DeviceDescriptor =
     .Header                 = {.Size = sizeof(USB_Descriptor_Device_t), .Type = DTYPE_Device},
 
     .USBSpecification       = VERSION_BCD(01.10),
+#if defined(DEBUG_CONSOLE_ENABLED) || defined(NETWORK_ENABLED)
+    .Class                  = USB_CSCP_IADDeviceClass,
+    .SubClass               = USB_CSCP_IADDeviceSubclass,
+    .Protocol               = USB_CSCP_IADDeviceProtocol,
+#else
     .Class                  = USB_CSCP_NoDeviceClass,
     .SubClass               = USB_CSCP_NoDeviceSubclass,
     .Protocol               = USB_CSCP_NoDeviceProtocol,
+#endif
 
     .Endpoint0Size          = FIXED_CONTROL_ENDPOINT_SIZE,
 
@@ -101,12 +190,12 @@ const USB_Descriptor_Configuration_t PROGMEM ConfigurationDescriptor =
             .Header                 = {.Size = sizeof(USB_Descriptor_Configuration_Header_t), .Type = DTYPE_Configuration},
 
             .TotalConfigurationSize = sizeof(USB_Descriptor_Configuration_t),
-            .TotalInterfaces        = 1,
+            .TotalInterfaces        = DEVICE_INTERFACE_COUNT,
 
             .ConfigurationNumber    = 1,
             .ConfigurationStrIndex  = NO_DESCRIPTOR,
 
-            .ConfigAttributes       = (USB_CONFIG_ATTR_BUSPOWERED | USB_CONFIG_ATTR_SELFPOWERED),
+            .ConfigAttributes       = (USB_CONFIG_ATTR_BUSPOWERED | USB_CONFIG_ATTR_SELFPOWERED | USB_CONFIG_ATTR_REMOTEWAKEUP),
 
             .MaxPowerConsumption    = USB_CONFIG_POWER_MA(300)
         },
@@ -147,6 +236,367 @@ const USB_Descriptor_Configuration_t PROGMEM ConfigurationDescriptor =
             .EndpointSize           = DEVICE_ENDPOINT_SIZE,
             .PollingIntervalMS      = 0x01
         },
+#if defined(TWO_PLAYER_ENABLED)
+    .Player2_Interface =
+        {
+            .Header                 = {.Size = sizeof(USB_Descriptor_Interface_t), .Type = DTYPE_Interface},
+
+            .InterfaceNumber        = PLAYER2_INTERFACE,
+            .AlternateSetting       = 0x00,
+
+            .TotalEndpoints         = 1,
+
+            .Class                  = HID_CSCP_HIDClass,
+            .SubClass               = HID_CSCP_NonBootSubclass,
+            .Protocol               = HID_CSCP_NonBootProtocol,
+
+            .InterfaceStrIndex      = NO_DESCRIPTOR
+        },
+
+    .Player2_KeyboardHID =
+        {
+            .Header                 = {.Size = sizeof(USB_HID_Descriptor_HID_t), .Type = HID_DTYPE_HID},
+
+            .HIDSpec                = VERSION_BCD(01.11),
+            .CountryCode            = 0x00,
+            .TotalReportDescriptors = 1,
+            .HIDReportType          = HID_DTYPE_Report,
+            .HIDReportLength        = sizeof(Player2Report)
+        },
+
+    .Player2_ReportINEndpoint =
+        {
+            .Header                 = {.Size = sizeof(USB_Descriptor_Endpoint_t), .Type = DTYPE_Endpoint},
+
+            .EndpointAddress        = (ENDPOINT_DESCRIPTOR_DIR_IN | PLAYER2_ENDPOINT_NUM),
+            .Attributes             = (EP_TYPE_INTERRUPT | ENDPOINT_ATTR_NO_SYNC | ENDPOINT_USAGE_DATA),
+            .EndpointSize           = DEVICE_ENDPOINT_SIZE,
+            .PollingIntervalMS      = 0x01
+        },
+#endif
+#if defined(DEBUG_CONSOLE_ENABLED)
+    .CDC_IAD =
+        {
+            .Header                 = {.Size = sizeof(USB_Descriptor_Interface_Association_t), .Type = DTYPE_InterfaceAssociation},
+            .FirstInterfaceIndex    = CONSOLE_CCI_INTERFACE,
+            .TotalInterfaces        = 2,
+            .Class                  = CDC_CSCP_CDCClass,
+            .SubClass               = CDC_CSCP_ACMSubclass,
+            .Protocol               = CDC_CSCP_ATCommandProtocol,
+            .IADStrIndex            = NO_DESCRIPTOR
+        },
+    .CDC_CCI_Interface =
+        {
+            .Header                 = {.Size = sizeof(USB_Descriptor_Interface_t), .Type = DTYPE_Interface},
+            .InterfaceNumber        = CONSOLE_CCI_INTERFACE,
+            .AlternateSetting       = 0,
+            .TotalEndpoints         = 1,
+            .Class                  = CDC_CSCP_CDCClass,
+            .SubClass               = CDC_CSCP_ACMSubclass,
+            .Protocol               = CDC_CSCP_ATCommandProtocol,
+            .InterfaceStrIndex      = NO_DESCRIPTOR
+        },
+    .CDC_Functional_Header =
+        {
+            .Header                 = {.Size = sizeof(USB_CDC_Descriptor_FunctionalHeader_t), .Type = DTYPE_CSInterface},
+            .Subtype                = CDC_DSUBTYPE_CSInterface_Header,
+            .CDCSpecification       = VERSION_BCD(01.10),
+        },
+    .CDC_Functional_ACM =
+        {
+            .Header                 = {.Size = sizeof(USB_CDC_Descriptor_FunctionalACM_t), .Type = DTYPE_CSInterface},
+            .Subtype                = CDC_DSUBTYPE_CSInterface_ACM,
+            .Capabilities           = 0x06,
+        },
+    .CDC_Functional_Union =
+        {
+            .Header                 = {.Size = sizeof(USB_CDC_Descriptor_FunctionalUnion_t), .Type = DTYPE_CSInterface},
+            .Subtype                = CDC_DSUBTYPE_CSInterface_Union,
+            .MasterInterfaceNumber  = CONSOLE_CCI_INTERFACE,
+            .SlaveInterfaceNumber   = CONSOLE_DCI_INTERFACE,
+        },
+    .CDC_NotificationEndpoint =
+        {
+            .Header                 = {.Size = sizeof(USB_Descriptor_Endpoint_t), .Type = DTYPE_Endpoint},
+            .EndpointAddress        = (ENDPOINT_DESCRIPTOR_DIR_IN | CONSOLE_NOTIFICATION_EPNUM),
+            .Attributes             = (EP_TYPE_INTERRUPT | ENDPOINT_ATTR_NO_SYNC | ENDPOINT_USAGE_DATA),
+            .EndpointSize           = CONSOLE_NOTIFICATION_EPSIZE,
+            .PollingIntervalMS      = 0xFF
+        },
+    .CDC_DCI_Interface =
+        {
+            .Header                 = {.Size = sizeof(USB_Descriptor_Interface_t), .Type = DTYPE_Interface},
+            .InterfaceNumber        = CONSOLE_DCI_INTERFACE,
+            .AlternateSetting       = 0,
+            .TotalEndpoints         = 2,
+            .Class                  = CDC_CSCP_CDCDataClass,
+            .SubClass               = CDC_CSCP_NoDataSubclass,
+            .Protocol               = CDC_CSCP_NoDataProtocol,
+            .InterfaceStrIndex      = NO_DESCRIPTOR
+        },
+    .CDC_DataOutEndpoint =
+        {
+            .Header                 = {.Size = sizeof(USB_Descriptor_Endpoint_t), .Type = DTYPE_Endpoint},
+            .EndpointAddress        = (ENDPOINT_DESCRIPTOR_DIR_OUT | CONSOLE_RX_EPNUM),
+            .Attributes             = (EP_TYPE_BULK | ENDPOINT_ATTR_NO_SYNC | ENDPOINT_USAGE_DATA),
+            .EndpointSize           = CONSOLE_TXRX_EPSIZE,
+            .PollingIntervalMS      = 0x01
+        },
+    .CDC_DataInEndpoint =
+        {
+            .Header                 = {.Size = sizeof(USB_Descriptor_Endpoint_t), .Type = DTYPE_Endpoint},
+            .EndpointAddress        = (ENDPOINT_DESCRIPTOR_DIR_IN | CONSOLE_TX_EPNUM),
+            .Attributes             = (EP_TYPE_BULK | ENDPOINT_ATTR_NO_SYNC | ENDPOINT_USAGE_DATA),
+            .EndpointSize           = CONSOLE_TXRX_EPSIZE,
+            .PollingIntervalMS      = 0x01
+        },
+#endif
+#if defined(MIDI_ENABLED)
+    .MIDI_AC_Interface =
+        {
+            .Header                 = {.Size = sizeof(USB_Descriptor_Interface_t), .Type = DTYPE_Interface},
+            .InterfaceNumber        = MIDI_AC_INTERFACE,
+            .AlternateSetting       = 0,
+            .TotalEndpoints         = 0,
+            .Class                  = AUDIO_CSCP_AudioClass,
+            .SubClass               = AUDIO_CSCP_ControlSubclass,
+            .Protocol               = AUDIO_CSCP_ControlProtocol,
+            .InterfaceStrIndex      = NO_DESCRIPTOR
+        },
+    .MIDI_AC_Interface_SPC =
+        {
+            .Header                 = {.Size = sizeof(USB_Audio_Descriptor_Interface_AC_t), .Type = DTYPE_CSInterface},
+            .Subtype                = AUDIO_DSUBTYPE_CSInterface_Header,
+            .ACSpecification        = VERSION_BCD(01.00),
+            .TotalLength            = sizeof(USB_Audio_Descriptor_Interface_AC_t),
+            .InCollection           = 1,
+            .InterfaceNumber        = MIDI_AS_INTERFACE,
+        },
+    .MIDI_AS_Interface =
+        {
+            .Header                 = {.Size = sizeof(USB_Descriptor_Interface_t), .Type = DTYPE_Interface},
+            .InterfaceNumber        = MIDI_AS_INTERFACE,
+            .AlternateSetting       = 0,
+            .TotalEndpoints         = 2,
+            .Class                  = AUDIO_CSCP_AudioClass,
+            .SubClass               = AUDIO_CSCP_MIDIStreamingSubclass,
+            .Protocol               = AUDIO_CSCP_StreamingProtocol,
+            .InterfaceStrIndex      = NO_DESCRIPTOR
+        },
+    .MIDI_AS_Interface_SPC =
+        {
+            .Header                 = {.Size = sizeof(USB_MIDI_Descriptor_AudioInterface_AS_t), .Type = DTYPE_CSInterface},
+            .Subtype                = AUDIO_DSUBTYPE_CSInterface_General,
+            .AudioSpecification     = VERSION_BCD(01.00),
+            .TotalLength            = (sizeof(USB_Descriptor_Configuration_t) -
+                                       offsetof(USB_Descriptor_Configuration_t, MIDI_AS_Interface_SPC))
+        },
+    .MIDI_In_Jack_Emb =
+        {
+            .Header                 = {.Size = sizeof(USB_MIDI_Descriptor_InputJack_t), .Type = DTYPE_CSInterface},
+            .Subtype                = AUDIO_DSUBTYPE_CSInterface_InputTerminal,
+            .JackType               = MIDI_JACKTYPE_Embedded,
+            .JackID                 = 0x01,
+            .JackStrIndex           = NO_DESCRIPTOR
+        },
+    .MIDI_In_Jack_Ext =
+        {
+            .Header                 = {.Size = sizeof(USB_MIDI_Descriptor_InputJack_t), .Type = DTYPE_CSInterface},
+            .Subtype                = AUDIO_DSUBTYPE_CSInterface_InputTerminal,
+            .JackType               = MIDI_JACKTYPE_External,
+            .JackID                 = 0x02,
+            .JackStrIndex           = NO_DESCRIPTOR
+        },
+    .MIDI_Out_Jack_Emb =
+        {
+            .Header                 = {.Size = sizeof(USB_MIDI_Descriptor_OutputJack_t), .Type = DTYPE_CSInterface},
+            .Subtype                = AUDIO_DSUBTYPE_CSInterface_OutputTerminal,
+            .JackType               = MIDI_JACKTYPE_Embedded,
+            .JackID                 = 0x03,
+            .NumberOfPins           = 1,
+            .SourceJackID           = {0x02},
+            .SourcePinID            = {0x01},
+            .JackStrIndex           = NO_DESCRIPTOR
+        },
+    .MIDI_Out_Jack_Ext =
+        {
+            .Header                 = {.Size = sizeof(USB_MIDI_Descriptor_OutputJack_t), .Type = DTYPE_CSInterface},
+            .Subtype                = AUDIO_DSUBTYPE_CSInterface_OutputTerminal,
+            .JackType               = MIDI_JACKTYPE_External,
+            .JackID                 = 0x04,
+            .NumberOfPins           = 1,
+            .SourceJackID           = {0x01},
+            .SourcePinID            = {0x01},
+            .JackStrIndex           = NO_DESCRIPTOR
+        },
+    .MIDI_In_Jack_Endpoint =
+        {
+            .Endpoint               =
+                {
+                    .Header             = {.Size = sizeof(USB_Audio_Descriptor_StreamEndpoint_Std_t), .Type = DTYPE_Endpoint},
+                    .EndpointAddress    = (ENDPOINT_DESCRIPTOR_DIR_OUT | MIDI_STREAM_OUT_EPNUM),
+                    .Attributes         = (EP_TYPE_BULK | ENDPOINT_ATTR_NO_SYNC | ENDPOINT_USAGE_DATA),
+                    .EndpointSize       = MIDI_STREAM_OUT_EPSIZE,
+                    .PollingIntervalMS  = 0x01
+                },
+            .Refresh                = 0,
+            .SyncEndpointNumber     = 0
+        },
+    .MIDI_In_Jack_Endpoint_SPC =
+        {
+            .Header                 = {.Size = sizeof(USB_MIDI_Descriptor_Jack_Endpoint_t), .Type = DTYPE_CSEndpoint},
+            .Subtype                = AUDIO_DSUBTYPE_CSEndpoint_General,
+            .TotalEmbeddedJacks     = 0x01,
+            .AssociatedJackID       = {0x01}
+        },
+    .MIDI_Out_Jack_Endpoint =
+        {
+            .Endpoint               =
+                {
+                    .Header             = {.Size = sizeof(USB_Audio_Descriptor_StreamEndpoint_Std_t), .Type = DTYPE_Endpoint},
+                    .EndpointAddress    = (ENDPOINT_DESCRIPTOR_DIR_IN | MIDI_STREAM_IN_EPNUM),
+                    .Attributes         = (EP_TYPE_BULK | ENDPOINT_ATTR_NO_SYNC | ENDPOINT_USAGE_DATA),
+                    .EndpointSize       = MIDI_STREAM_IN_EPSIZE,
+                    .PollingIntervalMS  = 0x01
+                },
+            .Refresh                = 0,
+            .SyncEndpointNumber     = 0
+        },
+    .MIDI_Out_Jack_Endpoint_SPC =
+        {
+            .Header                 = {.Size = sizeof(USB_MIDI_Descriptor_Jack_Endpoint_t), .Type = DTYPE_CSEndpoint},
+            .Subtype                = AUDIO_DSUBTYPE_CSEndpoint_General,
+            .TotalEmbeddedJacks     = 0x01,
+            .AssociatedJackID       = {0x03}
+        },
+#endif
+#if defined(CONFIG_DRIVE_ENABLED)
+    .Drive_Interface =
+        {
+            .Header                 = {.Size = sizeof(USB_Descriptor_Interface_t), .Type = DTYPE_Interface},
+            .InterfaceNumber        = CONFIG_DRIVE_INTERFACE,
+            .AlternateSetting       = 0,
+            .TotalEndpoints         = 2,
+            .Class                  = MS_CSCP_MassStorageClass,
+            .SubClass               = MS_CSCP_SCSITransparentSubclass,
+            .Protocol               = MS_CSCP_BulkOnlyTransportProtocol,
+            .InterfaceStrIndex      = NO_DESCRIPTOR
+        },
+    .Drive_DataInEndpoint =
+        {
+            .Header                 = {.Size = sizeof(USB_Descriptor_Endpoint_t), .Type = DTYPE_Endpoint},
+            .EndpointAddress        = (ENDPOINT_DESCRIPTOR_DIR_IN | CONFIG_DRIVE_IN_EPNUM),
+            .Attributes             = (EP_TYPE_BULK | ENDPOINT_ATTR_NO_SYNC | ENDPOINT_USAGE_DATA),
+            .EndpointSize           = CONFIG_DRIVE_EPSIZE,
+            .PollingIntervalMS      = 0x01
+        },
+    .Drive_DataOutEndpoint =
+        {
+            .Header                 = {.Size = sizeof(USB_Descriptor_Endpoint_t), .Type = DTYPE_Endpoint},
+            .EndpointAddress        = (ENDPOINT_DESCRIPTOR_DIR_OUT | CONFIG_DRIVE_OUT_EPNUM),
+            .Attributes             = (EP_TYPE_BULK | ENDPOINT_ATTR_NO_SYNC | ENDPOINT_USAGE_DATA),
+            .EndpointSize           = CONFIG_DRIVE_EPSIZE,
+            .PollingIntervalMS      = 0x01
+        },
+#endif
+#if defined(RECORDER_ENABLED)
+    .Recorder_Interface =
+        {
+            .Header                 = {.Size = sizeof(USB_Descriptor_Interface_t), .Type = DTYPE_Interface},
+            .InterfaceNumber        = RECORDER_INTERFACE,
+            .AlternateSetting       = 0,
+            .TotalEndpoints         = 1,
+            .Class                  = USB_CSCP_VendorSpecificClass,
+            .SubClass               = USB_CSCP_NoDeviceSubclass,
+            .Protocol               = USB_CSCP_NoDeviceProtocol,
+            .InterfaceStrIndex      = NO_DESCRIPTOR
+        },
+    .Recorder_DataInEndpoint =
+        {
+            .Header                 = {.Size = sizeof(USB_Descriptor_Endpoint_t), .Type = DTYPE_Endpoint},
+            .EndpointAddress        = (ENDPOINT_DESCRIPTOR_DIR_IN | RECORDER_IN_EPNUM),
+            .Attributes             = (EP_TYPE_BULK | ENDPOINT_ATTR_NO_SYNC | ENDPOINT_USAGE_DATA),
+            .EndpointSize           = RECORDER_EPSIZE,
+            .PollingIntervalMS      = 0x01
+        },
+#endif
+#if defined(NETWORK_ENABLED)
+    .RNDIS_IAD =
+        {
+            .Header                 = {.Size = sizeof(USB_Descriptor_Interface_Association_t), .Type = DTYPE_InterfaceAssociation},
+            .FirstInterfaceIndex    = NETWORK_CCI_INTERFACE,
+            .TotalInterfaces        = 2,
+            .Class                  = CDC_CSCP_CDCClass,
+            .SubClass               = CDC_CSCP_ACMSubclass,
+            .Protocol               = CDC_CSCP_VendorSpecificProtocol,
+            .IADStrIndex            = NO_DESCRIPTOR
+        },
+    .RNDIS_CCI_Interface =
+        {
+            .Header                 = {.Size = sizeof(USB_Descriptor_Interface_t), .Type = DTYPE_Interface},
+            .InterfaceNumber        = NETWORK_CCI_INTERFACE,
+            .AlternateSetting       = 0,
+            .TotalEndpoints         = 1,
+            .Class                  = CDC_CSCP_CDCClass,
+            .SubClass               = CDC_CSCP_ACMSubclass,
+            .Protocol               = CDC_CSCP_VendorSpecificProtocol,
+            .InterfaceStrIndex      = NO_DESCRIPTOR
+        },
+    .RNDIS_Functional_Header =
+        {
+            .Header                 = {.Size = sizeof(USB_CDC_Descriptor_FunctionalHeader_t), .Type = DTYPE_CSInterface},
+            .Subtype                = CDC_DSUBTYPE_CSInterface_Header,
+            .CDCSpecification       = VERSION_BCD(01.10),
+        },
+    .RNDIS_Functional_ACM =
+        {
+            .Header                 = {.Size = sizeof(USB_CDC_Descriptor_FunctionalACM_t), .Type = DTYPE_CSInterface},
+            .Subtype                = CDC_DSUBTYPE_CSInterface_ACM,
+            .Capabilities           = 0x00,
+        },
+    .RNDIS_Functional_Union =
+        {
+            .Header                 = {.Size = sizeof(USB_CDC_Descriptor_FunctionalUnion_t), .Type = DTYPE_CSInterface},
+            .Subtype                = CDC_DSUBTYPE_CSInterface_Union,
+            .MasterInterfaceNumber  = NETWORK_CCI_INTERFACE,
+            .SlaveInterfaceNumber   = NETWORK_DCI_INTERFACE,
+        },
+    .RNDIS_NotificationEndpoint =
+        {
+            .Header                 = {.Size = sizeof(USB_Descriptor_Endpoint_t), .Type = DTYPE_Endpoint},
+            .EndpointAddress        = (ENDPOINT_DESCRIPTOR_DIR_IN | NETWORK_NOTIFICATION_EPNUM),
+            .Attributes             = (EP_TYPE_INTERRUPT | ENDPOINT_ATTR_NO_SYNC | ENDPOINT_USAGE_DATA),
+            .EndpointSize           = NETWORK_NOTIFICATION_EPSIZE,
+            .PollingIntervalMS      = 0xFF
+        },
+    .RNDIS_DCI_Interface =
+        {
+            .Header                 = {.Size = sizeof(USB_Descriptor_Interface_t), .Type = DTYPE_Interface},
+            .InterfaceNumber        = NETWORK_DCI_INTERFACE,
+            .AlternateSetting       = 0,
+            .TotalEndpoints         = 2,
+            .Class                  = CDC_CSCP_CDCDataClass,
+            .SubClass               = CDC_CSCP_NoDataSubclass,
+            .Protocol               = CDC_CSCP_NoDataProtocol,
+            .InterfaceStrIndex      = NO_DESCRIPTOR
+        },
+    .RNDIS_DataOutEndpoint =
+        {
+            .Header                 = {.Size = sizeof(USB_Descriptor_Endpoint_t), .Type = DTYPE_Endpoint},
+            .EndpointAddress        = (ENDPOINT_DESCRIPTOR_DIR_OUT | NETWORK_RX_EPNUM),
+            .Attributes             = (EP_TYPE_BULK | ENDPOINT_ATTR_NO_SYNC | ENDPOINT_USAGE_DATA),
+            .EndpointSize           = NETWORK_TXRX_EPSIZE,
+            .PollingIntervalMS      = 0x01
+        },
+    .RNDIS_DataInEndpoint =
+        {
+            .Header                 = {.Size = sizeof(USB_Descriptor_Endpoint_t), .Type = DTYPE_Endpoint},
+            .EndpointAddress        = (ENDPOINT_DESCRIPTOR_DIR_IN | NETWORK_TX_EPNUM),
+            .Attributes             = (EP_TYPE_BULK | ENDPOINT_ATTR_NO_SYNC | ENDPOINT_USAGE_DATA),
+            .EndpointSize           = NETWORK_TXRX_EPSIZE,
+            .PollingIntervalMS      = 0x01
+        },
+#endif
 };
 
 /** Language descriptor structure. 
@@ -218,10 +668,26 @@ uint16_t CALLBACK_USB_GetDescriptor(const uint16_t wValue,
 
             break;
         case HID_DTYPE_HID:
+#if defined(TWO_PLAYER_ENABLED)
+            if (wIndex == PLAYER2_INTERFACE)
+            {
+                Address = &ConfigurationDescriptor.Player2_KeyboardHID;
+                Size    = sizeof(USB_HID_Descriptor_HID_t);
+                break;
+            }
+#endif
             Address = &ConfigurationDescriptor.HID_KeyboardHID;
             Size    = sizeof(USB_HID_Descriptor_HID_t);
             break;
         case HID_DTYPE_Report:
+#if defined(TWO_PLAYER_ENABLED)
+            if (wIndex == PLAYER2_INTERFACE)
+            {
+                Address = &Player2Report;
+                Size    = sizeof(Player2Report);
+                break;
+            }
+#endif
             Address = &KeyboardReport;
             Size    = sizeof(KeyboardReport);
             break;
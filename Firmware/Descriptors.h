@@ -39,6 +39,8 @@
 #ifndef _DESCRIPTORS_H_
 #define _DESCRIPTORS_H_
 
+#include "ButtonLayout.h"
+
 #include <LUFA/Drivers/USB/USB.h>
 
 /** Type define for the device configuration descriptor structure. */
@@ -48,6 +50,56 @@ typedef struct
     USB_Descriptor_Interface_t            HID_Interface;
     USB_HID_Descriptor_HID_t              HID_KeyboardHID;
     USB_Descriptor_Endpoint_t             HID_ReportINEndpoint;
+#if defined(TWO_PLAYER_ENABLED)
+    USB_Descriptor_Interface_t            Player2_Interface;
+    USB_HID_Descriptor_HID_t              Player2_KeyboardHID;
+    USB_Descriptor_Endpoint_t             Player2_ReportINEndpoint;
+#endif
+#if defined(DEBUG_CONSOLE_ENABLED)
+    USB_Descriptor_Interface_Association_t CDC_IAD;
+    USB_Descriptor_Interface_t            CDC_CCI_Interface;
+    USB_CDC_Descriptor_FunctionalHeader_t CDC_Functional_Header;
+    USB_CDC_Descriptor_FunctionalACM_t    CDC_Functional_ACM;
+    USB_CDC_Descriptor_FunctionalUnion_t  CDC_Functional_Union;
+    USB_Descriptor_Endpoint_t             CDC_NotificationEndpoint;
+    USB_Descriptor_Interface_t            CDC_DCI_Interface;
+    USB_Descriptor_Endpoint_t             CDC_DataOutEndpoint;
+    USB_Descriptor_Endpoint_t             CDC_DataInEndpoint;
+#endif
+#if defined(MIDI_ENABLED)
+    USB_Descriptor_Interface_t                MIDI_AC_Interface;
+    USB_Audio_Descriptor_Interface_AC_t       MIDI_AC_Interface_SPC;
+    USB_Descriptor_Interface_t                MIDI_AS_Interface;
+    USB_MIDI_Descriptor_AudioInterface_AS_t   MIDI_AS_Interface_SPC;
+    USB_MIDI_Descriptor_InputJack_t           MIDI_In_Jack_Emb;
+    USB_MIDI_Descriptor_InputJack_t           MIDI_In_Jack_Ext;
+    USB_MIDI_Descriptor_OutputJack_t          MIDI_Out_Jack_Emb;
+    USB_MIDI_Descriptor_OutputJack_t          MIDI_Out_Jack_Ext;
+    USB_Audio_Descriptor_StreamEndpoint_Std_t MIDI_In_Jack_Endpoint;
+    USB_MIDI_Descriptor_Jack_Endpoint_t       MIDI_In_Jack_Endpoint_SPC;
+    USB_Audio_Descriptor_StreamEndpoint_Std_t MIDI_Out_Jack_Endpoint;
+    USB_MIDI_Descriptor_Jack_Endpoint_t       MIDI_Out_Jack_Endpoint_SPC;
+#endif
+#if defined(CONFIG_DRIVE_ENABLED)
+    USB_Descriptor_Interface_t            Drive_Interface;
+    USB_Descriptor_Endpoint_t             Drive_DataInEndpoint;
+    USB_Descriptor_Endpoint_t             Drive_DataOutEndpoint;
+#endif
+#if defined(RECORDER_ENABLED)
+    USB_Descriptor_Interface_t            Recorder_Interface;
+    USB_Descriptor_Endpoint_t             Recorder_DataInEndpoint;
+#endif
+#if defined(NETWORK_ENABLED)
+    USB_Descriptor_Interface_Association_t RNDIS_IAD;
+    USB_Descriptor_Interface_t            RNDIS_CCI_Interface;
+    USB_CDC_Descriptor_FunctionalHeader_t RNDIS_Functional_Header;
+    USB_CDC_Descriptor_FunctionalACM_t    RNDIS_Functional_ACM;
+    USB_CDC_Descriptor_FunctionalUnion_t  RNDIS_Functional_Union;
+    USB_Descriptor_Endpoint_t             RNDIS_NotificationEndpoint;
+    USB_Descriptor_Interface_t            RNDIS_DCI_Interface;
+    USB_Descriptor_Endpoint_t             RNDIS_DataOutEndpoint;
+    USB_Descriptor_Endpoint_t             RNDIS_DataInEndpoint;
+#endif
 } USB_Descriptor_Configuration_t;
 
 /** Endpoint number of the Keyboard HID reporting IN endpoint. */
@@ -56,6 +108,147 @@ typedef struct
 /** Size in bytes of the Keyboard HID reporting IN and OUT endpoints. */
 #define DEVICE_ENDPOINT_SIZE              8
 
+/** Number of buttons in each player's report, see ButtonLayout.h. */
+#define PLAYER1_BUTTON_COUNT              BUTTON_LAYOUT_COUNT(PLAYER1_BUTTONS)
+#define PLAYER2_BUTTON_COUNT              BUTTON_LAYOUT_COUNT(PLAYER2_BUTTONS)
+
+#if BUTTON_REPORT_BYTES(PLAYER1_BUTTON_COUNT) + 1 > DEVICE_ENDPOINT_SIZE || \
+    BUTTON_REPORT_BYTES(PLAYER2_BUTTON_COUNT) > DEVICE_ENDPOINT_SIZE
+#error Button reports do not fit DEVICE_ENDPOINT_SIZE.
+#endif
+
+#if defined(TWO_PLAYER_ENABLED)
+/** Interface and reporting IN endpoint numbers of the player 2 keyboard; its endpoint size is DEVICE_ENDPOINT_SIZE. */
+#define PLAYER2_INTERFACE                 1
+#define PLAYER2_ENDPOINT_NUM              4
+
+/** Number of HID interfaces, which come first in the configuration. */
+#define HID_INTERFACE_COUNT               2
+#else
+/** Number of HID interfaces, which come first in the configuration. */
+#define HID_INTERFACE_COUNT               1
+#endif
+
+#if defined(DEBUG_CONSOLE_ENABLED) && (defined(MIDI_ENABLED) || defined(TWO_PLAYER_ENABLED))
+#error DEBUG_CONSOLE_ENABLED with MIDI_ENABLED or TWO_PLAYER_ENABLED needs more endpoints than the AT90USB162 has.
+#endif
+
+#if defined(CONFIG_DRIVE_ENABLED) && (defined(DEBUG_CONSOLE_ENABLED) || defined(MIDI_ENABLED))
+#error CONFIG_DRIVE_ENABLED with DEBUG_CONSOLE_ENABLED or MIDI_ENABLED needs more endpoints than the AT90USB162 has.
+#endif
+
+#if defined(RECORDER_ENABLED) && (defined(DEBUG_CONSOLE_ENABLED) || defined(MIDI_ENABLED) || defined(CONFIG_DRIVE_ENABLED))
+#error RECORDER_ENABLED with DEBUG_CONSOLE_ENABLED, MIDI_ENABLED or CONFIG_DRIVE_ENABLED needs more endpoints than the AT90USB162 has.
+#endif
+
+#if defined(NETWORK_ENABLED) && (defined(DEBUG_CONSOLE_ENABLED) || defined(MIDI_ENABLED) || defined(CONFIG_DRIVE_ENABLED) || \
+                                 defined(RECORDER_ENABLED) || defined(TWO_PLAYER_ENABLED))
+#error NETWORK_ENABLED with any other extra interface needs more endpoints than the AT90USB162 has.
+#endif
+
+#if defined(NETWORK_ENABLED) && !defined(TELEMETRY_ENABLED)
+#error NETWORK_ENABLED carries the telemetry frames, so it needs TELEMETRY_ENABLED.
+#endif
+
+#if defined(DEBUG_CONSOLE_ENABLED)
+/** Interface numbers of the debug console's CDC control and data interfaces. */
+#define CONSOLE_CCI_INTERFACE             (HID_INTERFACE_COUNT + 0)
+#define CONSOLE_DCI_INTERFACE             (HID_INTERFACE_COUNT + 1)
+
+/** Endpoint numbers of the debug console's notification, IN (to host) and OUT endpoints. */
+#define CONSOLE_NOTIFICATION_EPNUM        2
+#define CONSOLE_TX_EPNUM                  3
+#define CONSOLE_RX_EPNUM                  4
+
+/** Size in bytes of the debug console's notification and data endpoints. */
+#define CONSOLE_NOTIFICATION_EPSIZE       8
+#define CONSOLE_TXRX_EPSIZE               16
+
+/** Number of interfaces in the configuration. */
+#define DEVICE_INTERFACE_COUNT            (HID_INTERFACE_COUNT + 2)
+#elif defined(MIDI_ENABLED)
+/** Interface numbers of the MIDI audio control and MIDI streaming interfaces. */
+#define MIDI_AC_INTERFACE                 (HID_INTERFACE_COUNT + 0)
+#define MIDI_AS_INTERFACE                 (HID_INTERFACE_COUNT + 1)
+
+/** Endpoint numbers of the MIDI streaming IN (to host) and OUT endpoints. */
+#define MIDI_STREAM_IN_EPNUM              2
+#define MIDI_STREAM_OUT_EPNUM             3
+
+/** Size in bytes of the MIDI streaming endpoints; the IN one holds a frame of edges of 16 buttons. */
+#define MIDI_STREAM_IN_EPSIZE             64
+#define MIDI_STREAM_OUT_EPSIZE            16
+
+/** Number of interfaces in the configuration. */
+#define DEVICE_INTERFACE_COUNT            (HID_INTERFACE_COUNT + 2)
+#elif defined(CONFIG_DRIVE_ENABLED)
+/** Interface number of the configuration drive's mass storage interface. */
+#define CONFIG_DRIVE_INTERFACE            HID_INTERFACE_COUNT
+
+/** Endpoint numbers of the configuration drive's IN (to host) and OUT endpoints. */
+#define CONFIG_DRIVE_IN_EPNUM             2
+#define CONFIG_DRIVE_OUT_EPNUM            3
+
+/** Size in bytes of the configuration drive's endpoints; a divisor of the block size. */
+#define CONFIG_DRIVE_EPSIZE               64
+
+/** Number of interfaces in the configuration. */
+#define DEVICE_INTERFACE_COUNT            (HID_INTERFACE_COUNT + 1)
+#elif defined(RECORDER_ENABLED)
+/** Interface number of the recorder's vendor specific dump interface. */
+#define RECORDER_INTERFACE                HID_INTERFACE_COUNT
+
+/** Endpoint number and size of the recorder's bulk IN endpoint; the size divides the dataflash page. */
+#define RECORDER_IN_EPNUM                 2
+#define RECORDER_EPSIZE                   64
+
+/** Number of interfaces in the configuration. */
+#define DEVICE_INTERFACE_COUNT            (HID_INTERFACE_COUNT + 1)
+#elif defined(NETWORK_ENABLED)
+/** Interface numbers of the RNDIS control and data interfaces. */
+#define NETWORK_CCI_INTERFACE             (HID_INTERFACE_COUNT + 0)
+#define NETWORK_DCI_INTERFACE             (HID_INTERFACE_COUNT + 1)
+
+/** Endpoint numbers of the RNDIS notification, IN (to host) and OUT endpoints. */
+#define NETWORK_NOTIFICATION_EPNUM        2
+#define NETWORK_TX_EPNUM                  3
+#define NETWORK_RX_EPNUM                  4
+
+/** Size in bytes of the RNDIS notification and data endpoints. */
+#define NETWORK_NOTIFICATION_EPSIZE       8
+#define NETWORK_TXRX_EPSIZE               64
+
+/** Number of interfaces in the configuration. */
+#define DEVICE_INTERFACE_COUNT            (HID_INTERFACE_COUNT + 2)
+#else
+/** Number of interfaces in the configuration. */
+#define DEVICE_INTERFACE_COUNT            HID_INTERFACE_COUNT
+#endif
+
+/** Report ID of the button IN report. */
+#define HID_REPORTID_BUTTONS              1
+
+/** Report ID of the configuration feature report, see Config.h. */
+#define HID_REPORTID_CONFIG               2
+
+/** Report ID of the switch statistics feature report, see Stats.h. */
+#define HID_REPORTID_STATS                3
+
+/** Report ID of the RAM usage feature report, see Memory.h. */
+#define HID_REPORTID_MEMORY               4
+
+/** Report ID of the passthrough latency feature report (PASSTHROUGH_INPUTS), see Passthrough.h. */
+#define HID_REPORTID_PASSTHROUGH          5
+
+/** Report ID of the watchdog reset feature report, see Watchdog.h. */
+#define HID_REPORTID_WATCHDOG             6
+
+/** Report ID of the scheduler latency feature report, see PopnAsc.h. */
+#define HID_REPORTID_SCHEDULER            7
+
+/** Report ID of the MIDI counters feature report (MIDI_ENABLED), see Midi.h. */
+#define HID_REPORTID_MIDI                 8
+
 uint16_t CALLBACK_USB_GetDescriptor(const uint16_t wValue,
                                     const uint8_t wIndex,
                                     const void** const DescriptorAddress)
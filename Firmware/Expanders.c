@@ -0,0 +1,139 @@
+/*
+  Pop'n Convertible Arcade Style Controller Project
+ 
+  Copyright 2011 Sam Wong (Sam /@/ hellosam /./ net)
+
+  This work is licensed under the Creative Commons Attribution 3.0 
+  Hong Kong License. 
+
+  To view a copy of this license, visit 
+  http://creativecommons.org/licenses/by/3.0/hk/ or send a letter to 
+  Creative Commons, 444 Castro Street, Suite 900, 
+  Mountain View, California, 94041, USA.  
+*/
+
+#include "Expanders.h"
+
+#include <LUFA/Drivers/Peripheral/TWIAsync.h>
+
+#if EXPANDER_COUNT < 1 || EXPANDER_COUNT > 2
+#error EXPANDER_COUNT must be 1 or 2.
+#endif
+
+/// MCP23017 register addresses (IOCON.BANK = 0, the power-on default)
+#define MCP_IODIRA 0x00
+#define MCP_GPIOA  0x12
+#define MCP_OLATB  0x15
+
+typedef struct
+{
+    TWIAsync_Transaction_t config;
+    TWIAsync_Transaction_t poll;
+    TWIAsync_Transaction_t lamp;
+    /// [Bitmap] Port A inputs from the last successful poll (active high)
+    uint8_t input;
+    /// OLATB register address followed by the lamp state being written
+    uint8_t lampData[2];
+} Expander_t;
+
+/** Power-on configuration, written sequentially from IODIRA:
+ * IODIRA/B = inputs/outputs, IPOLA/B = inverted/normal, interrupts off,
+ * IOCON left at default, GPPUA = pull-ups on.
+ */
+static const uint8_t configData[] =
+{
+    MCP_IODIRA,
+    0xFF, 0x00,     // IODIRA, IODIRB
+    0xFF, 0x00,     // IPOLA, IPOLB
+    0x00, 0x00,     // GPINTENA, GPINTENB
+    0x00, 0x00,     // DEFVALA, DEFVALB
+    0x00, 0x00,     // INTCONA, INTCONB
+    0x00, 0x00,     // IOCON, IOCON
+    0xFF,           // GPPUA
+};
+
+static const uint8_t pollRegister = MCP_GPIOA;
+
+static Expander_t expanders[EXPANDER_COUNT];
+
+/** Initialize the TWI bus and queue the expander configuration. The
+ *  transfers run once global interrupts are enabled.
+ */
+void Expanders_Init(void)
+{
+    unsigned char i;
+
+    TWIAsync_Init(TWI_ASYNC_BIT_PRESCALE_1, EXPANDER_TWI_BIT_LENGTH);
+
+    for (i = 0; i < EXPANDER_COUNT; i++)
+    {
+        Expander_t* e = &expanders[i];
+        uint8_t address = (EXPANDER_BASE_ADDRESS + i) << 1;
+
+        e->config.SlaveAddress = address;
+        e->config.WriteBuffer  = configData;
+        e->config.WriteLength  = sizeof(configData);
+
+        e->poll.SlaveAddress   = address;
+        e->poll.WriteBuffer    = &pollRegister;
+        e->poll.WriteLength    = 1;
+        e->poll.ReadBuffer     = &e->input;
+        e->poll.ReadLength     = 1;
+
+        e->lampData[0]         = MCP_OLATB;
+        e->lampData[1]         = 0;
+        e->lamp.SlaveAddress   = address;
+        e->lamp.WriteBuffer    = e->lampData;
+        e->lamp.WriteLength    = sizeof(e->lampData);
+
+        TWIAsync_Submit(&e->config);
+    }
+}
+
+/** Start this frame's input poll. Skipped for an expander whose previous
+ *  poll has not finished yet, so a stuck bus never builds a backlog.
+ */
+void Expanders_StartOfFrame(void)
+{
+    unsigned char i;
+
+    for (i = 0; i < EXPANDER_COUNT; i++)
+    {
+        TWIAsync_Submit(&expanders[i].poll);
+    }
+}
+
+/** [Bitmap] Inputs of all expanders, expander n port A at bits 8n to 8n+7.
+ *  A failed poll leaves the previous value in place.
+ */
+uint16_t Expanders_GetInputs(void)
+{
+    uint16_t inputs = expanders[0].input;
+
+#if EXPANDER_COUNT > 1
+    inputs |= (uint16_t) expanders[1].input << 8;
+#endif
+
+    return inputs;
+}
+
+/** Drive the lamps, expander n port B from bits 8n to 8n+7. Only changed
+ *  ports are written; a change arriving while the previous write is still
+ *  on the bus is picked up on a later frame.
+ */
+void Expanders_SetLamps(uint16_t lamps)
+{
+    unsigned char i;
+
+    for (i = 0; i < EXPANDER_COUNT; i++)
+    {
+        Expander_t* e = &expanders[i];
+        uint8_t value = (lamps >> (i * 8)) & 0xFF;
+
+        if (value != e->lampData[1] && !TWIAsync_IsPending(&e->lamp))
+        {
+            e->lampData[1] = value;
+            TWIAsync_Submit(&e->lamp);
+        }
+    }
+}
@@ -0,0 +1,57 @@
+/*
+  Pop'n Convertible Arcade Style Controller Project
+ 
+  Copyright 2011 Sam Wong (Sam /@/ hellosam /./ net)
+
+  This work is licensed under the Creative Commons Attribution 3.0 
+  Hong Kong License. 
+
+  To view a copy of this license, visit 
+  http://creativecommons.org/licenses/by/3.0/hk/ or send a letter to 
+  Creative Commons, 444 Castro Street, Suite 900, 
+  Mountain View, California, 94041, USA.  
+*/
+
+#ifndef _EXPANDERS_H_
+#define _EXPANDERS_H_
+
+#include <stdint.h>
+
+/** MCP23017 I2C port expanders, driven by the asynchronous TWI driver.
+ *
+ * Port A of each expander is 8 button inputs (wired like the direct
+ * buttons: pulled up, active low, inverted by the expander's IPOL register
+ * so they read active high). Port B is 8 lamp outputs.
+ *
+ * Bus budget with TWBR = 10 at 8MHz (SCL = 8MHz / 36 = 222kHz, 4.5us/bit):
+ *  - Input poll, every frame: START, SLA+W, GPIOA, Sr, SLA+R, data, STOP
+ *    = 4 bytes * 9 bits + 3 conditions ~ 39 bit times ~ 176us, 6 TWI interrupts
+ *  - Lamp update, only on frames where the lamps change: START, SLA+W,
+ *    OLATB, data, STOP ~ 29 bit times ~ 131us, 4 TWI interrupts
+ * So one expander uses ~18% of each 1ms frame for polling, ~31% on frames
+ * with a lamp change. Both supported expanders fit in a frame with room
+ * to spare.
+ *
+ * Latency: the poll starts on SOF and completes ~180us later; the result
+ * is debounced on the next SOF, so expander inputs lag direct pins by one
+ * frame (at most 1ms + ~180us).
+ */
+
+/// Number of expanders on the bus (1 or 2). Expander n's buttons are inputs 8n to 8n+7, ORed with the
+/// other inputs before the remap; with 2, the direct button build counts 16 inputs (see PopnAsc.h).
+#ifndef EXPANDER_COUNT
+#define EXPANDER_COUNT 1
+#endif
+
+/// 7-bit bus address of the first expander (A2..A0 tied low); others follow
+#define EXPANDER_BASE_ADDRESS 0x20
+
+/// TWI bit length, see the budget above
+#define EXPANDER_TWI_BIT_LENGTH 10
+
+void Expanders_Init(void);
+void Expanders_StartOfFrame(void);
+uint16_t Expanders_GetInputs(void);
+void Expanders_SetLamps(uint16_t lamps);
+
+#endif
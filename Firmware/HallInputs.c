@@ -0,0 +1,207 @@
+/*
+  Pop'n Convertible Arcade Style Controller Project
+ 
+  Copyright 2011 Sam Wong (Sam /@/ hellosam /./ net)
+
+  This work is licensed under the Creative Commons Attribution 3.0 
+  Hong Kong License. 
+
+  To view a copy of this license, visit 
+  http://creativecommons.org/licenses/by/3.0/hk/ or send a letter to 
+  Creative Commons, 444 Castro Street, Suite 900, 
+  Mountain View, California, 94041, USA.  
+*/
+
+#include "HallInputs.h"
+
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+#include <LUFA/Drivers/Peripheral/ADC.h>
+
+#if HALL_CHANNEL_COUNT < 2 || HALL_CHANNEL_COUNT > 12
+#error HALL_CHANNEL_COUNT must be 2 to 12.
+#endif
+
+/// ADC clock near 250kHz; 8-bit results stay accurate well above the 200kHz 10-bit limit
+#if F_CPU > 8000000
+#define HALL_ADC_PRESCALE ADC_PRESCALE_64
+#else
+#define HALL_ADC_PRESCALE ADC_PRESCALE_32
+#endif
+
+static const uint8_t channels[HALL_CHANNEL_COUNT] = HALL_CHANNELS;
+
+static HallButton_t buttons[HALL_CHANNEL_COUNT];
+
+/// [Bitmap] Button states (active high), updated per conversion
+static volatile uint16_t state;
+
+/// Button whose conversion completes at the next interrupt
+static uint8_t sampleIndex;
+/// Button last selected on the multiplexer
+static uint8_t muxIndex;
+/// Sweeps left before rest readings are final; 0 when calibrated
+static volatile uint8_t calibrationSweeps;
+/// Set until the first, duplicated conversion has been thrown away
+static bool discardSample;
+
+/** Select a button's channel for the conversion after the running one */
+static inline void SelectChannel(uint8_t index)
+{
+    uint8_t channel = channels[index];
+
+    ADMUX = ADC_REFERENCE_AVCC | ADC_LEFT_ADJUSTED | (channel & 0x07);
+    ADCSRB = (channel & 0x08) ? _BV(MUX5) : 0;
+}
+
+/** Start the free-running sweep and calibrate rest readings */
+void HallInputs_Init(void)
+{
+    uint8_t i;
+
+    for (i = 0; i < HALL_CHANNEL_COUNT; i++)
+    {
+        ADC_SetupChannel(channels[i]);
+        buttons[i].Actuation = HALL_DEFAULT_ACTUATION;
+        buttons[i].Sensitivity = HALL_DEFAULT_SENSITIVITY;
+    }
+    calibrationSweeps = HALL_CALIBRATION_SWEEPS;
+
+    // The first two conversions both use button 0: the second starts as
+    // the first completes, before the interrupt can select button 1
+    sampleIndex = 0;
+    muxIndex = 0;
+    discardSample = true;
+    SelectChannel(0);
+
+    ADC_Init(ADC_FREE_RUNNING | HALL_ADC_PRESCALE);
+    ADCSRA |= _BV(ADIE) | _BV(ADSC);
+}
+
+/** Re-capture rest readings over the next few sweeps */
+void HallInputs_Calibrate(void)
+{
+    uint8_t i;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        for (i = 0; i < HALL_CHANNEL_COUNT; i++)
+        {
+            buttons[i].Travel = 0;
+            buttons[i].Extreme = 0;
+        }
+        state = 0;
+        calibrationSweeps = HALL_CALIBRATION_SWEEPS;
+    }
+}
+
+/** Set a button's actuation depth and rapid trigger sensitivity */
+void HallInputs_SetThresholds(uint8_t button, uint8_t actuation, uint8_t sensitivity)
+{
+    if (button >= HALL_CHANNEL_COUNT || sensitivity == 0)
+      return;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        buttons[button].Actuation = actuation;
+        buttons[button].Sensitivity = sensitivity;
+    }
+}
+
+/** Calibration and thresholds of a button, or NULL if out of range */
+const HallButton_t* HallInputs_GetButton(uint8_t button)
+{
+    if (button >= HALL_CHANNEL_COUNT)
+      return NULL;
+
+    return &buttons[button];
+}
+
+/** [Bitmap] Current button states (active high) */
+uint16_t HallInputs_GetState(void)
+{
+    uint16_t result;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        result = state;
+    }
+
+    return result;
+}
+
+ISR(ADC_vect)
+{
+    uint8_t sample = ADCH;
+    uint8_t index = sampleIndex;
+    HallButton_t* button;
+    uint16_t mask;
+    uint8_t depth;
+
+    // Queue the next channel first, there is a whole conversion to do it in
+    if (++muxIndex == HALL_CHANNEL_COUNT)
+      muxIndex = 0;
+    SelectChannel(muxIndex);
+
+    if (discardSample)
+    {
+        discardSample = false;
+        return;
+    }
+
+    if (++sampleIndex == HALL_CHANNEL_COUNT)
+      sampleIndex = 0;
+
+    button = &buttons[index];
+
+    if (calibrationSweeps)
+    {
+        // First sweep takes the reading as is, later sweeps average into it
+        if (calibrationSweeps == HALL_CALIBRATION_SWEEPS)
+          button->Rest = sample;
+        else
+          button->Rest = ((uint16_t) button->Rest + sample + 1) >> 1;
+
+        if (index == HALL_CHANNEL_COUNT - 1)
+          calibrationSweeps--;
+        return;
+    }
+
+    depth = (sample > button->Rest) ? (sample - button->Rest) : (button->Rest - sample);
+    if (depth > button->Travel)
+      button->Travel = depth;
+
+    mask = (uint16_t) 1 << index;
+    if (state & mask)
+    {
+        // Pressed: follow the bottom, release on the way back up
+        if (depth > button->Extreme)
+        {
+            button->Extreme = depth;
+        }
+        else if ((uint8_t) (button->Extreme - depth) >= button->Sensitivity || depth < button->Actuation)
+        {
+            state &= ~mask;
+            button->Extreme = depth;
+        }
+    } else {
+        // Released: follow the top, press on the way back down
+        if (depth <= button->Extreme)
+        {
+            button->Extreme = depth;
+            button->Motion = 0;
+        }
+        else
+        {
+            if (button->Motion != 0xFF)
+              button->Motion++;
+
+            if ((uint8_t) (depth - button->Extreme) >= button->Sensitivity && depth >= button->Actuation)
+            {
+                state |= mask;
+                button->Extreme = depth;
+                button->PressTime = button->Motion;
+            }
+        }
+    }
+}
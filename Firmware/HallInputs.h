@@ -0,0 +1,92 @@
+/*
+  Pop'n Convertible Arcade Style Controller Project
+ 
+  Copyright 2011 Sam Wong (Sam /@/ hellosam /./ net)
+
+  This work is licensed under the Creative Commons Attribution 3.0 
+  Hong Kong License. 
+
+  To view a copy of this license, visit 
+  http://creativecommons.org/licenses/by/3.0/hk/ or send a letter to 
+  Creative Commons, 444 Castro Street, Suite 900, 
+  Mountain View, California, 94041, USA.  
+*/
+
+#ifndef _HALLINPUTS_H_
+#define _HALLINPUTS_H_
+
+#include <stdint.h>
+
+/** Analog hall-effect buttons, sampled by a free-running ADC sweep.
+ *
+ * The ADC runs in free-running mode with its interrupt enabled; each
+ * interrupt takes the 8-bit (left adjusted) result, runs that button's
+ * rapid trigger step and selects the channel two conversions ahead (the
+ * conversion already in flight latched the previous selection). Nothing
+ * polls or waits on the ADC from the main loop.
+ *
+ * Timing with the ADC clock at 250kHz (F_CPU/64 at 16MHz, F_CPU/32 at
+ * 8MHz): 13 ADC clocks = 52us per conversion, so 9 buttons are swept
+ * every ~470us, about twice per USB frame. Each interrupt is a fixed
+ * ~60 cycles whatever the button state.
+ *
+ * Each button measures "depth" as the distance of its reading from its
+ * rest (released) reading, so magnet polarity does not matter. Rest is
+ * captured over the first HALL_CALIBRATION_SWEEPS sweeps after power-up
+ * or HallInputs_Calibrate(); keep hands off the buttons meanwhile.
+ *
+ * Rapid trigger: a released button presses once it is at least Actuation
+ * deep and has travelled Sensitivity further down than its highest point
+ * since release. A pressed button releases once it has come Sensitivity
+ * back up from its deepest point since press, or rises above Actuation.
+ * The Sensitivity window is the hysteresis, so no time debounce is used.
+ */
+
+/// Number of analog buttons, at most 12 (the ADC inputs of the ATmega32U4)
+#ifndef HALL_CHANNEL_COUNT
+#define HALL_CHANNEL_COUNT 9
+#endif
+
+/// ADC input used by each button, in button order
+#ifndef HALL_CHANNELS
+#define HALL_CHANNELS { 0, 1, 4, 5, 6, 7, 8, 9, 10 }
+#endif
+
+/// Sweeps averaged into the rest reading at calibration
+#define HALL_CALIBRATION_SWEEPS 16
+
+/// Power-up actuation depth, in ADC counts (8-bit) from rest
+#ifndef HALL_DEFAULT_ACTUATION
+#define HALL_DEFAULT_ACTUATION 40
+#endif
+
+/// Power-up rapid trigger sensitivity, in ADC counts; must be at least 1
+#ifndef HALL_DEFAULT_SENSITIVITY
+#define HALL_DEFAULT_SENSITIVITY 8
+#endif
+
+typedef struct
+{
+    /// Reading at rest (released), from calibration
+    uint8_t Rest;
+    /// Deepest travel seen since calibration, for tuning Actuation
+    uint8_t Travel;
+    /// Depth at which the button may first press
+    uint8_t Actuation;
+    /// Travel needed to re-press or release, i.e. the hysteresis
+    uint8_t Sensitivity;
+    /// Highest depth since release, or deepest since press
+    uint8_t Extreme;
+    /// Sweeps since leaving the highest point, while released (saturating)
+    uint8_t Motion;
+    /// Motion at the last press: the stroke time, shorter for harder presses
+    uint8_t PressTime;
+} HallButton_t;
+
+void HallInputs_Init(void);
+void HallInputs_Calibrate(void);
+void HallInputs_SetThresholds(uint8_t button, uint8_t actuation, uint8_t sensitivity);
+const HallButton_t* HallInputs_GetButton(uint8_t button);
+uint16_t HallInputs_GetState(void);
+
+#endif
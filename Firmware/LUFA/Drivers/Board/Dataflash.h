@@ -246,6 +246,8 @@
 				#include "XPLAIN/Dataflash.h"
 			#elif (BOARD == BOARD_EVK527)
 				#include "EVK527/Dataflash.h"
+			#elif (BOARD == BOARD_OLIMEX162)
+				#include "OLIMEX162/Dataflash.h"
 			#else
 				#include "Board/Dataflash.h"
 			#endif
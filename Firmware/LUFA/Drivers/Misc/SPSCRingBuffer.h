@@ -0,0 +1,355 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2011.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2011  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaim all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *  \brief Lock-free single producer, single consumer byte ring buffer.
+ *
+ *  Lock-free ring buffer with a power-of-two capacity, for passing bytes between exactly one producer
+ *  and exactly one consumer (typically an ISR and the main program loop) without disabling interrupts.
+ */
+
+/** \ingroup Group_MiscDrivers
+ *  \defgroup Group_SPSCRingBuff Lock-Free SPSC Byte Ring Buffer - LUFA/Drivers/Misc/SPSCRingBuffer.h
+ *  \brief Lock-free single producer, single consumer byte ring buffer.
+ *
+ *  \section Sec_Dependencies Module Source Dependencies
+ *  The following files must be built with any user project that uses this module:
+ *    - None
+ *
+ *  \section Sec_ModDescription Module Description
+ *  Alternative to the \ref Group_RingBuff driver for the common case of one producer and one consumer
+ *  running in different execution threads. Rather than keeping a shared count that must be updated under
+ *  a global interrupt lock, the buffer keeps two free-running 8-bit indexes: \c In is only ever written by
+ *  the producer, and \c Out is only ever written by the consumer. As single byte loads and stores are
+ *  atomic on the AVR8 architecture, each side can always read the other's index safely, and the stored
+ *  count is simply the (wrapping) difference between the two.
+ *
+ *  The buffer capacity must be a power of two between 2 and 128 bytes inclusive, so that wrapping an index
+ *  into the storage array is a single AND with a mask rather than a compare-and-reset. The capacity is
+ *  checked at compile time when the buffer is created with \ref SPSC_RINGBUFFER_INITIALIZER() or
+ *  \ref SPSCRingBuffer_InitBuffer().
+ *
+ *  In addition to the single byte insertion and removal routines, the producer may request the largest
+ *  contiguous run of free storage with \ref SPSCRingBuffer_GetWriteSpan() and publish it in one step with
+ *  \ref SPSCRingBuffer_CommitWrite(); likewise the consumer may request the largest contiguous run of stored
+ *  data with \ref SPSCRingBuffer_GetReadSpan() and release it with \ref SPSCRingBuffer_CommitRead(). This
+ *  allows whole runs to be copied to or from an endpoint with the endpoint stream functions.
+ *
+ *  \note Only one execution thread may insert into (or commit writes to) a given buffer, and only one
+ *        execution thread may remove from (or commit reads from) it. If more than one producer or consumer
+ *        is required, use the \ref Group_RingBuff driver with atomic locking instead.
+ *
+ *  \section Sec_ExampleUsage Example Usage
+ *  The following snippet is an example of how this module may be used within a typical
+ *  application.
+ *
+ *  \code
+ *      // Create the underlying storage array and the buffer structure
+ *      static uint8_t          BufferData[64];
+ *      static SPSCRingBuffer_t Buffer = SPSC_RINGBUFFER_INITIALIZER(BufferData);
+ *
+ *      // Producer (e.g. a USART receive ISR): drop the byte if the buffer is full
+ *      if (!(SPSCRingBuffer_IsFull(&Buffer)))
+ *        SPSCRingBuffer_Insert(&Buffer, UDR1);
+ *
+ *      // Consumer (e.g. the main loop): copy out whole contiguous runs at a time
+ *      uint8_t* Span;
+ *      uint8_t  SpanLength;
+ *
+ *      while ((SpanLength = SPSCRingBuffer_GetReadSpan(&Buffer, &Span)) != 0)
+ *      {
+ *          Endpoint_Write_Stream_LE(Span, SpanLength, NULL);
+ *          SPSCRingBuffer_CommitRead(&Buffer, SpanLength);
+ *      }
+ *  \endcode
+ *
+ *  @{
+ */
+
+#ifndef __SPSC_RING_BUFFER_H__
+#define __SPSC_RING_BUFFER_H__
+
+	/* Includes: */
+		#include "../../Common/Common.h"
+
+	/* Public Interface - May be used in end-application: */
+		/* Macros: */
+			/** Largest storage array size supported by a single \ref SPSCRingBuffer_t. The 8-bit index difference
+			 *  must be able to represent a completely full buffer, limiting the capacity to half the index range.
+			 */
+			#define SPSC_RINGBUFFER_MAX_SIZE            128
+
+			/** Evaluates to the given storage size if it is a power of two between 2 and \ref SPSC_RINGBUFFER_MAX_SIZE
+			 *  bytes inclusive, otherwise generates a compile time error. The result is an integer constant expression,
+			 *  and so may be used in static initializers.
+			 *
+			 *  \param[in] Size  Storage array size to check, in bytes.
+			 */
+			#define SPSC_RINGBUFFER_CHECK_SIZE(Size)    ((Size) + (0 * sizeof(char[((((Size) & ((Size) - 1)) == 0) && \
+			                                              ((Size) >= 2) && ((Size) <= SPSC_RINGBUFFER_MAX_SIZE)) ? 1 : -1])))
+
+			/** Static initializer for a \ref SPSCRingBuffer_t structure, binding it to the given storage array. The
+			 *  size of the array is taken from its type and checked at compile time.
+			 *
+			 *  \param[in] Storage  Global array of \c uint8_t elements used to hold the buffered data.
+			 */
+			#define SPSC_RINGBUFFER_INITIALIZER(Storage) { .Data = (Storage),                                        \
+			                                               .Mask = (SPSC_RINGBUFFER_CHECK_SIZE(sizeof(Storage)) - 1), \
+			                                               .In   = 0,                                                \
+			                                               .Out  = 0 }
+
+			/** Initializes a ring buffer ready for use at runtime, binding it to the given storage array. The array
+			 *  size must be a compile time constant, and is checked in the same manner as \ref SPSC_RINGBUFFER_INITIALIZER().
+			 *
+			 *  \note This must not be called while either the producer or consumer may be accessing the buffer.
+			 *
+			 *  \param[out] Buffer   Pointer to a ring buffer structure to initialize.
+			 *  \param[out] DataPtr  Pointer to a global array that will hold the data stored into the ring buffer.
+			 *  \param[in]  Size     Size of the storage array in bytes, a constant power of two.
+			 */
+			#define SPSCRingBuffer_InitBuffer(Buffer, DataPtr, Size) \
+			        SPSCRingBuffer_InitBufferMask((Buffer), (DataPtr), (SPSC_RINGBUFFER_CHECK_SIZE(Size) - 1))
+
+		/* Type Defines: */
+			/** \brief Lock-Free Ring Buffer Management Structure.
+			 *
+			 *  Type define for a new lock-free ring buffer object. Buffers should be initialized via
+			 *  \ref SPSC_RINGBUFFER_INITIALIZER() or \ref SPSCRingBuffer_InitBuffer() before use.
+			 */
+			typedef struct
+			{
+				uint8_t*         Data; /**< Pointer to the start of the buffer's underlying storage array. */
+				uint8_t          Mask; /**< Storage array size minus one, used to wrap the free-running indexes. */
+				volatile uint8_t In; /**< Free-running storage index, only written by the producer. */
+				volatile uint8_t Out; /**< Free-running retrieval index, only written by the consumer. */
+			} SPSCRingBuffer_t;
+
+		/* Inline Functions: */
+			/** Binds a ring buffer to a storage array with a precomputed index mask. This should not normally be
+			 *  called directly; use \ref SPSCRingBuffer_InitBuffer() instead so that the size is validated.
+			 *
+			 *  \param[out] Buffer   Pointer to a ring buffer structure to initialize.
+			 *  \param[out] DataPtr  Pointer to a global array that will hold the data stored into the ring buffer.
+			 *  \param[in]  Mask     Storage array size minus one.
+			 */
+			static inline void SPSCRingBuffer_InitBufferMask(SPSCRingBuffer_t* Buffer,
+			                                                 uint8_t* const DataPtr,
+			                                                 const uint8_t Mask)
+			{
+				GCC_FORCE_POINTER_ACCESS(Buffer);
+
+				Buffer->Data = DataPtr;
+				Buffer->Mask = Mask;
+				Buffer->In   = 0;
+				Buffer->Out  = 0;
+			}
+
+			/** Retrieves the minimum number of bytes stored in a particular buffer. No locking is required; the
+			 *  producer can only increase the returned value and the consumer can only decrease it, so the
+			 *  value is exact when called from the consumer thread and a lower bound of the free space when
+			 *  called from the producer thread.
+			 *
+			 *  \param[in] Buffer  Pointer to a ring buffer structure whose count is to be computed.
+			 *
+			 *  \return Number of bytes currently stored in the buffer.
+			 */
+			static inline uint8_t SPSCRingBuffer_GetCount(SPSCRingBuffer_t* const Buffer)
+			{
+				return (uint8_t)(Buffer->In - Buffer->Out);
+			}
+
+			/** Retrieves the minimum number of free bytes in a particular buffer. This is exact when called
+			 *  from the producer thread.
+			 *
+			 *  \param[in] Buffer  Pointer to a ring buffer structure whose free space is to be computed.
+			 *
+			 *  \return Number of bytes which may currently be inserted into the buffer.
+			 */
+			static inline uint8_t SPSCRingBuffer_GetFreeCount(SPSCRingBuffer_t* const Buffer)
+			{
+				return (uint8_t)((Buffer->Mask + 1) - SPSCRingBuffer_GetCount(Buffer));
+			}
+
+			/** Determines if the specified ring buffer contains any free space. This should be tested by the
+			 *  producer before storing data to the buffer, to ensure that no data is lost due to a buffer overrun.
+			 *
+			 *  \param[in] Buffer  Pointer to a ring buffer structure to test.
+			 *
+			 *  \return Boolean \c true if the buffer contains no free space, \c false otherwise.
+			 */
+			static inline bool SPSCRingBuffer_IsFull(SPSCRingBuffer_t* const Buffer)
+			{
+				return (SPSCRingBuffer_GetCount(Buffer) > Buffer->Mask);
+			}
+
+			/** Determines if the specified ring buffer contains any data. This should be tested by the
+			 *  consumer before removing data from the buffer, to ensure that the buffer does not underflow.
+			 *
+			 *  \param[in] Buffer  Pointer to a ring buffer structure to test.
+			 *
+			 *  \return Boolean \c true if the buffer contains no data, \c false otherwise.
+			 */
+			static inline bool SPSCRingBuffer_IsEmpty(SPSCRingBuffer_t* const Buffer)
+			{
+				return (Buffer->In == Buffer->Out);
+			}
+
+			/** Inserts an element into the ring buffer. The caller must ensure the buffer is not full beforehand.
+			 *
+			 *  \note Only the producer thread may call this function.
+			 *
+			 *  \param[in,out] Buffer  Pointer to a ring buffer structure to insert into.
+			 *  \param[in]     Data    Data element to insert into the buffer.
+			 */
+			static inline void SPSCRingBuffer_Insert(SPSCRingBuffer_t* Buffer,
+			                                         const uint8_t Data)
+			{
+				GCC_FORCE_POINTER_ACCESS(Buffer);
+
+				uint8_t In = Buffer->In;
+
+				Buffer->Data[In & Buffer->Mask] = Data;
+
+				GCC_MEMORY_BARRIER();
+				Buffer->In = (uint8_t)(In + 1);
+			}
+
+			/** Removes an element from the ring buffer. The caller must ensure the buffer is not empty beforehand.
+			 *
+			 *  \note Only the consumer thread may call this function.
+			 *
+			 *  \param[in,out] Buffer  Pointer to a ring buffer structure to retrieve from.
+			 *
+			 *  \return Next data element stored in the buffer.
+			 */
+			static inline uint8_t SPSCRingBuffer_Remove(SPSCRingBuffer_t* Buffer)
+			{
+				GCC_FORCE_POINTER_ACCESS(Buffer);
+
+				uint8_t Out  = Buffer->Out;
+				uint8_t Data = Buffer->Data[Out & Buffer->Mask];
+
+				GCC_MEMORY_BARRIER();
+				Buffer->Out = (uint8_t)(Out + 1);
+
+				return Data;
+			}
+
+			/** Returns the next element stored in the ring buffer, without removing it.
+			 *
+			 *  \note Only the consumer thread may call this function.
+			 *
+			 *  \param[in] Buffer  Pointer to a ring buffer structure to retrieve from.
+			 *
+			 *  \return Next data element stored in the buffer.
+			 */
+			static inline uint8_t SPSCRingBuffer_Peek(SPSCRingBuffer_t* const Buffer)
+			{
+				return Buffer->Data[Buffer->Out & Buffer->Mask];
+			}
+
+			/** Retrieves the largest contiguous run of free storage in the buffer, which the producer may fill
+			 *  directly before publishing it with \ref SPSCRingBuffer_CommitWrite(). A run never crosses the end
+			 *  of the storage array, so a second call after committing may return the remainder.
+			 *
+			 *  \note Only the producer thread may call this function.
+			 *
+			 *  \param[in]  Buffer  Pointer to a ring buffer structure to insert into.
+			 *  \param[out] Span    Location where the start of the free run is to be stored.
+			 *
+			 *  \return Number of bytes which may be written to the returned run, which may be zero.
+			 */
+			static inline uint8_t SPSCRingBuffer_GetWriteSpan(SPSCRingBuffer_t* const Buffer,
+			                                                  uint8_t** const Span)
+			{
+				uint8_t Index    = (Buffer->In & Buffer->Mask);
+				uint8_t ToEnd    = (uint8_t)((Buffer->Mask + 1) - Index);
+				uint8_t Free     = SPSCRingBuffer_GetFreeCount(Buffer);
+
+				*Span = &Buffer->Data[Index];
+				return MIN(Free, ToEnd);
+			}
+
+			/** Publishes bytes written into a run returned by \ref SPSCRingBuffer_GetWriteSpan() to the consumer.
+			 *
+			 *  \note Only the producer thread may call this function.
+			 *
+			 *  \param[in,out] Buffer  Pointer to a ring buffer structure to insert into.
+			 *  \param[in]     Length  Number of bytes written, no larger than the length of the returned run.
+			 */
+			static inline void SPSCRingBuffer_CommitWrite(SPSCRingBuffer_t* const Buffer,
+			                                              const uint8_t Length)
+			{
+				GCC_MEMORY_BARRIER();
+				Buffer->In = (uint8_t)(Buffer->In + Length);
+			}
+
+			/** Retrieves the largest contiguous run of stored data in the buffer, which the consumer may read
+			 *  directly before releasing it with \ref SPSCRingBuffer_CommitRead(). A run never crosses the end
+			 *  of the storage array, so a second call after committing may return the remainder.
+			 *
+			 *  \note Only the consumer thread may call this function.
+			 *
+			 *  \param[in]  Buffer  Pointer to a ring buffer structure to retrieve from.
+			 *  \param[out] Span    Location where the start of the stored run is to be stored.
+			 *
+			 *  \return Number of bytes which may be read from the returned run, which may be zero.
+			 */
+			static inline uint8_t SPSCRingBuffer_GetReadSpan(SPSCRingBuffer_t* const Buffer,
+			                                                 uint8_t** const Span)
+			{
+				uint8_t Index    = (Buffer->Out & Buffer->Mask);
+				uint8_t ToEnd    = (uint8_t)((Buffer->Mask + 1) - Index);
+				uint8_t Count    = SPSCRingBuffer_GetCount(Buffer);
+
+				*Span = &Buffer->Data[Index];
+				GCC_MEMORY_BARRIER();
+
+				return MIN(Count, ToEnd);
+			}
+
+			/** Releases bytes read from a run returned by \ref SPSCRingBuffer_GetReadSpan() back to the producer.
+			 *
+			 *  \note Only the consumer thread may call this function.
+			 *
+			 *  \param[in,out] Buffer  Pointer to a ring buffer structure to retrieve from.
+			 *  \param[in]     Length  Number of bytes read, no larger than the length of the returned run.
+			 */
+			static inline void SPSCRingBuffer_CommitRead(SPSCRingBuffer_t* const Buffer,
+			                                             const uint8_t Length)
+			{
+				GCC_MEMORY_BARRIER();
+				Buffer->Out = (uint8_t)(Buffer->Out + Length);
+			}
+
+#endif
+
+/** @} */
+
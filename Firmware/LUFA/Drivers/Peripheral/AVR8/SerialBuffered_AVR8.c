@@ -0,0 +1,177 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2011.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2011  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaim all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+
+#define  __INCLUDE_FROM_SERIAL_BUFFERED_C
+#include "../SerialBuffered.h"
+
+static uint8_t          SerialBuffered_TxData[SERIAL_BUFFERED_TX_SIZE];
+static uint8_t          SerialBuffered_RxData[SERIAL_BUFFERED_RX_SIZE];
+static SPSCRingBuffer_t SerialBuffered_TxBuffer = SPSC_RINGBUFFER_INITIALIZER(SerialBuffered_TxData);
+static SPSCRingBuffer_t SerialBuffered_RxBuffer = SPSC_RINGBUFFER_INITIALIZER(SerialBuffered_RxData);
+
+static SerialBuffered_Counters_t SerialBuffered_Counters;
+
+static inline void SerialBuffered_AddSaturating(uint16_t* const Counter,
+                                                const uint8_t Amount)
+{
+	uint16_t NewValue = (*Counter + Amount);
+
+	*Counter = (NewValue < *Counter) ? UINT16_MAX : NewValue;
+}
+
+void SerialBuffered_Init(const uint32_t BaudRate,
+                         const bool DoubleSpeed)
+{
+	UCSR1B = 0;
+
+	SPSCRingBuffer_InitBuffer(&SerialBuffered_TxBuffer, SerialBuffered_TxData, SERIAL_BUFFERED_TX_SIZE);
+	SPSCRingBuffer_InitBuffer(&SerialBuffered_RxBuffer, SerialBuffered_RxData, SERIAL_BUFFERED_RX_SIZE);
+	memset(&SerialBuffered_Counters, 0, sizeof(SerialBuffered_Counters));
+
+	UBRR1  = (DoubleSpeed ? SERIAL_BUFFERED_2X_UBBRVAL(BaudRate) : SERIAL_BUFFERED_UBBRVAL(BaudRate));
+	UCSR1C = ((1 << UCSZ11) | (1 << UCSZ10));
+	UCSR1A = (DoubleSpeed ? (1 << U2X1) : 0);
+	UCSR1B = ((1 << TXEN1) | (1 << RXEN1) | (1 << RXCIE1));
+
+	DDRD  |= (1 << 3);
+	PORTD |= (1 << 2);
+}
+
+void SerialBuffered_Disable(void)
+{
+	UCSR1B = 0;
+	UCSR1A = 0;
+	UCSR1C = 0;
+	UBRR1  = 0;
+
+	DDRD  &= ~(1 << 3);
+	PORTD &= ~(1 << 2);
+}
+
+bool SerialBuffered_SendData(const void* Buffer,
+                             const uint8_t Length)
+{
+	const uint8_t* DataIn = (const uint8_t*)Buffer;
+	uint8_t        Remaining = Length;
+
+	if (SPSCRingBuffer_GetFreeCount(&SerialBuffered_TxBuffer) < Length)
+	{
+		SerialBuffered_AddSaturating(&SerialBuffered_Counters.TxDropped, Length);
+		return false;
+	}
+
+	/* At most two runs are needed, one up to the end of the buffer storage and one from its start */
+	while (Remaining)
+	{
+		uint8_t* Span;
+		uint8_t  SpanLength = SPSCRingBuffer_GetWriteSpan(&SerialBuffered_TxBuffer, &Span);
+
+		if (SpanLength > Remaining)
+		  SpanLength = Remaining;
+
+		memcpy(Span, DataIn, SpanLength);
+		SPSCRingBuffer_CommitWrite(&SerialBuffered_TxBuffer, SpanLength);
+
+		DataIn    += SpanLength;
+		Remaining -= SpanLength;
+	}
+
+	UCSR1B |= (1 << UDRIE1);
+	return true;
+}
+
+bool SerialBuffered_SendByte(const uint8_t DataByte)
+{
+	if (SPSCRingBuffer_IsFull(&SerialBuffered_TxBuffer))
+	{
+		SerialBuffered_AddSaturating(&SerialBuffered_Counters.TxDropped, 1);
+		return false;
+	}
+
+	SPSCRingBuffer_Insert(&SerialBuffered_TxBuffer, DataByte);
+
+	UCSR1B |= (1 << UDRIE1);
+	return true;
+}
+
+int16_t SerialBuffered_ReceiveByte(void)
+{
+	if (SPSCRingBuffer_IsEmpty(&SerialBuffered_RxBuffer))
+	  return -1;
+
+	return SPSCRingBuffer_Remove(&SerialBuffered_RxBuffer);
+}
+
+uint8_t SerialBuffered_GetReceivedCount(void)
+{
+	return SPSCRingBuffer_GetCount(&SerialBuffered_RxBuffer);
+}
+
+uint8_t SerialBuffered_GetPendingCount(void)
+{
+	return SPSCRingBuffer_GetCount(&SerialBuffered_TxBuffer);
+}
+
+void SerialBuffered_GetCounters(SerialBuffered_Counters_t* const Counters)
+{
+	uint_reg_t CurrentGlobalInt = GetGlobalInterruptMask();
+	GlobalInterruptDisable();
+
+	*Counters = SerialBuffered_Counters;
+
+	SetGlobalInterruptMask(CurrentGlobalInt);
+}
+
+ISR(USART1_UDRE_vect, ISR_BLOCK)
+{
+	/* The sender may re-enable the interrupt just after the last byte was loaded, so the buffer can be empty here */
+	if (!(SPSCRingBuffer_IsEmpty(&SerialBuffered_TxBuffer)))
+	  UDR1 = SPSCRingBuffer_Remove(&SerialBuffered_TxBuffer);
+
+	/* Stop the interrupt once the last byte has been loaded; the next queued byte will re-enable it */
+	if (SPSCRingBuffer_IsEmpty(&SerialBuffered_TxBuffer))
+	  UCSR1B &= ~(1 << UDRIE1);
+}
+
+ISR(USART1_RX_vect, ISR_BLOCK)
+{
+	uint8_t Status   = UCSR1A;
+	uint8_t DataByte = UDR1;
+
+	if (Status & (1 << DOR1))
+	  SerialBuffered_AddSaturating(&SerialBuffered_Counters.RxOverruns, 1);
+
+	if (SPSCRingBuffer_IsFull(&SerialBuffered_RxBuffer))
+	  SerialBuffered_AddSaturating(&SerialBuffered_Counters.RxDropped, 1);
+	else
+	  SPSCRingBuffer_Insert(&SerialBuffered_RxBuffer, DataByte);
+}
+
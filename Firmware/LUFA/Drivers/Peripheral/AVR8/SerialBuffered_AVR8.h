@@ -0,0 +1,200 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2011.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2011  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaim all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+
+/** \file
+ *  \brief Interrupt driven, buffered Serial USART Peripheral Driver (AVR8)
+ *
+ *  Interrupt driven, buffered serial USART driver for the 8-bit AVR microcontrollers.
+ *
+ *  \note This file should not be included directly. It is automatically included as needed by the buffered
+ *        USART driver dispatch header located in LUFA/Drivers/Peripheral/SerialBuffered.h.
+ */
+
+/** \ingroup Group_SerialBuffered
+ *  \defgroup Group_SerialBuffered_AVR8 Buffered Serial USART Peripheral Driver (AVR8)
+ *
+ *  \section Sec_ModDescription Module Description
+ *  Interrupt driven, buffered serial USART driver for the 8-bit AVR microcontrollers.
+ *
+ *  Data to transmit is placed into a transmit ring buffer, which is drained by the USART Data Register Empty
+ *  interrupt; received bytes are placed into a receive ring buffer by the USART Receive Complete interrupt.
+ *  Both buffers are \ref Group_SPSCRingBuff lock-free ring buffers, so neither side ever disables interrupts.
+ *  The buffer sizes may be overridden by defining \c SERIAL_BUFFERED_TX_SIZE and \c SERIAL_BUFFERED_RX_SIZE in
+ *  the project makefile, and must be powers of two no larger than 128 bytes.
+ *
+ *  \ref SerialBuffered_SendData() is all-or-nothing: if the whole block does not fit into the transmit buffer
+ *  nothing is sent, so that framed data is never truncated mid-frame. Dropped transmit data, dropped receive
+ *  data and hardware receive overruns are each counted.
+ *
+ *  \note Only one execution thread may send data, and only one execution thread may receive data.
+ *
+ *  \note This file should not be included directly. It is automatically included as needed by the buffered
+ *        USART driver dispatch header located in LUFA/Drivers/Peripheral/SerialBuffered.h.
+ *
+ *  \section Sec_ExampleUsage Example Usage
+ *  The following snippet is an example of how this module may be used within a typical
+ *  application.
+ *
+ *  \code
+ *      // Initialise the buffered serial USART driver before first use, with 1M baud (double-speed mode)
+ *      SerialBuffered_Init(1000000, true);
+ *
+ *      // Queue a block for transmission, without waiting for the USART
+ *      if (!(SerialBuffered_SendData(Frame, sizeof(Frame))))
+ *        FramesNotSent++;
+ *
+ *      // Receive a byte through the USART, if one is available
+ *      int16_t DataByte = SerialBuffered_ReceiveByte();
+ *  \endcode
+ *
+ *  @{
+ */
+
+#ifndef __SERIAL_BUFFERED_AVR8_H__
+#define __SERIAL_BUFFERED_AVR8_H__
+
+	/* Includes: */
+		#include "../../../Common/Common.h"
+		#include "../../Misc/SPSCRingBuffer.h"
+
+	/* Enable C linkage for C++ Compilers: */
+		#if defined(__cplusplus)
+			extern "C" {
+		#endif
+
+	/* Preprocessor Checks: */
+		#if !defined(__INCLUDE_FROM_SERIAL_BUFFERED_H) && !defined(__INCLUDE_FROM_SERIAL_BUFFERED_C)
+			#error Do not include this file directly. Include LUFA/Drivers/Peripheral/SerialBuffered.h instead.
+		#endif
+
+	/* Public Interface - May be used in end-application: */
+		/* Macros: */
+			#if !defined(SERIAL_BUFFERED_TX_SIZE) || defined(__DOXYGEN__)
+				/** Size of the transmit ring buffer in bytes, a power of two no larger than 128. */
+				#define SERIAL_BUFFERED_TX_SIZE    64
+			#endif
+
+			#if !defined(SERIAL_BUFFERED_RX_SIZE) || defined(__DOXYGEN__)
+				/** Size of the receive ring buffer in bytes, a power of two no larger than 128. */
+				#define SERIAL_BUFFERED_RX_SIZE    16
+			#endif
+
+			/** Macro for calculating the baud value from a given baud rate when the U2X (double speed) bit is
+			 *  not set.
+			 */
+			#define SERIAL_BUFFERED_UBBRVAL(baud)    ((((F_CPU / 16) + (baud / 2)) / (baud)) - 1)
+
+			/** Macro for calculating the baud value from a given baud rate when the U2X (double speed) bit is
+			 *  set.
+			 */
+			#define SERIAL_BUFFERED_2X_UBBRVAL(baud) ((((F_CPU / 8) + (baud / 2)) / (baud)) - 1)
+
+		/* Type Defines: */
+			/** \brief Buffered USART Error Counters.
+			 *
+			 *  Snapshot of the buffered USART error counters, as returned by \ref SerialBuffered_GetCounters().
+			 *  Each counter saturates at its maximum value.
+			 */
+			typedef struct
+			{
+				uint16_t TxDropped; /**< Number of bytes not sent because the transmit buffer was full. */
+				uint16_t RxDropped; /**< Number of bytes discarded because the receive buffer was full. */
+				uint16_t RxOverruns; /**< Number of hardware data overruns reported by the USART. */
+			} SerialBuffered_Counters_t;
+
+		/* Function Prototypes: */
+			/** Initializes the USART and its buffers, ready for interrupt driven transmission and reception. This
+			 *  initializes the interface to standard 8-bit, no parity, 1 stop bit settings. Global interrupts must
+			 *  be enabled for data to be transferred.
+			 *
+			 *  \param[in] BaudRate     Serial baud rate, in bits per second.
+			 *  \param[in] DoubleSpeed  Enables double speed mode when set, halving the sample time to double the baud rate.
+			 */
+			void SerialBuffered_Init(const uint32_t BaudRate,
+			                         const bool DoubleSpeed);
+
+			/** Turns off the USART driver, discarding any buffered data and returning used hardware to its default
+			 *  configuration.
+			 */
+			void SerialBuffered_Disable(void);
+
+			/** Queues a block of data for transmission. If there is not enough free space in the transmit buffer
+			 *  for the entire block, none of it is queued and the transmit drop counter is incremented by its length.
+			 *
+			 *  \param[in] Buffer  Pointer to a buffer containing the data to send.
+			 *  \param[in] Length  Length of the data to send, in bytes.
+			 *
+			 *  \return Boolean \c true if the data was queued, \c false if it was dropped.
+			 */
+			bool SerialBuffered_SendData(const void* Buffer,
+			                             const uint8_t Length) ATTR_NON_NULL_PTR_ARG(1);
+
+			/** Queues a single byte for transmission, dropping and counting it if the transmit buffer is full.
+			 *
+			 *  \param[in] DataByte  Byte to transmit through the USART.
+			 *
+			 *  \return Boolean \c true if the byte was queued, \c false if it was dropped.
+			 */
+			bool SerialBuffered_SendByte(const uint8_t DataByte);
+
+			/** Receives the next buffered byte from the USART.
+			 *
+			 *  \return Next byte received from the USART, or a negative value if no byte has been received.
+			 */
+			int16_t SerialBuffered_ReceiveByte(void) ATTR_WARN_UNUSED_RESULT;
+
+			/** Retrieves the number of bytes waiting in the receive buffer.
+			 *
+			 *  \return Number of received bytes which may be retrieved with \ref SerialBuffered_ReceiveByte().
+			 */
+			uint8_t SerialBuffered_GetReceivedCount(void) ATTR_WARN_UNUSED_RESULT;
+
+			/** Retrieves the number of bytes still waiting in the transmit buffer.
+			 *
+			 *  \return Number of queued bytes which have not yet been loaded into the USART.
+			 */
+			uint8_t SerialBuffered_GetPendingCount(void) ATTR_WARN_UNUSED_RESULT;
+
+			/** Retrieves a consistent snapshot of the driver's error counters.
+			 *
+			 *  \param[out] Counters  Location where the counter values are to be stored.
+			 */
+			void SerialBuffered_GetCounters(SerialBuffered_Counters_t* const Counters) ATTR_NON_NULL_PTR_ARG(1);
+
+	/* Disable C linkage for C++ Compilers: */
+		#if defined(__cplusplus)
+			}
+		#endif
+
+#endif
+
+/** @} */
+
@@ -0,0 +1,225 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2011.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2011  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaim all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+
+#define  __INCLUDE_FROM_TWI_ASYNC_C
+#include "../TWIAsync.h"
+
+static TWIAsync_Transaction_t* TWIAsync_QueueHead;
+static TWIAsync_Transaction_t* TWIAsync_QueueTail;
+
+static uint8_t TWIAsync_ByteIndex;
+static bool    TWIAsync_Reading;
+static bool    TWIAsync_InCallback;
+
+#define TWI_ASYNC_TWCR_BASE    ((1 << TWINT) | (1 << TWEN) | (1 << TWIE))
+
+void TWIAsync_Init(const uint8_t Prescale,
+                   const uint8_t BitLength)
+{
+	TWIAsync_QueueHead = NULL;
+	TWIAsync_QueueTail = NULL;
+
+	TWCR = (1 << TWEN);
+	TWSR = Prescale;
+	TWBR = BitLength;
+}
+
+static inline void TWIAsync_StartCurrent(void)
+{
+	TWIAsync_Transaction_t* Current = TWIAsync_QueueHead;
+
+	Current->Status    = TWI_ASYNC_STATUS_InProgress;
+	TWIAsync_ByteIndex = 0;
+	TWIAsync_Reading   = (Current->WriteLength == 0);
+}
+
+bool TWIAsync_Submit(TWIAsync_Transaction_t* const Transaction)
+{
+	bool Queued = false;
+
+	uint_reg_t CurrentGlobalInt = GetGlobalInterruptMask();
+	GlobalInterruptDisable();
+
+	if (!(TWIAsync_IsPending(Transaction)))
+	{
+		Transaction->Status = TWI_ASYNC_STATUS_Queued;
+		Transaction->Next   = NULL;
+
+		if (TWIAsync_QueueHead == NULL)
+		{
+			TWIAsync_QueueHead = Transaction;
+			TWIAsync_QueueTail = Transaction;
+
+			/* When called from a completion callback, the bus is restarted once the callback returns */
+			if (!(TWIAsync_InCallback))
+			{
+				TWIAsync_StartCurrent();
+				TWCR = (TWI_ASYNC_TWCR_BASE | (1 << TWSTA));
+			}
+		}
+		else
+		{
+			TWIAsync_QueueTail->Next = Transaction;
+			TWIAsync_QueueTail       = Transaction;
+		}
+
+		Queued = true;
+	}
+
+	SetGlobalInterruptMask(CurrentGlobalInt);
+
+	return Queued;
+}
+
+bool TWIAsync_IsIdle(void)
+{
+	return (TWIAsync_QueueHead == NULL);
+}
+
+void TWIAsync_Reset(void)
+{
+	uint_reg_t CurrentGlobalInt = GetGlobalInterruptMask();
+	GlobalInterruptDisable();
+
+	TWCR = 0;
+
+	while (TWIAsync_QueueHead != NULL)
+	{
+		TWIAsync_QueueHead->Status = TWI_ASYNC_STATUS_BusFault;
+		TWIAsync_QueueHead         = TWIAsync_QueueHead->Next;
+	}
+
+	TWIAsync_QueueTail = NULL;
+	TWCR = (1 << TWEN);
+
+	SetGlobalInterruptMask(CurrentGlobalInt);
+}
+
+static void TWIAsync_Finish(const uint8_t Status)
+{
+	TWIAsync_Transaction_t* Finished = TWIAsync_QueueHead;
+
+	TWIAsync_QueueHead = Finished->Next;
+
+	if (TWIAsync_QueueHead == NULL)
+	  TWIAsync_QueueTail = NULL;
+
+	Finished->Status = Status;
+
+	if (Finished->Callback != NULL)
+	{
+		TWIAsync_InCallback = true;
+		Finished->Callback(Finished);
+		TWIAsync_InCallback = false;
+	}
+
+	if (TWIAsync_QueueHead != NULL)
+	{
+		/* Issue the STOP immediately followed by a START for the next transaction */
+		TWIAsync_StartCurrent();
+		TWCR = (TWI_ASYNC_TWCR_BASE | (1 << TWSTO) | (1 << TWSTA));
+	}
+	else
+	{
+		TWCR = ((1 << TWINT) | (1 << TWEN) | (1 << TWSTO));
+	}
+}
+
+ISR(TWI_vect, ISR_BLOCK)
+{
+	TWIAsync_Transaction_t* Current = TWIAsync_QueueHead;
+
+	if (Current == NULL)
+	{
+		TWCR = ((1 << TWINT) | (1 << TWEN));
+		return;
+	}
+
+	switch (TWSR & TW_STATUS_MASK)
+	{
+		case TW_START:
+		case TW_REP_START:
+			TWDR = (Current->SlaveAddress | (TWIAsync_Reading ? TW_READ : TW_WRITE));
+			TWCR = TWI_ASYNC_TWCR_BASE;
+			break;
+		case TW_MT_SLA_ACK:
+		case TW_MT_DATA_ACK:
+			if (TWIAsync_ByteIndex < Current->WriteLength)
+			{
+				TWDR = Current->WriteBuffer[TWIAsync_ByteIndex++];
+				TWCR = TWI_ASYNC_TWCR_BASE;
+			}
+			else if (Current->ReadLength)
+			{
+				TWIAsync_ByteIndex = 0;
+				TWIAsync_Reading   = true;
+				TWCR = (TWI_ASYNC_TWCR_BASE | (1 << TWSTA));
+			}
+			else
+			{
+				TWIAsync_Finish(TWI_ASYNC_STATUS_Complete);
+			}
+
+			break;
+		case TW_MR_SLA_ACK:
+			if (Current->ReadLength == 0)
+			{
+				TWIAsync_Finish(TWI_ASYNC_STATUS_Complete);
+				break;
+			}
+
+			/* ACK every received byte except the last, which must be NAKed to end the read */
+			TWCR = (TWI_ASYNC_TWCR_BASE | ((Current->ReadLength > 1) ? (1 << TWEA) : 0));
+			break;
+		case TW_MR_DATA_ACK:
+			Current->ReadBuffer[TWIAsync_ByteIndex++] = TWDR;
+			TWCR = (TWI_ASYNC_TWCR_BASE | (((Current->ReadLength - TWIAsync_ByteIndex) > 1) ? (1 << TWEA) : 0));
+			break;
+		case TW_MR_DATA_NACK:
+			Current->ReadBuffer[TWIAsync_ByteIndex++] = TWDR;
+			TWIAsync_Finish(TWI_ASYNC_STATUS_Complete);
+			break;
+		case TW_MT_ARB_LOST:
+			/* Another master won the bus; retry the whole transaction once it is free */
+			TWIAsync_StartCurrent();
+			TWCR = (TWI_ASYNC_TWCR_BASE | (1 << TWSTA));
+			break;
+		case TW_MT_SLA_NACK:
+		case TW_MT_DATA_NACK:
+		case TW_MR_SLA_NACK:
+			TWIAsync_Finish(TWI_ASYNC_STATUS_SlaveNAK);
+			break;
+		default:
+			TWIAsync_Finish(TWI_ASYNC_STATUS_BusFault);
+			break;
+	}
+}
+
@@ -0,0 +1,227 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2011.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2011  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaim all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+
+/** \file
+ *  \brief Asynchronous TWI Peripheral Driver (AVR8)
+ *
+ *  Interrupt driven, asynchronous TWI master driver for the 8-bit AVR microcontrollers.
+ *
+ *  \note This file should not be included directly. It is automatically included as needed by the asynchronous
+ *        TWI driver dispatch header located in LUFA/Drivers/Peripheral/TWIAsync.h.
+ */
+
+/** \ingroup Group_TWIAsync
+ *  \defgroup Group_TWIAsync_AVR8 Asynchronous TWI Peripheral Driver (AVR8)
+ *
+ *  \section Sec_ModDescription Module Description
+ *  Interrupt driven master mode TWI driver for the 8-bit AVR microcontrollers which contain a hardware TWI module.
+ *
+ *  Each bus transaction is described by a \ref TWIAsync_Transaction_t descriptor owned by the application. A
+ *  transaction consists of an optional write phase (typically a register address, optionally followed by data)
+ *  and an optional read phase started with a repeated START condition. Submitted descriptors are linked into a
+ *  FIFO queue, and are processed one after another by the TWI interrupt without any involvement from the main
+ *  program. When a transaction finishes its status is updated and its optional callback is run from the TWI
+ *  interrupt, which makes it possible to chain further transactions or to act on read data immediately.
+ *
+ *  A descriptor must not be modified while it is queued or in progress; \ref TWIAsync_IsPending() may be used
+ *  to determine when it may be reused. Submitting a descriptor which is still pending is rejected, so that a
+ *  periodic poll of a slow device never builds up a backlog.
+ *
+ *  \note This file should not be included directly. It is automatically included as needed by the asynchronous
+ *        TWI driver dispatch header located in LUFA/Drivers/Peripheral/TWIAsync.h.
+ *
+ *  \section Sec_ExampleUsage Example Usage
+ *  The following snippet is an example of how this module may be used within a typical
+ *  application.
+ *
+ *  \code
+ *      static uint8_t RegisterAddress = 0x12;
+ *      static uint8_t ReadData[2];
+ *
+ *      static void ReadComplete(TWIAsync_Transaction_t* const Transaction)
+ *      {
+ *          if (Transaction->Status == TWI_ASYNC_STATUS_Complete)
+ *            ProcessInputs(ReadData[0], ReadData[1]);
+ *      }
+ *
+ *      static TWIAsync_Transaction_t ReadTransaction =
+ *          {
+ *              .SlaveAddress = 0x40,
+ *              .WriteBuffer  = &RegisterAddress,
+ *              .WriteLength  = 1,
+ *              .ReadBuffer   = ReadData,
+ *              .ReadLength   = sizeof(ReadData),
+ *              .Callback     = ReadComplete,
+ *          };
+ *
+ *      // Initialise the asynchronous TWI driver before first use
+ *      TWIAsync_Init(TWI_ASYNC_BIT_PRESCALE_1, 10);
+ *
+ *      // Queue the read, which will run in the background once global interrupts are enabled
+ *      TWIAsync_Submit(&ReadTransaction);
+ *  \endcode
+ *
+ *  @{
+ */
+
+#ifndef __TWI_ASYNC_AVR8_H__
+#define __TWI_ASYNC_AVR8_H__
+
+	/* Includes: */
+		#include "../../../Common/Common.h"
+		#include <util/twi.h>
+
+	/* Enable C linkage for C++ Compilers: */
+		#if defined(__cplusplus)
+			extern "C" {
+		#endif
+
+	/* Preprocessor Checks: */
+		#if !defined(__INCLUDE_FROM_TWI_ASYNC_H) && !defined(__INCLUDE_FROM_TWI_ASYNC_C)
+			#error Do not include this file directly. Include LUFA/Drivers/Peripheral/TWIAsync.h instead.
+		#endif
+
+		#if !(defined(__AVR_AT90USB1286__) || defined(__AVR_AT90USB646__) || \
+		      defined(__AVR_AT90USB1287__) || defined(__AVR_AT90USB647__) || \
+			  defined(__AVR_ATmega16U4__)  || defined(__AVR_ATmega32U4__) || \
+			  defined(__AVR_ATmega32U6__))
+			#error The asynchronous TWI peripheral driver is not currently available for your selected microcontroller model.
+		#endif
+
+	/* Public Interface - May be used in end-application: */
+		/* Macros: */
+			/** Bit length prescaler for \ref TWIAsync_Init(). This mask multiplies the TWI bit length prescaler by 1. */
+			#define TWI_ASYNC_BIT_PRESCALE_1       ((0 << TWPS1) | (0 << TWPS0))
+
+			/** Bit length prescaler for \ref TWIAsync_Init(). This mask multiplies the TWI bit length prescaler by 4. */
+			#define TWI_ASYNC_BIT_PRESCALE_4       ((0 << TWPS1) | (1 << TWPS0))
+
+			/** Bit length prescaler for \ref TWIAsync_Init(). This mask multiplies the TWI bit length prescaler by 16. */
+			#define TWI_ASYNC_BIT_PRESCALE_16      ((1 << TWPS1) | (0 << TWPS0))
+
+			/** Bit length prescaler for \ref TWIAsync_Init(). This mask multiplies the TWI bit length prescaler by 64. */
+			#define TWI_ASYNC_BIT_PRESCALE_64      ((1 << TWPS1) | (1 << TWPS0))
+
+		/* Enums: */
+			/** Enum for the possible status values of a \ref TWIAsync_Transaction_t descriptor. */
+			enum TWIAsync_Status_t
+			{
+				TWI_ASYNC_STATUS_Complete      = 0, /**< The transaction completed successfully. */
+				TWI_ASYNC_STATUS_Queued        = 1, /**< The transaction is waiting in the queue. */
+				TWI_ASYNC_STATUS_InProgress    = 2, /**< The transaction is currently being processed on the bus. */
+				TWI_ASYNC_STATUS_SlaveNAK      = 3, /**< The slave NAKed its address or a written data byte. */
+				TWI_ASYNC_STATUS_BusFault      = 4, /**< A bus error occurred, or the transaction was aborted by \ref TWIAsync_Reset(). */
+			};
+
+		/* Type Defines: */
+			struct TWIAsync_Transaction;
+
+			/** Type define for a transaction completion callback. Callbacks are run from the TWI interrupt. */
+			typedef void (*TWIAsync_CallbackPtr_t)(struct TWIAsync_Transaction* const Transaction);
+
+			/** \brief Asynchronous TWI Transaction Descriptor.
+			 *
+			 *  Describes a single bus transaction to be processed by the asynchronous TWI driver. Only the
+			 *  configuration fields should be set by the application; the remaining fields are managed by the driver.
+			 */
+			typedef struct TWIAsync_Transaction
+			{
+				uint8_t                SlaveAddress; /**< 8-bit slave base address, with the read/write bit clear. */
+				const uint8_t*         WriteBuffer; /**< Data to write to the slave, sent first. */
+				uint8_t                WriteLength; /**< Number of bytes to write, or zero for a read-only transaction. */
+				uint8_t*               ReadBuffer; /**< Location where data read from the slave is to be stored. */
+				uint8_t                ReadLength; /**< Number of bytes to read after a repeated START, or zero for a write-only transaction. */
+				TWIAsync_CallbackPtr_t Callback; /**< Optional function to call from the TWI interrupt on completion. */
+
+				volatile uint8_t       Status; /**< Current transaction status, a value from the \ref TWIAsync_Status_t enum. */
+				struct TWIAsync_Transaction* Next; /**< Next queued transaction, for driver use only. */
+			} TWIAsync_Transaction_t;
+
+		/* Inline Functions: */
+			/** Determines if the given transaction is queued or in progress, and therefore must not be modified.
+			 *
+			 *  \param[in] Transaction  Pointer to the transaction descriptor to test.
+			 *
+			 *  \return Boolean \c true if the transaction is pending, \c false if it has finished.
+			 */
+			static inline bool TWIAsync_IsPending(const TWIAsync_Transaction_t* const Transaction) ATTR_ALWAYS_INLINE;
+			static inline bool TWIAsync_IsPending(const TWIAsync_Transaction_t* const Transaction)
+			{
+				uint8_t Status = Transaction->Status;
+
+				return ((Status == TWI_ASYNC_STATUS_Queued) || (Status == TWI_ASYNC_STATUS_InProgress));
+			}
+
+		/* Function Prototypes: */
+			/** Initialises the TWI hardware into master mode and empties the transaction queue. This must be called
+			 *  before any other asynchronous TWI operations.
+			 *
+			 *  The generated SCL frequency will be according to the formula <pre>F_CPU / (16 + 2 * BitLength + 4 ^ Prescale)</pre>.
+			 *
+			 *  \note The value of the \c BitLength parameter should not be set below 10 or invalid bus conditions may
+			 *        occur, as indicated in the AVR8 microcontroller datasheet.
+			 *
+			 *  \param[in] Prescale   Prescaler to use when determining the bus frequency, a \c TWI_ASYNC_BIT_PRESCALE_* value.
+			 *  \param[in] BitLength  Length of the bits sent on the bus.
+			 */
+			void TWIAsync_Init(const uint8_t Prescale,
+			                   const uint8_t BitLength);
+
+			/** Appends a transaction descriptor to the end of the transaction queue, starting the bus if it is idle.
+			 *  This may be called from any execution thread, including from a completion callback.
+			 *
+			 *  \param[in,out] Transaction  Pointer to the transaction descriptor to queue.
+			 *
+			 *  \return Boolean \c true if the transaction was queued, \c false if it was already pending.
+			 */
+			bool TWIAsync_Submit(TWIAsync_Transaction_t* const Transaction) ATTR_NON_NULL_PTR_ARG(1);
+
+			/** Determines if the transaction queue is empty and the bus is idle.
+			 *
+			 *  \return Boolean \c true if no transaction is queued or in progress, \c false otherwise.
+			 */
+			bool TWIAsync_IsIdle(void) ATTR_WARN_UNUSED_RESULT;
+
+			/** Aborts the transaction in progress and all queued transactions, marking each as
+			 *  \ref TWI_ASYNC_STATUS_BusFault without running their callbacks, and resets the TWI hardware. This
+			 *  may be used to recover if a slave holds the bus.
+			 */
+			void TWIAsync_Reset(void);
+
+	/* Disable C linkage for C++ Compilers: */
+		#if defined(__cplusplus)
+			}
+		#endif
+
+#endif
+
+/** @} */
+
@@ -356,3 +356,77 @@ uint16_t USB_GetHIDReportSize(HID_ReportInfo_t* const ParserData,
 
 	return 0;
 }
+
+uint8_t USB_CompileHIDReportPlan(const HID_ReportInfo_t* const ParserData,
+                                 const uint8_t ReportID,
+                                 const uint8_t ReportType,
+                                 HID_ReportPlan_t* const Plan)
+{
+	Plan->ReportID    = ReportID;
+	Plan->TotalFields = 0;
+
+	for (uint8_t i = 0; i < ParserData->TotalReportItems; i++)
+	{
+		const HID_ReportItem_t* ReportItem = &ParserData->ReportItems[i];
+
+		if ((ReportItem->ReportID != ReportID) || (ReportItem->ItemType != ReportType))
+		  continue;
+
+		if (Plan->TotalFields == HID_MAX_PLAN_FIELDS)
+		  return HID_PARSE_InsufficientPlanFields;
+
+		HID_PlanField_t* Field   = &Plan->Fields[Plan->TotalFields++];
+		uint8_t          BitSize = ReportItem->Attributes.BitSize;
+
+		/* Values are 32 bits wide, as in USB_GetHIDReportItemInfo() */
+		if (BitSize > 32)
+		  BitSize = 32;
+
+		Field->ByteOffset = (ReportItem->BitOffset >> 3);
+		Field->Shift      = (ReportItem->BitOffset & 0x07);
+		Field->ByteCount  = ((Field->Shift + BitSize + 7) >> 3);
+		Field->Mask       = (BitSize < 32) ? ((1UL << BitSize) - 1) : 0xFFFFFFFF;
+		Field->Slot       = i;
+	}
+
+	if (!(Plan->TotalFields))
+	  return HID_PARSE_NoUnfilteredReportItems;
+
+	return HID_PARSE_Successful;
+}
+
+bool USB_GetHIDReportPlanValues(const HID_ReportPlan_t* const Plan,
+                                const uint8_t* ReportData,
+                                uint32_t* const Values)
+{
+	const HID_PlanField_t* Field = Plan->Fields;
+
+	if (Plan->ReportID)
+	{
+		if (Plan->ReportID != ReportData[0])
+		  return false;
+
+		ReportData++;
+	}
+
+	for (uint8_t FieldsRem = Plan->TotalFields; FieldsRem; FieldsRem--, Field++)
+	{
+		const uint8_t* FieldData = &ReportData[Field->ByteOffset];
+		uint8_t        Bytes     = (Field->ByteCount > 4) ? 4 : Field->ByteCount;
+		uint32_t       Value     = 0;
+
+		/* Little endian load of the bytes the field spans, then one shift and mask */
+		while (Bytes--)
+		  Value = (Value << 8) | FieldData[Bytes];
+
+		Value >>= Field->Shift;
+
+		/* An unaligned 32 bit field reaches into a fifth byte */
+		if (Field->ByteCount > 4)
+		  Value |= ((uint32_t)FieldData[4] << (32 - Field->Shift));
+
+		Values[Field->Slot] = (Value & Field->Mask);
+	}
+
+	return true;
+}
@@ -130,6 +130,16 @@
 			#define HID_MAX_REPORT_IDS            10
 		#endif
 
+		#if !defined(HID_MAX_PLAN_FIELDS) || defined(__DOXYGEN__)
+			/** Constant indicating the maximum number of fields in a compiled report extraction plan (see
+			 *  \ref USB_CompileHIDReportPlan()), i.e. the maximum number of report items of one report ID and type
+			 *  that a plan can extract. By default this is the same as \ref HID_MAX_REPORTITEMS, but this can be
+			 *  overridden by defining \c HID_MAX_PLAN_FIELDS to another value in the user project makefile, passing
+			 *  the define to the compiler using the -D compiler switch.
+			 */
+			#define HID_MAX_PLAN_FIELDS           HID_MAX_REPORTITEMS
+		#endif
+
 		/** Returns the value a given HID report item (once its value has been fetched via \ref USB_GetHIDReportItemInfo())
 		 *  left-aligned to the given data type. This allows for signed data to be interpreted correctly, by shifting the data
 		 *  leftwards until the data's sign bit is in the correct position.
@@ -155,6 +165,7 @@
 				HID_PARSE_UsageListOverflow           = 6, /**< More than \ref HID_USAGE_STACK_DEPTH usages listed in a row. */
 				HID_PARSE_InsufficientReportIDItems   = 7, /**< More than \ref HID_MAX_REPORT_IDS report IDs in the device. */
 				HID_PARSE_NoUnfilteredReportItems     = 8, /**< All report items from the device were filtered by the filtering callback routine. */
+				HID_PARSE_InsufficientPlanFields      = 9, /**< More than \ref HID_MAX_PLAN_FIELDS items in the report given to \ref USB_CompileHIDReportPlan(). */
 			};
 
 		/* Type Defines: */
@@ -267,6 +278,35 @@
 				                                      */
 			} HID_ReportInfo_t;
 
+			/** \brief HID Report Extraction Plan Field Structure.
+			 *
+			 *  Type define for the precomputed location of one report item within a report, see \ref HID_ReportPlan_t.
+			 */
+			typedef struct
+			{
+				uint16_t ByteOffset; /**< Offset of the first byte holding the field, after any report ID byte. */
+				uint8_t  Shift;      /**< Bit position of the field's least significant bit within that byte. */
+				uint8_t  ByteCount;  /**< Number of bytes the field spans, from 0 to 5. */
+				uint32_t Mask;       /**< Mask of the field's bits once shifted down to bit 0. */
+				uint8_t  Slot;       /**< Index of the field's item in the \ref HID_ReportInfo_t ReportItems array the plan
+				                      *   was compiled from, and of its value in the array filled by \ref USB_GetHIDReportPlanValues().
+				                      */
+			} HID_PlanField_t;
+
+			/** \brief HID Report Extraction Plan Structure.
+			 *
+			 *  Type define for a compiled report extraction plan: the fields of every report item of one report ID and
+			 *  type, precomputed by \ref USB_CompileHIDReportPlan() so that the values of each received report can be
+			 *  extracted with a table walk instead of a bit by bit copy per item. Once compiled, a plan does not
+			 *  reference the \ref HID_ReportInfo_t it was compiled from, which may then be discarded.
+			 */
+			typedef struct
+			{
+				uint8_t         ReportID;    /**< Report ID of the report, or 0x00 if the device does not use report IDs. */
+				uint8_t         TotalFields; /**< Total number of fields stored in the \c Fields array. */
+				HID_PlanField_t Fields[HID_MAX_PLAN_FIELDS]; /**< Fields to extract, in report order. */
+			} HID_ReportPlan_t;
+
 		/* Function Prototypes: */
 			/** Function to process a given HID report returned from an attached device, and store it into a given
 			 *  \ref HID_ReportInfo_t structure.
@@ -326,6 +366,39 @@
 			                              const uint8_t ReportID,
 			                              const uint8_t ReportType) ATTR_CONST ATTR_NON_NULL_PTR_ARG(1);
 
+			/** Compiles the report items of the given report ID and type from a parsed report descriptor into an extraction
+			 *  plan, which \ref USB_GetHIDReportPlanValues() then runs on each received report. This should be done once,
+			 *  after \ref USB_ProcessHIDReport(), for each report the application processes.
+			 *
+			 *  \param[in]  ParserData  Pointer to a \ref HID_ReportInfo_t instance containing the parser output.
+			 *  \param[in]  ReportID    Report ID of the report to compile, or 0x00 if the device does not use report IDs.
+			 *  \param[in]  ReportType  Type of the report to compile, a value from the \ref HID_ReportItemTypes_t enum.
+			 *  \param[out] Plan        Pointer to a \ref HID_ReportPlan_t instance for the compiled plan.
+			 *
+			 *  \return A value in the \ref HID_Parse_ErrorCodes_t enum: \ref HID_PARSE_NoUnfilteredReportItems if the parsed
+			 *          data has no items in the given report, \ref HID_PARSE_InsufficientPlanFields if it has too many.
+			 */
+			uint8_t USB_CompileHIDReportPlan(const HID_ReportInfo_t* const ParserData,
+			                                 const uint8_t ReportID,
+			                                 const uint8_t ReportType,
+			                                 HID_ReportPlan_t* const Plan) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(4);
+
+			/** Extracts the value of every field of a compiled plan out of the given HID report. Each value is stored
+			 *  at the index of the field's \c Slot, i.e. at the index its report item had in the \ref HID_ReportInfo_t the
+			 *  plan was compiled from, unaligned as the \c Value of \ref USB_GetHIDReportItemInfo().
+			 *
+			 *  \param[in]  Plan        Pointer to a plan compiled by \ref USB_CompileHIDReportPlan().
+			 *  \param[in]  ReportData  Buffer containing an IN or FEATURE report from an attached device.
+			 *  \param[out] Values      Array of values, large enough for the highest \c Slot in the plan.
+			 *
+			 *  \return Boolean \c true if the report is the one the plan was compiled for, \c false (and no values are
+			 *          changed) if its report ID differs.
+			 */
+			bool USB_GetHIDReportPlanValues(const HID_ReportPlan_t* const Plan,
+			                                const uint8_t* ReportData,
+			                                uint32_t* const Values) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(2)
+			                                ATTR_NON_NULL_PTR_ARG(3);
+
 			/** Callback routine for the HID Report Parser. This callback <b>must</b> be implemented by the user code when
 			 *  the parser is used, to determine what report IN, OUT and FEATURE item's information is stored into the user
 			 *  \ref HID_ReportInfo_t structure. This can be used to filter only those items the application will be using, so that
@@ -37,6 +37,10 @@
 #define  __INCLUDE_FROM_HID_DEVICE_C
 #include "HID.h"
 
+#if defined(INTERRUPT_CONTROL_ENDPOINT)
+	#error The HID device class driver builds control and IN reports in the same buffer, so control requests cannot be handled from an interrupt.
+#endif
+
 void HID_Device_ProcessControlRequest(USB_ClassInfo_HID_Device_t* const HIDInterfaceInfo)
 {
 	if (!(Endpoint_IsSETUPReceived()))
@@ -53,22 +57,37 @@ void HID_Device_ProcessControlRequest(USB_ClassInfo_HID_Device_t* const HIDInter
 				uint16_t ReportSize = 0;
 				uint8_t  ReportID   = (USB_ControlRequest.wValue & 0xFF);
 				uint8_t  ReportType = (USB_ControlRequest.wValue >> 8) - 1;
-				uint8_t  ReportData[HIDInterfaceInfo->Config.PrevReportINBufferSize];
+				uint8_t* ReportData = HIDInterfaceInfo->Config.ReportBuffer;
+				uint8_t* ReportPayload = &ReportData[1];
 
-				memset(ReportData, 0, sizeof(ReportData));
+				memset(ReportData, 0, HIDInterfaceInfo->Config.ReportBufferSize);
 
-				CALLBACK_HID_Device_CreateHIDReport(HIDInterfaceInfo, &ReportID, ReportType, ReportData, &ReportSize);
+				CALLBACK_HID_Device_CreateHIDReport(HIDInterfaceInfo, &ReportID, ReportType, ReportPayload, &ReportSize);
+
+				if (ReportSize >= HIDInterfaceInfo->Config.ReportBufferSize)
+				  ReportSize = HIDInterfaceInfo->Config.ReportBufferSize - 1;
 
 				if (HIDInterfaceInfo->Config.PrevReportINBuffer != NULL)
 				{
-					memcpy(HIDInterfaceInfo->Config.PrevReportINBuffer, ReportData,
+					memcpy(HIDInterfaceInfo->Config.PrevReportINBuffer, ReportPayload,
 					       HIDInterfaceInfo->Config.PrevReportINBufferSize);
 				}
 				
 				Endpoint_SelectEndpoint(ENDPOINT_CONTROLEP);
 
 				Endpoint_ClearSETUP();
-				Endpoint_Write_Control_Stream_LE(ReportData, ReportSize);
+
+				/* Reports with an ID are sent with the ID as their first byte, as on the IN endpoint */
+				if (ReportID)
+				{
+					ReportData[0] = ReportID;
+					Endpoint_Write_Control_Stream_LE(ReportData, ReportSize + 1);
+				}
+				else
+				{
+					Endpoint_Write_Control_Stream_LE(ReportPayload, ReportSize);
+				}
+
 				Endpoint_ClearOUT();
 			}
 
@@ -76,17 +95,62 @@ void HID_Device_ProcessControlRequest(USB_ClassInfo_HID_Device_t* const HIDInter
 		case HID_REQ_SetReport:
 			if (USB_ControlRequest.bmRequestType == (REQDIR_HOSTTODEVICE | REQTYPE_CLASS | REQREC_INTERFACE))
 			{
-				uint16_t ReportSize = USB_ControlRequest.wLength;
+				uint16_t BytesLeft  = USB_ControlRequest.wLength;
 				uint8_t  ReportID   = (USB_ControlRequest.wValue & 0xFF);
 				uint8_t  ReportType = (USB_ControlRequest.wValue >> 8) - 1;
-				uint8_t  ReportData[ReportSize];
+				uint8_t* ReportData = HIDInterfaceInfo->Config.ReportBuffer;
+				uint8_t  ChunkSize  = 0;
+				bool     SkipID     = (ReportID != 0);
+
+				HIDInterfaceInfo->State.ReportOffset = 0;
+				HIDInterfaceInfo->State.ReportLength = (SkipID && BytesLeft) ? (BytesLeft - 1) : BytesLeft;
 
 				Endpoint_ClearSETUP();
-				Endpoint_Read_Control_Stream_LE(ReportData, ReportSize);
-				Endpoint_ClearIN();
-				
-				CALLBACK_HID_Device_ProcessHIDReport(HIDInterfaceInfo, ReportID, ReportType,
-				                                     &ReportData[ReportID ? 1 : 0], ReportSize - (ReportID ? 1 : 0));
+
+				/* The report is received into the fixed buffer, and handed over each time the buffer fills with more to come,
+				 * so the stack use does not depend on the length the host asks for */
+				while (BytesLeft)
+				{
+					uint8_t USB_DeviceState_LCL = USB_DeviceState;
+
+					if ((USB_DeviceState_LCL == DEVICE_STATE_Unattached) || (USB_DeviceState_LCL == DEVICE_STATE_Suspended) ||
+					    Endpoint_IsSETUPReceived())
+					{
+						return;
+					}
+
+					if (!(Endpoint_IsOUTReceived()))
+					  continue;
+
+					while (BytesLeft && Endpoint_BytesInEndpoint())
+					{
+						uint8_t Byte = Endpoint_Read_8();
+
+						BytesLeft--;
+
+						/* Reports with an ID are received with the ID as their first byte, which the callback gets separately */
+						if (SkipID)
+						{
+							SkipID = false;
+							continue;
+						}
+
+						if (ChunkSize == HIDInterfaceInfo->Config.ReportBufferSize)
+						{
+							CALLBACK_HID_Device_ProcessHIDReport(HIDInterfaceInfo, ReportID, ReportType, ReportData, ChunkSize);
+							HIDInterfaceInfo->State.ReportOffset += ChunkSize;
+							ChunkSize = 0;
+						}
+
+						ReportData[ChunkSize++] = Byte;
+					}
+
+					Endpoint_ClearOUT();
+				}
+
+				Endpoint_ClearStatusStage();
+
+				CALLBACK_HID_Device_ProcessHIDReport(HIDInterfaceInfo, ReportID, ReportType, ReportData, ChunkSize);
 			}
 
 			break;
@@ -158,11 +222,11 @@ void HID_Device_USBTask(USB_ClassInfo_HID_Device_t* const HIDInterfaceInfo)
 
 	if (Endpoint_IsReadWriteAllowed())
 	{
-		uint8_t  ReportINData[HIDInterfaceInfo->Config.PrevReportINBufferSize];
+		uint8_t* ReportINData = HIDInterfaceInfo->Config.ReportBuffer;
 		uint8_t  ReportID     = 0;
 		uint16_t ReportINSize = 0;
 
-		memset(ReportINData, 0, sizeof(ReportINData));
+		memset(ReportINData, 0, HIDInterfaceInfo->Config.PrevReportINBufferSize);
 
 		bool ForceSend         = CALLBACK_HID_Device_CreateHIDReport(HIDInterfaceInfo, &ReportID, HID_REPORT_ITEM_In,
 		                                                             ReportINData, &ReportINSize);
@@ -107,6 +107,16 @@
 					                                  *  exclusively (i.e. \ref PrevReportINBuffer is \c NULL) this value must still be
 													  *  set to the size of the largest report the device can issue to the host.
 					                                  */
+
+					void*    ReportBuffer; /**< Pointer to a statically allocated buffer the driver builds and receives reports in,
+					                        *  instead of allocating them on the stack. It must hold the largest input or feature
+					                        *  report the interface sends plus its report ID byte, i.e. at least
+					                        *  \ref PrevReportINBufferSize + 1 bytes. Interfaces used from the same context may
+					                        *  share one buffer.
+					                        */
+					uint8_t  ReportBufferSize; /**< Size in bytes of \ref ReportBuffer. SET_REPORT requests longer than this are
+					                            *  passed to \ref CALLBACK_HID_Device_ProcessHIDReport() in chunks of this size.
+					                            */
 				} Config; /**< Config data for the USB class interface within the device. All elements in this section
 				           *   <b>must</b> be set or the interface will fail to enumerate and operate correctly.
 				           */
@@ -116,6 +126,13 @@
 					uint16_t IdleCount; /**< Report idle period, in milliseconds, set by the host. */
 					uint16_t IdleMSRemaining; /**< Total number of milliseconds remaining before the idle period elapsed - this
 											   *   should be decremented by the user application if non-zero each millisecond. */
+					uint16_t ReportOffset; /**< Offset within the report of the data passed to the current
+					                        *   \ref CALLBACK_HID_Device_ProcessHIDReport() call; non-zero for the later chunks of
+					                        *   a report longer than \ref ReportBuffer.
+					                        */
+					uint16_t ReportLength; /**< Length of the whole report the current SET_REPORT request carries, excluding
+					                        *   its report ID byte.
+					                        */
 				} State; /**< State data for the USB class interface within the device. All elements in this section
 				          *   are reset to their defaults when the interface is enumerated.
 				          */
@@ -182,6 +199,12 @@
 			 *  \param[in]     ReportType        Type of received HID report, either \ref HID_REPORT_ITEM_Out or \ref HID_REPORT_ITEM_Feature.
 			 *  \param[in]     ReportData        Pointer to a buffer where the received HID report is stored.
 			 *  \param[in]     ReportSize        Size in bytes of the received report from the host.
+			 *
+			 *  \note Reports longer than the interface's \c ReportBuffer arrive in several calls, each with the next chunk
+			 *        of the report and \c State.ReportOffset set to where that chunk starts; the last call is made after
+			 *        the request has been acknowledged, and \c State.ReportLength holds the length of the whole report.
+			 *        Applications which only accept reports that fit the buffer should ignore every call for which
+			 *        \ref HID_Device_IsWholeReport() is false: the first chunk of a longer report also has a zero offset.
 			 */
 			void CALLBACK_HID_Device_ProcessHIDReport(USB_ClassInfo_HID_Device_t* const HIDInterfaceInfo,
 			                                          const uint8_t ReportID,
@@ -204,6 +227,23 @@
 				  HIDInterfaceInfo->State.IdleMSRemaining--;
 			}
 
+			/** Indicates if a \ref CALLBACK_HID_Device_ProcessHIDReport() call holds the whole report, rather than one chunk
+			 *  of a report longer than the interface's \c ReportBuffer. Such a call is only made once the host has sent the
+			 *  whole report and the request has been acknowledged.
+			 *
+			 *  \param[in] HIDInterfaceInfo  Pointer to a structure containing a HID Class configuration and state.
+			 *  \param[in] ReportSize        Size in bytes of the received report, as passed to the callback.
+			 *
+			 *  \return Boolean \c true if the call holds the whole report, \c false otherwise.
+			 */
+			static inline bool HID_Device_IsWholeReport(const USB_ClassInfo_HID_Device_t* const HIDInterfaceInfo,
+			                                            const uint16_t ReportSize) ATTR_ALWAYS_INLINE ATTR_NON_NULL_PTR_ARG(1);
+			static inline bool HID_Device_IsWholeReport(const USB_ClassInfo_HID_Device_t* const HIDInterfaceInfo,
+			                                            const uint16_t ReportSize)
+			{
+				return ((HIDInterfaceInfo->State.ReportOffset == 0) && (ReportSize == HIDInterfaceInfo->State.ReportLength));
+			}
+
 	/* Disable C linkage for C++ Compilers: */
 		#if defined(__cplusplus)
 			}
@@ -52,7 +52,6 @@ static const uint32_t PROGMEM AdapterSupportedOIDList[]  =
 		OID_GEN_VENDOR_ID,
 		OID_GEN_VENDOR_DESCRIPTION,
 		OID_GEN_CURRENT_PACKET_FILTER,
-		OID_GEN_MAXIMUM_TOTAL_SIZE,
 		OID_GEN_MEDIA_CONNECT_STATUS,
 		OID_GEN_XMIT_OK,
 		OID_GEN_RCV_OK,
@@ -201,6 +200,10 @@ void RNDIS_Device_ProcessRNDISControlMessage(USB_ClassInfo_RNDIS_Device_t* const
 			RNDIS_Initialize_Complete_t* INITIALIZE_Response =
 			               (RNDIS_Initialize_Complete_t*)&RNDISInterfaceInfo->State.RNDISMessageBuffer;
 
+			/* Read before the response overwrites it in the shared buffer */
+			uint32_t HostMaxTransferSize = INITIALIZE_Message->MaxTransferSize;
+			RNDISInterfaceInfo->State.HostMaxTransferSize = (HostMaxTransferSize > 0xFFFF) ? 0xFFFF : HostMaxTransferSize;
+
 			INITIALIZE_Response->MessageType           = REMOTE_NDIS_INITIALIZE_CMPLT;
 			INITIALIZE_Response->MessageLength         = sizeof(RNDIS_Initialize_Complete_t);
 			INITIALIZE_Response->RequestId             = INITIALIZE_Message->RequestId;
@@ -512,13 +515,7 @@ uint8_t RNDIS_Device_SendPacket(USB_ClassInfo_RNDIS_Device_t* const RNDISInterfa
 	  return ErrorCode;
 
 	RNDIS_Packet_Message_t RNDISPacketHeader;
-
-	memset(&RNDISPacketHeader, 0, sizeof(RNDIS_Packet_Message_t));
-
-	RNDISPacketHeader.MessageType   = REMOTE_NDIS_PACKET_MSG;
-	RNDISPacketHeader.MessageLength = (sizeof(RNDIS_Packet_Message_t) + PacketLength);
-	RNDISPacketHeader.DataOffset    = (sizeof(RNDIS_Packet_Message_t) - sizeof(RNDIS_Message_Header_t));
-	RNDISPacketHeader.DataLength    = PacketLength;
+	RNDIS_Device_CreatePacketHeader(&RNDISPacketHeader, PacketLength);
 
 	Endpoint_Write_Stream_LE(&RNDISPacketHeader, sizeof(RNDIS_Packet_Message_t), NULL);
 	Endpoint_Write_Stream_LE(Buffer, PacketLength, NULL);
@@ -527,5 +524,77 @@ uint8_t RNDIS_Device_SendPacket(USB_ClassInfo_RNDIS_Device_t* const RNDISInterfa
 	return ENDPOINT_RWSTREAM_NoError;
 }
 
+bool RNDIS_Device_IsReadyToSend(USB_ClassInfo_RNDIS_Device_t* const RNDISInterfaceInfo)
+{
+	if ((USB_DeviceState != DEVICE_STATE_Configured) ||
+	    (RNDISInterfaceInfo->State.CurrRNDISState != RNDIS_Data_Initialized))
+	{
+		return false;
+	}
+
+	Endpoint_SelectEndpoint(RNDISInterfaceInfo->Config.DataINEndpointNumber);
+	return Endpoint_IsINReady();
+}
+
+void RNDIS_Device_CreatePacketHeader(RNDIS_Packet_Message_t* const Header,
+                                     const uint16_t PacketLength)
+{
+	memset(Header, 0, sizeof(RNDIS_Packet_Message_t));
+
+	Header->MessageType   = REMOTE_NDIS_PACKET_MSG;
+	Header->MessageLength = (sizeof(RNDIS_Packet_Message_t) + PacketLength);
+	Header->DataOffset    = (sizeof(RNDIS_Packet_Message_t) - sizeof(RNDIS_Message_Header_t));
+	Header->DataLength    = PacketLength;
+}
+
+uint8_t RNDIS_Device_WriteTransfer(USB_ClassInfo_RNDIS_Device_t* const RNDISInterfaceInfo,
+                                   const void* Buffer,
+                                   const uint16_t Length,
+                                   uint16_t* const BytesProcessed)
+{
+	const uint8_t* DataStream = ((const uint8_t*)Buffer + *BytesProcessed);
+
+	if ((USB_DeviceState != DEVICE_STATE_Configured) ||
+	    (RNDISInterfaceInfo->State.CurrRNDISState != RNDIS_Data_Initialized))
+	{
+		return ENDPOINT_RWSTREAM_DeviceDisconnected;
+	}
+
+	Endpoint_SelectEndpoint(RNDISInterfaceInfo->Config.DataINEndpointNumber);
+
+	while (*BytesProcessed < Length)
+	{
+		/* The host still holds the bank; resume once it has taken it */
+		if (!(Endpoint_IsINReady()))
+		  return ENDPOINT_RWSTREAM_IncompleteTransfer;
+
+		Endpoint_Write_8(*(DataStream++));
+		(*BytesProcessed)++;
+
+		if (!(Endpoint_IsReadWriteAllowed()))
+		  Endpoint_ClearIN();
+	}
+
+	return ENDPOINT_RWSTREAM_NoError;
+}
+
+uint8_t RNDIS_Device_EndTransfer(USB_ClassInfo_RNDIS_Device_t* const RNDISInterfaceInfo)
+{
+	if ((USB_DeviceState != DEVICE_STATE_Configured) ||
+	    (RNDISInterfaceInfo->State.CurrRNDISState != RNDIS_Data_Initialized))
+	{
+		return ENDPOINT_RWSTREAM_DeviceDisconnected;
+	}
+
+	Endpoint_SelectEndpoint(RNDISInterfaceInfo->Config.DataINEndpointNumber);
+
+	if (!(Endpoint_IsINReady()))
+	  return ENDPOINT_RWSTREAM_IncompleteTransfer;
+
+	Endpoint_ClearIN();
+
+	return ENDPOINT_RWSTREAM_NoError;
+}
+
 #endif
 
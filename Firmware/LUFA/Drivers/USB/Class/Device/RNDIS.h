@@ -106,6 +106,10 @@
 					bool     ResponseReady; /**< Internal flag indicating if a RNDIS message is waiting to be returned to the host. */
 					uint8_t  CurrRNDISState; /**< Current RNDIS state of the adapter, a value from the \ref RNDIS_States_t enum. */
 					uint32_t CurrPacketFilter; /**< Current packet filter mode, used internally by the class driver. */
+					uint16_t HostMaxTransferSize; /**< Largest transfer the host accepts on the data IN endpoint, from its
+					                               *   initialize message. Packets batched with \ref RNDIS_Device_WriteTransfer()
+					                               *   must not add up to more than this.
+					                               */
 				} State; /**< State data for the USB class interface within the device. All elements in this section
 				          *   are reset to their defaults when the interface is enumerated.
 				          */
@@ -182,6 +186,58 @@
 											void* Buffer,
 											const uint16_t PacketLength);
 
+			/** Determines if the data IN endpoint bank is free, so that a batched transfer may be started or continued
+			 *  with \ref RNDIS_Device_WriteTransfer() without it returning straight away.
+			 *
+			 *  \param[in,out] RNDISInterfaceInfo  Pointer to a structure containing an RNDIS Class configuration and state.
+			 *
+			 *  \return Boolean \c true if the adapter is initialized and the IN bank is free, \c false otherwise.
+			 */
+			bool RNDIS_Device_IsReadyToSend(USB_ClassInfo_RNDIS_Device_t* const RNDISInterfaceInfo) ATTR_NON_NULL_PTR_ARG(1);
+
+			/** Fills in the RNDIS packet message header which must precede each packet of a batched transfer.
+			 *
+			 *  \param[out] Header        Pointer to the header to fill in.
+			 *  \param[in]  PacketLength  Length in bytes of the Ethernet frame which follows the header.
+			 */
+			void RNDIS_Device_CreatePacketHeader(RNDIS_Packet_Message_t* const Header,
+			                                     const uint16_t PacketLength) ATTR_NON_NULL_PTR_ARG(1);
+
+			/** Writes part of a batched transfer to the data IN endpoint, without waiting for the host. A batched transfer
+			 *  is any number of packets, each a header from \ref RNDIS_Device_CreatePacketHeader() followed by its
+			 *  Ethernet frame, written back to back with one or more calls per header or frame and ended with
+			 *  \ref RNDIS_Device_EndTransfer(). The whole transfer must not exceed the host's \c HostMaxTransferSize.
+			 *
+			 *  Each full bank is sent as soon as it is written. When the next bank is not yet free, the function returns
+			 *  \ref ENDPOINT_RWSTREAM_IncompleteTransfer with the progress in \c BytesProcessed; call it again later with
+			 *  the same buffer contents and \c BytesProcessed to resume.
+			 *
+			 *  \pre This function must only be called when the Device state machine is in the \ref DEVICE_STATE_Configured state or the
+			 *       call will fail.
+			 *
+			 *  \param[in,out] RNDISInterfaceInfo  Pointer to a structure containing an RNDIS Class configuration and state.
+			 *  \param[in]     Buffer              Pointer to the data to write.
+			 *  \param[in]     Length              Length in bytes of the data to write.
+			 *  \param[in,out] BytesProcessed      Bytes of \c Buffer already written, updated as more are written.
+			 *
+			 *  \return A value from the \ref Endpoint_Stream_RW_ErrorCodes_t enum.
+			 */
+			uint8_t RNDIS_Device_WriteTransfer(USB_ClassInfo_RNDIS_Device_t* const RNDISInterfaceInfo,
+			                                   const void* Buffer,
+			                                   const uint16_t Length,
+			                                   uint16_t* const BytesProcessed) ATTR_NON_NULL_PTR_ARG(1)
+			                                   ATTR_NON_NULL_PTR_ARG(4);
+
+			/** Ends a batched transfer written with \ref RNDIS_Device_WriteTransfer(), by sending the partly filled bank
+			 *  as a short packet, or a zero length packet if the transfer filled its last bank. Does not wait for the host;
+			 *  call again while it returns \ref ENDPOINT_RWSTREAM_IncompleteTransfer.
+			 *
+			 *  \param[in,out] RNDISInterfaceInfo  Pointer to a structure containing an RNDIS Class configuration and state.
+			 *
+			 *  \return A value from the \ref Endpoint_Stream_RW_ErrorCodes_t enum.
+			 */
+			uint8_t RNDIS_Device_EndTransfer(USB_ClassInfo_RNDIS_Device_t* const RNDISInterfaceInfo) ATTR_NON_NULL_PTR_ARG(1);
+
 	/* Private Interface - For use in library only: */
 	#if !defined(__DOXYGEN__)
 		/* Function Prototypes: */
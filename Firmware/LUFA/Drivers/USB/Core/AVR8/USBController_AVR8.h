@@ -359,6 +359,10 @@
 			static inline void USB_PLL_On(void) ATTR_ALWAYS_INLINE;
 			static inline void USB_PLL_On(void)
 			{
+				/* Leave a PLL already started with the right prescaler alone, so that its lock is not restarted */
+				if ((PLLCSR & ~(1 << PLOCK)) == (USB_PLL_PSC | (1 << PLLE)))
+				  return;
+
 				PLLCSR  = USB_PLL_PSC;
 				PLLCSR |= (1 << PLLE);
 			}
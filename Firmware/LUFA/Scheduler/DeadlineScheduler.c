@@ -0,0 +1,207 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2011.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2011  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaim all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+
+#include "DeadlineScheduler.h"
+
+#include <avr/sleep.h>
+
+uint8_t DeadlineScheduler_TotalTasks;
+
+/* Time of the previous pass, or of the last wake up: the earliest an event driven release not yet seen can be from */
+static uint16_t DeadlineScheduler_LastPass;
+
+void DeadlineScheduler_InitScheduler(const uint8_t TotalTasks)
+{
+	DeadlineScheduler_TotalTasks = TotalTasks;
+
+	/* Free running Timer 1 at F_CPU/64, used as the scheduler time base */
+	TCCR1A = 0;
+	TCCR1B = ((1 << CS11) | (1 << CS10));
+	TIMSK1 = 0;
+
+	set_sleep_mode(SLEEP_MODE_IDLE);
+
+	uint16_t Now = DeadlineScheduler_GetTime();
+
+	DeadlineScheduler_LastPass = Now;
+
+	for (uint8_t i = 0; i < TotalTasks; i++)
+	{
+		DeadlineTaskEntry_t* CurrTask = &DeadlineScheduler_TaskList[i];
+
+		CurrTask->Waiting         = false;
+		CurrTask->ReleaseTime     = Now;
+		CurrTask->MaxStartLatency = 0;
+		CurrTask->DeadlineMisses  = 0;
+	}
+}
+
+void DeadlineScheduler_SetTaskEnabled(const uint8_t TaskIndex,
+                                      const bool Enabled)
+{
+	DeadlineTaskEntry_t* CurrTask = &DeadlineScheduler_TaskList[TaskIndex];
+
+	if (Enabled && !(CurrTask->Enabled))
+	{
+		CurrTask->Waiting     = false;
+		CurrTask->ReleaseTime = DeadlineScheduler_GetTime();
+	}
+
+	CurrTask->Enabled = Enabled;
+}
+
+static void DeadlineScheduler_Sleep(const bool HasTimedRelease,
+                                    const uint16_t NextRelease)
+{
+	GlobalInterruptDisable();
+
+	/* Don't sleep if a task was released by an ISR after the task list was scanned */
+	for (uint8_t i = 0; i < DeadlineScheduler_TotalTasks; i++)
+	{
+		if (DeadlineScheduler_TaskList[i].Pending)
+		{
+			GlobalInterruptEnable();
+			return;
+		}
+	}
+
+	if (HasTimedRelease)
+	{
+		OCR1A   = NextRelease;
+		TIFR1   = (1 << OCF1A);
+		TIMSK1 |= (1 << OCIE1A);
+
+		/* Compare match will not fire until the timer wraps if the release time has already passed */
+		if ((int16_t)(DeadlineScheduler_GetTime() - NextRelease) >= 0)
+		{
+			GlobalInterruptEnable();
+			return;
+		}
+	}
+	else
+	{
+		TIMSK1 &= ~(1 << OCIE1A);
+	}
+
+	/* Interrupts are re-enabled immediately before the sleep instruction, so any wake event from this point is not lost */
+	sleep_enable();
+	GlobalInterruptEnable();
+	sleep_cpu();
+	sleep_disable();
+
+	/* The interrupt which woke the CPU has run by now, and any release it made was at most that long ago */
+	DeadlineScheduler_LastPass = DeadlineScheduler_GetTime();
+}
+
+void DeadlineScheduler_RunOnce(void)
+{
+	DeadlineTaskEntry_t* BestTask        = NULL;
+	uint16_t             BestDeadline    = 0;
+	bool                 HasTimedRelease = false;
+	uint16_t             NextRelease     = 0;
+	uint16_t             Now             = DeadlineScheduler_GetTime();
+
+	for (uint8_t i = 0; i < DeadlineScheduler_TotalTasks; i++)
+	{
+		DeadlineTaskEntry_t* CurrTask = &DeadlineScheduler_TaskList[i];
+
+		if (!(CurrTask->Enabled))
+		  continue;
+
+		if (!(CurrTask->Waiting))
+		{
+			if (CurrTask->Pending)
+			{
+				/* Released some time after the previous pass saw it was not */
+				CurrTask->Waiting     = true;
+				CurrTask->ReleaseTime = DeadlineScheduler_LastPass;
+			}
+			else if (CurrTask->Period)
+			{
+				if ((int16_t)(Now - CurrTask->ReleaseTime) >= 0)
+				{
+					CurrTask->Waiting = true;
+				}
+				else if (!(HasTimedRelease) || ((int16_t)(CurrTask->ReleaseTime - NextRelease) < 0))
+				{
+					HasTimedRelease = true;
+					NextRelease     = CurrTask->ReleaseTime;
+				}
+			}
+		}
+
+		if (!(CurrTask->Waiting))
+		  continue;
+
+		uint16_t AbsoluteDeadline = (CurrTask->ReleaseTime + CurrTask->Deadline);
+
+		if ((BestTask == NULL) || (CurrTask->Priority < BestTask->Priority) ||
+		    ((CurrTask->Priority == BestTask->Priority) && ((int16_t)(AbsoluteDeadline - BestDeadline) < 0)))
+		{
+			BestTask     = CurrTask;
+			BestDeadline = AbsoluteDeadline;
+		}
+	}
+
+	DeadlineScheduler_LastPass = Now;
+
+	if (BestTask == NULL)
+	{
+		DeadlineScheduler_Sleep(HasTimedRelease, NextRelease);
+		return;
+	}
+
+	uint16_t StartLatency = (Now - BestTask->ReleaseTime);
+
+	if (StartLatency > BestTask->MaxStartLatency)
+	  BestTask->MaxStartLatency = StartLatency;
+
+	if ((StartLatency > BestTask->Deadline) && (BestTask->DeadlineMisses != 0xFF))
+	  BestTask->DeadlineMisses++;
+
+	if (BestTask->Period)
+	{
+		/* If the task overran its next release, drop the missed releases rather than running back-to-back */
+		BestTask->ReleaseTime += BestTask->Period;
+
+		if ((int16_t)(Now - BestTask->ReleaseTime) >= 0)
+		  BestTask->ReleaseTime = (Now + BestTask->Period);
+	}
+
+	BestTask->Waiting = false;
+	BestTask->Pending = false;
+
+	BestTask->Task();
+}
+
+/* Only used to wake the CPU from sleep at the next periodic task release */
+EMPTY_INTERRUPT(TIMER1_COMPA_vect);
+
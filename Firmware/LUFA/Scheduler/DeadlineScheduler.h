@@ -0,0 +1,262 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2011.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2011  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaim all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+
+/** \file
+ *  \brief Deadline-aware tickless cooperative task scheduler.
+ *
+ *  Cooperative scheduler which runs released tasks in priority and deadline order, and sleeps the
+ *  CPU until the next release when there is no work to do.
+ */
+
+/** \defgroup Group_DeadlineScheduler Deadline Task Scheduler - LUFA/Scheduler/DeadlineScheduler.h
+ *  \brief Deadline-aware tickless cooperative task scheduler.
+ *
+ *  \section Sec_Dependencies Module Source Dependencies
+ *  The following files must be built with any user project that uses this module:
+ *    - LUFA/Scheduler/DeadlineScheduler.c <i>(Makefile source module name: LUFA_SRC_DEADLINE_SCHEDULER)</i>
+ *
+ *  \section Sec_ModDescription Module Description
+ *  Replacement for the round-robbin \ref Group_Scheduler for applications where one task (such as sending
+ *  an input report) must start within a bounded time of becoming ready, regardless of what other tasks exist.
+ *
+ *  Each task in the task list is either periodic, in which case it is released automatically every \c Period
+ *  ticks, or event driven, in which case it is released by a call to \ref DeadlineScheduler_ReleaseTask() from
+ *  anywhere in the application (including from an ISR). A task may also be both. Each call to
+ *  \ref DeadlineScheduler_RunOnce() then runs exactly one released task: the one with the numerically lowest
+ *  \c Priority value, with ties broken by the earliest absolute deadline (release time plus \c Deadline).
+ *  Tasks run to completion, so the worst case start latency of the highest priority task is bounded by the
+ *  longest single execution of any other task.
+ *
+ *  There is no periodic tick interrupt. Time is read directly from the free running 16-bit Timer 1 counter,
+ *  clocked at F_CPU/64. When no task is released, the CPU is put into idle sleep with the Timer 1 compare
+ *  match A interrupt armed for the next periodic release, so that it wakes either at that time or on any
+ *  other interrupt (e.g. a USB event that releases a task). Since the timer wraps every 65536 ticks, periods
+ *  and deadlines must be no longer than half of that.
+ *
+ *  To assist in validating a task set, the scheduler records the worst observed start latency (time from
+ *  release to start) of each task, and counts the number of times a task started after its deadline. As the
+ *  timer may not be read from an ISR, a task released by \ref DeadlineScheduler_ReleaseTask() is taken to be
+ *  released at the previous pass of the scheduler, or at the wake up if the scheduler was asleep. Its latency
+ *  is thus an upper bound, which includes the run time of any task it had to wait behind.
+ *
+ *  \note Timer 1 is reserved for use by this module. The Timer 1 16-bit registers are only accessed from the
+ *        main program thread, so no ISR in the application may access any other Timer 1 16-bit register.
+ *
+ *  Usage Example:
+ *  \code
+ *      #include <LUFA/Scheduler/DeadlineScheduler.h>
+ *
+ *      enum { REPORT_TASK, LAMP_TASK };
+ *
+ *      DEADLINE_TASK(ReportTask); // Task prototype
+ *      DEADLINE_TASK(LampTask);   // Task prototype
+ *
+ *      DEADLINE_TASK_LIST
+ *      {
+ *          [REPORT_TASK] = { .Task = ReportTask, .Priority = 0, .Period = 0,
+ *                            .Deadline = DEADLINE_SCHEDULER_US_TO_TICKS(100), .Enabled = true },
+ *          [LAMP_TASK]   = { .Task = LampTask,   .Priority = 1, .Period = DEADLINE_SCHEDULER_MS_TO_TICKS(10),
+ *                            .Deadline = DEADLINE_SCHEDULER_MS_TO_TICKS(5),   .Enabled = true },
+ *      };
+ *
+ *      int main(void)
+ *      {
+ *          DeadlineScheduler_Init();
+ *
+ *          // Other initialisation here
+ *
+ *          for (;;)
+ *            DeadlineScheduler_RunOnce();
+ *      }
+ *
+ *      ISR(SOME_EVENT_vect)
+ *      {
+ *          DeadlineScheduler_ReleaseTask(REPORT_TASK);
+ *      }
+ *  \endcode
+ *
+ *  @{
+ */
+
+#ifndef __DEADLINE_SCHEDULER_H__
+#define __DEADLINE_SCHEDULER_H__
+
+	/* Includes: */
+		#include "../Common/Common.h"
+
+	/* Enable C linkage for C++ Compilers: */
+		#if defined(__cplusplus)
+			extern "C" {
+		#endif
+
+	/* Preprocessor Checks: */
+		#if (ARCH != ARCH_AVR8)
+			#error The deadline scheduler is currently only available for the AVR8 architecture.
+		#endif
+
+	/* Public Interface - May be used in end-application: */
+		/* Macros: */
+			/** Creates a new deadline scheduler task body or prototype. Should be used in the form:
+			 *  \code
+			 *      DEADLINE_TASK(TaskName); // Prototype
+			 *
+			 *      DEADLINE_TASK(TaskName)
+			 *      {
+			 *           // Task body
+			 *      }
+			 *  \endcode
+			 */
+			#define DEADLINE_TASK(name)                  void name (void)
+
+			/** Defines the task list array, containing one or more task entries of the type \ref DeadlineTaskEntry_t.
+			 *  The list should be encased in curly braces and ended with a semicolon. Designated array initializers
+			 *  are recommended, so that each task's index may be used with \ref DeadlineScheduler_ReleaseTask().
+			 */
+			#define DEADLINE_TASK_LIST                   DeadlineTaskEntry_t DeadlineScheduler_TaskList[] =
+
+			/** Frequency of the scheduler time base, in ticks per second. */
+			#define DEADLINE_SCHEDULER_TICK_HZ           (F_CPU / 64UL)
+
+			/** Converts a time in microseconds into scheduler ticks, rounding down.
+			 *
+			 *  \param[in] us  Time to convert, in microseconds.
+			 */
+			#define DEADLINE_SCHEDULER_US_TO_TICKS(us)   ((uint16_t)((DEADLINE_SCHEDULER_TICK_HZ * (us)) / 1000000UL))
+
+			/** Converts a time in milliseconds into scheduler ticks, rounding down.
+			 *
+			 *  \param[in] ms  Time to convert, in milliseconds.
+			 */
+			#define DEADLINE_SCHEDULER_MS_TO_TICKS(ms)   ((uint16_t)((DEADLINE_SCHEDULER_TICK_HZ * (ms)) / 1000UL))
+
+			/** Maximum period or deadline which may be given to a task, in ticks. */
+			#define DEADLINE_SCHEDULER_MAX_TICKS         0x7FFF
+
+		/* Pseudo-Function Macros: */
+			#if defined(__DOXYGEN__)
+				/** Initializes the scheduler time base and releases all enabled periodic tasks immediately. This must
+				 *  be called before any other scheduler function.
+				 */
+				void DeadlineScheduler_Init(void);
+			#else
+				#define DeadlineScheduler_Init()     DeadlineScheduler_InitScheduler(DEADLINE_TOTAL_TASKS)
+			#endif
+
+		/* Type Defines: */
+			/** Type define for a pointer to a deadline scheduler task. */
+			typedef void (*DeadlineTaskPtr_t)(void);
+
+			/** \brief Deadline Scheduler Task List Entry Structure.
+			 *
+			 *  Structure for holding a single task's configuration and scheduling state in the task list. Only the
+			 *  configuration fields should be set in the task list initializer; the remaining fields are managed
+			 *  by the scheduler.
+			 */
+			typedef struct
+			{
+				DeadlineTaskPtr_t Task; /**< Pointer to the task to execute. */
+				uint8_t           Priority; /**< Task priority, where lower values are more urgent. */
+				uint16_t          Period; /**< Periodic release interval in ticks, or zero for an event driven task. */
+				uint16_t          Deadline; /**< Maximum allowed time from release to start, in ticks. */
+				bool              Enabled; /**< If \c false, the task is never released. */
+
+				volatile bool     Pending; /**< Set by \ref DeadlineScheduler_ReleaseTask() to release the task. */
+				bool              Waiting; /**< Set by the scheduler while the task is released but not yet started. */
+				uint16_t          ReleaseTime; /**< Time of the current release if waiting, otherwise the next periodic release. */
+				uint16_t          MaxStartLatency; /**< Worst observed time from release to start, in ticks; see above. */
+				uint8_t           DeadlineMisses; /**< Number of late starts, saturating at 255. */
+			} DeadlineTaskEntry_t;
+
+		/* Global Variables: */
+			/** Task entry list, containing the scheduler tasks and their state. */
+			extern DeadlineTaskEntry_t DeadlineScheduler_TaskList[];
+
+			/** Contains the total number of tasks in the task list.
+			 *
+			 *  \note This value should be treated as read-only, and never altered in user-code.
+			 */
+			extern uint8_t DeadlineScheduler_TotalTasks;
+
+		/* Inline Functions: */
+			/** Retrieves the current scheduler time, in ticks. This must only be called from the main program thread.
+			 *
+			 *  \return Free running tick count, wrapping every 65536 ticks.
+			 */
+			static inline uint16_t DeadlineScheduler_GetTime(void) ATTR_ALWAYS_INLINE ATTR_WARN_UNUSED_RESULT;
+			static inline uint16_t DeadlineScheduler_GetTime(void)
+			{
+				return TCNT1;
+			}
+
+			/** Releases an event driven (or periodic) task so that it will be run as soon as no more urgent task is
+			 *  waiting. Releasing a task which is already waiting to run has no further effect. This may be called
+			 *  from any execution thread, including an ISR.
+			 *
+			 *  \param[in] TaskIndex  Index of the task to release in the task list.
+			 */
+			static inline void DeadlineScheduler_ReleaseTask(const uint8_t TaskIndex) ATTR_ALWAYS_INLINE;
+			static inline void DeadlineScheduler_ReleaseTask(const uint8_t TaskIndex)
+			{
+				DeadlineScheduler_TaskList[TaskIndex].Pending = true;
+			}
+
+		/* Function Prototypes: */
+			/** Runs the single most urgent released task, or sleeps until the next task release or interrupt if
+			 *  no task is released. This should be called repeatedly from the application's main loop.
+			 */
+			void DeadlineScheduler_RunOnce(void);
+
+			/** Enables or disables a task. Enabling a periodic task releases it immediately.
+			 *
+			 *  \param[in] TaskIndex  Index of the task to change in the task list.
+			 *  \param[in] Enabled    New enable state of the task.
+			 */
+			void DeadlineScheduler_SetTaskEnabled(const uint8_t TaskIndex,
+			                                      const bool Enabled);
+
+	/* Private Interface - For use in library only: */
+	#if !defined(__DOXYGEN__)
+		/* Macros: */
+			#define DEADLINE_TOTAL_TASKS              (sizeof(DeadlineScheduler_TaskList) / sizeof(DeadlineTaskEntry_t))
+
+		/* Function Prototypes: */
+			void DeadlineScheduler_InitScheduler(const uint8_t TotalTasks);
+	#endif
+
+	/* Disable C linkage for C++ Compilers: */
+		#if defined(__cplusplus)
+			}
+		#endif
+
+#endif
+
+/** @} */
+
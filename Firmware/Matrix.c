@@ -0,0 +1,140 @@
+/*
+  Pop'n Convertible Arcade Style Controller Project
+ 
+  Copyright 2011 Sam Wong (Sam /@/ hellosam /./ net)
+
+  This work is licensed under the Creative Commons Attribution 3.0 
+  Hong Kong License. 
+
+  To view a copy of this license, visit 
+  http://creativecommons.org/licenses/by/3.0/hk/ or send a letter to 
+  Creative Commons, 444 Castro Street, Suite 900, 
+  Mountain View, California, 94041, USA.  
+*/
+
+#include "Matrix.h"
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+
+#if MATRIX_ROWS < 1 || MATRIX_ROWS > 8
+#error MATRIX_ROWS must be 1 to 8.
+#endif
+
+/// Timer0 compare value for the tick, counting at F_CPU/8
+#define MATRIX_TICK_COMPARE ((F_CPU / 8 / 1000000UL) * MATRIX_TICK_US - 1)
+
+#if MATRIX_TICK_COMPARE > 255
+#error MATRIX_TICK_US is too long for Timer0.
+#endif
+
+typedef struct
+{
+    volatile uint8_t* ddr;
+    uint8_t mask;
+} MatrixRowPin_t;
+
+static const MatrixRowPin_t rowPins[MATRIX_ROWS] = MATRIX_ROW_PINS;
+
+/// [Bitmap] Pressed columns per row (active high), one bank being scanned and one published
+static volatile uint8_t scan[2][MATRIX_ROWS];
+/// Bank being written by the scan; the other one holds the last complete scan
+static volatile uint8_t scanBank;
+/// Row currently driven
+static uint8_t scanRow;
+
+#if !defined(MATRIX_DIODES)
+/// [Bitmap] Last state given out, held for keys in a ghost rectangle
+static uint8_t reported[MATRIX_ROWS];
+#endif
+
+/** Set up the pins and start scanning on Timer0 */
+void Matrix_Init(void)
+{
+    uint8_t i;
+
+    // Columns are PB0 to PB7
+    DDRB  = 0;
+    PORTB = 0xFF;
+
+    // Rows float until driven. Their PORT bits are left at the reset value
+    // of 0, so driving a row low is just setting its DDR bit.
+    for (i = 0; i < MATRIX_ROWS; i++)
+    {
+        *rowPins[i].ddr &= ~rowPins[i].mask;
+    }
+
+    scanRow = 0;
+    scanBank = 0;
+    *rowPins[0].ddr |= rowPins[0].mask;
+
+    // CTC mode, F_CPU/8, interrupt every tick
+    OCR0A  = MATRIX_TICK_COMPARE;
+    TCCR0A = _BV(WGM01);
+    TCCR0B = _BV(CS01);
+    TIMSK0 = _BV(OCIE0A);
+}
+
+/** Copy the last complete scan, one byte per row, with ghost keys held */
+void Matrix_Read(uint8_t* rows)
+{
+    uint8_t i;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        const volatile uint8_t* published = scan[scanBank ^ 1];
+
+        for (i = 0; i < MATRIX_ROWS; i++)
+        {
+            rows[i] = published[i];
+        }
+    }
+
+#if !defined(MATRIX_DIODES)
+    {
+        uint8_t ghost[MATRIX_ROWS] = { 0 };
+        uint8_t j;
+        uint8_t common;
+
+        // Two rows sharing two pressed columns form a rectangle: any of its
+        // corners may be a phantom, so none of them can be trusted
+        for (i = 0; i < MATRIX_ROWS; i++)
+        {
+            for (j = i + 1; j < MATRIX_ROWS; j++)
+            {
+                common = rows[i] & rows[j];
+                if (common & (common - 1))
+                {
+                    ghost[i] |= common;
+                    ghost[j] |= common;
+                }
+            }
+        }
+
+        for (i = 0; i < MATRIX_ROWS; i++)
+        {
+            rows[i] = (rows[i] & ~ghost[i]) | (reported[i] & ghost[i]);
+            reported[i] = rows[i];
+        }
+    }
+#endif
+}
+
+ISR(TIMER0_COMPA_vect)
+{
+    uint8_t row = scanRow;
+    uint8_t columns = ~PINB;
+
+    scan[scanBank][row] = columns;
+    *rowPins[row].ddr &= ~rowPins[row].mask;
+
+    if (++row == MATRIX_ROWS)
+    {
+        row = 0;
+        scanBank ^= 1;
+    }
+    scanRow = row;
+
+    *rowPins[row].ddr |= rowPins[row].mask;
+}
@@ -0,0 +1,61 @@
+/*
+  Pop'n Convertible Arcade Style Controller Project
+ 
+  Copyright 2011 Sam Wong (Sam /@/ hellosam /./ net)
+
+  This work is licensed under the Creative Commons Attribution 3.0 
+  Hong Kong License. 
+
+  To view a copy of this license, visit 
+  http://creativecommons.org/licenses/by/3.0/hk/ or send a letter to 
+  Creative Commons, 444 Castro Street, Suite 900, 
+  Mountain View, California, 94041, USA.  
+*/
+
+#ifndef _MATRIX_H_
+#define _MATRIX_H_
+
+#include <stdint.h>
+
+/** Row/column key matrix, scanned one row per Timer0 tick.
+ *
+ * Columns are PB0 to PB7 with pull-ups (active low). Rows are driven low
+ * one at a time and left floating otherwise, so two keys pressed in one
+ * column never short two driven rows together. Button n is row n / 8,
+ * column n % 8.
+ *
+ * Each tick is the same fixed work (~40 cycles): read the columns of the
+ * row driven on the previous tick, float that row, drive the next one.
+ * The row then has a whole tick to settle before it is read. With the
+ * default 100us tick an 8 row, 64 key matrix is fully scanned every 800us.
+ * A completed scan is published by flipping between two row buffers, so
+ * readers always see all rows from the same scan.
+ *
+ * Without diodes, three keys at the corners of a rectangle also make the
+ * fourth corner read as pressed. Matrix_Read() looks for two rows sharing
+ * two or more pressed columns and holds the previous state of the keys
+ * in those columns until the rectangle clears. Define MATRIX_DIODES when
+ * every key has a diode, which makes the matrix ghost free and skips the
+ * check.
+ */
+
+/// Number of rows, 1 to 8 (8 columns each)
+#ifndef MATRIX_ROWS
+#define MATRIX_ROWS 8
+#endif
+
+/// Row pins as { DDR register, bit mask }, in row order; their PORT bits must stay 0
+#ifndef MATRIX_ROW_PINS
+#define MATRIX_ROW_PINS { { &DDRC, _BV(2) }, { &DDRC, _BV(4) }, { &DDRC, _BV(5) }, { &DDRC, _BV(6) }, \
+                          { &DDRC, _BV(7) }, { &DDRD, _BV(0) }, { &DDRD, _BV(1) }, { &DDRD, _BV(5) } }
+#endif
+
+/// Time between row reads, in microseconds
+#ifndef MATRIX_TICK_US
+#define MATRIX_TICK_US 100
+#endif
+
+void Matrix_Init(void);
+void Matrix_Read(uint8_t* rows);
+
+#endif
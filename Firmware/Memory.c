@@ -0,0 +1,61 @@
+/*
+  Pop'n Convertible Arcade Style Controller Project
+ 
+  Copyright 2011 Sam Wong (Sam /@/ hellosam /./ net)
+
+  This work is licensed under the Creative Commons Attribution 3.0 
+  Hong Kong License. 
+
+  To view a copy of this license, visit 
+  http://creativecommons.org/licenses/by/3.0/hk/ or send a letter to 
+  Creative Commons, 444 Castro Street, Suite 900, 
+  Mountain View, California, 94041, USA.  
+*/
+
+#include "Memory.h"
+
+#include <avr/io.h>
+#include <string.h>
+
+/// End of .noinit, the last static section, from the linker script
+extern uint8_t __heap_start;
+
+void Memory_PaintStack(void) __attribute__((naked, used, section(".init3")));
+
+/** Paint from the end of the static data up to the stack pointer. In .init3 the stack
+ *  pointer and the zero register are set up, and nothing has been pushed yet. Naked,
+ *  as there is no caller to return to: the code falls through into .init4.
+ */
+void Memory_PaintStack(void)
+{
+    uint8_t* p = &__heap_start;
+
+    while (p <= (uint8_t*) SP)
+    {
+        *p++ = MEMORY_CANARY;
+    }
+}
+
+void Memory_GetUsage(MemoryUsage_t* usage)
+{
+    const uint8_t* p = &__heap_start;
+
+    // Stack use only ever overwrites the paint from the top down
+    while (p <= (const uint8_t*) RAMEND && *p == MEMORY_CANARY)
+    {
+        p++;
+    }
+
+    usage->RamSize        = RAMEND + 1 - RAMSTART;
+    usage->StaticSize     = (uint16_t) &__heap_start - RAMSTART;
+    usage->Headroom       = p - &__heap_start;
+    usage->StackHighWater = RAMEND + 1 - (uint16_t) p;
+}
+
+void Memory_CreateFeatureReport(uint8_t* data)
+{
+    MemoryUsage_t usage;
+
+    Memory_GetUsage(&usage);
+    memcpy(data, &usage, sizeof(usage));
+}
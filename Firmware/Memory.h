@@ -0,0 +1,56 @@
+/*
+  Pop'n Convertible Arcade Style Controller Project
+ 
+  Copyright 2011 Sam Wong (Sam /@/ hellosam /./ net)
+
+  This work is licensed under the Creative Commons Attribution 3.0 
+  Hong Kong License. 
+
+  To view a copy of this license, visit 
+  http://creativecommons.org/licenses/by/3.0/hk/ or send a letter to 
+  Creative Commons, 444 Castro Street, Suite 900, 
+  Mountain View, California, 94041, USA.  
+*/
+
+#ifndef _MEMORY_H_
+#define _MEMORY_H_
+
+#include <stdint.h>
+
+/** RAM accounting: static RAM and the stack high-water mark.
+ *
+ * Before main() the free RAM between the static data and the stack is
+ * painted with MEMORY_CANARY. The stack grows down into it and whatever
+ * it overwrites stays overwritten, so the canary bytes left at the bottom
+ * give the headroom that has never been touched since power-up, ISRs
+ * included. Run a session (play, reconfigure, suspend) before reading it.
+ *
+ * For the build-time side, `make ramreport` lists the static RAM of every
+ * symbol and the stack frame of every function, largest first.
+ *
+ * Feature report (HID_REPORTID_MEMORY, MEMORY_FEATURE_REPORT_SIZE bytes),
+ * all little endian, in bytes:
+ *  GET: Byte 0-1: SRAM size
+ *       Byte 2-3: Static RAM (.data, .bss and .noinit)
+ *       Byte 4-5: Deepest stack use since power-up
+ *       Byte 6-7: Painted bytes never touched (headroom)
+ */
+
+/// Feature report payload size, excluding the report ID
+#define MEMORY_FEATURE_REPORT_SIZE 32
+
+/// Paint value of free RAM; unlikely to be pushed on the stack as is
+#define MEMORY_CANARY 0xC5
+
+typedef struct
+{
+    uint16_t RamSize;
+    uint16_t StaticSize;
+    uint16_t StackHighWater;
+    uint16_t Headroom;
+} MemoryUsage_t;
+
+void Memory_GetUsage(MemoryUsage_t* usage);
+void Memory_CreateFeatureReport(uint8_t* data);
+
+#endif
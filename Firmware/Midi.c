@@ -0,0 +1,184 @@
+/*
+  Pop'n Convertible Arcade Style Controller Project
+ 
+  Copyright 2011 Sam Wong (Sam /@/ hellosam /./ net)
+
+  This work is licensed under the Creative Commons Attribution 3.0 
+  Hong Kong License. 
+
+  To view a copy of this license, visit 
+  http://creativecommons.org/licenses/by/3.0/hk/ or send a letter to 
+  Creative Commons, 444 Castro Street, Suite 900, 
+  Mountain View, California, 94041, USA.  
+*/
+
+#include "Midi.h"
+#include "Descriptors.h"
+#include "Remap.h"
+
+#include <LUFA/Drivers/USB/USB.h>
+#include <LUFA/Drivers/Misc/SPSCRingBuffer.h>
+
+#include <util/atomic.h>
+#include <string.h>
+
+/** LUFA MIDI Class driver interface configuration. Only its endpoint setup is used; events go
+ *  through Midi_USBTask().
+ */
+static USB_ClassInfo_MIDI_Device_t Midi_MIDI_Interface =
+    {
+        .Config =
+            {
+                .StreamingInterfaceNumber  = MIDI_AS_INTERFACE,
+
+                .DataINEndpointNumber      = MIDI_STREAM_IN_EPNUM,
+                .DataINEndpointSize        = MIDI_STREAM_IN_EPSIZE,
+                .DataINEndpointDoubleBank  = false,
+
+                .DataOUTEndpointNumber     = MIDI_STREAM_OUT_EPNUM,
+                .DataOUTEndpointSize       = MIDI_STREAM_OUT_EPSIZE,
+                .DataOUTEndpointDoubleBank = false,
+            },
+    };
+
+static uint8_t bufferData[MIDI_BUFFER_SIZE];
+static SPSCRingBuffer_t buffer = SPSC_RINGBUFFER_INITIALIZER(bufferData);
+
+/// Event counters; Dropped is written by the SOF handler, the rest by the task
+static volatile MidiCounters_t counters;
+
+void Midi_Init(void)
+{
+    SPSCRingBuffer_InitBuffer(&buffer, bufferData, MIDI_BUFFER_SIZE);
+}
+
+bool Midi_ConfigureEndpoints(void)
+{
+    return MIDI_Device_ConfigureEndpoints(&Midi_MIDI_Interface);
+}
+
+/** Note on velocity of a report bit */
+static uint8_t Midi_Velocity(uint8_t bit)
+{
+#if defined(HALL_INPUTS)
+    uint8_t input = Remap_FindInput(bit);
+    uint8_t sweeps;
+
+    if (input < HALL_CHANNEL_COUNT)
+    {
+        // Faster strokes are louder
+        sweeps = HallInputs_GetButton(input)->PressTime;
+        if (sweeps < (127 - 1) / MIDI_VELOCITY_PER_SWEEP)
+          return 127 - sweeps * MIDI_VELOCITY_PER_SWEEP;
+        return 1;
+    }
+#endif
+
+    return MIDI_STANDARD_VELOCITY;
+}
+
+/** Queue a note event per changed button. Called from the SOF handler only, the single producer. */
+void Midi_QueueEdges(ButtonBitmap_t state, ButtonBitmap_t change)
+{
+    const uint8_t* stateBits = (const uint8_t*) &state;
+    const uint8_t* changeBits = (const uint8_t*) &change;
+    uint8_t byte;
+    uint8_t mask;
+    uint8_t i;
+
+    for (i = 0, byte = 0; i < BUTTON_COUNT; byte++)
+    {
+        if (changeBits[byte] == 0)
+        {
+            i += 8;
+            continue;
+        }
+
+        for (mask = 1; mask && i < BUTTON_COUNT; mask <<= 1, i++)
+        {
+            if (!(changeBits[byte] & mask))
+              continue;
+
+            if (SPSCRingBuffer_GetFreeCount(&buffer) < sizeof(MIDI_EventPacket_t))
+            {
+                if (counters.Dropped != 0xFFFF)
+                  counters.Dropped++;
+                continue;
+            }
+
+            // USB-MIDI event packet: cable 0 and code index, then the MIDI message
+            if (stateBits[byte] & mask)
+            {
+                SPSCRingBuffer_Insert(&buffer, MIDI_COMMAND_NOTE_ON >> 4);
+                SPSCRingBuffer_Insert(&buffer, MIDI_COMMAND_NOTE_ON | MIDI_CHANNEL(MIDI_CHANNEL_NUMBER));
+                SPSCRingBuffer_Insert(&buffer, (MIDI_BASE_NOTE + i) & 0x7F);
+                SPSCRingBuffer_Insert(&buffer, Midi_Velocity(i));
+            } else {
+                SPSCRingBuffer_Insert(&buffer, MIDI_COMMAND_NOTE_OFF >> 4);
+                SPSCRingBuffer_Insert(&buffer, MIDI_COMMAND_NOTE_OFF | MIDI_CHANNEL(MIDI_CHANNEL_NUMBER));
+                SPSCRingBuffer_Insert(&buffer, (MIDI_BASE_NOTE + i) & 0x7F);
+                SPSCRingBuffer_Insert(&buffer, MIDI_STANDARD_VELOCITY);
+            }
+        }
+    }
+}
+
+void Midi_CreateFeatureReport(uint8_t* data)
+{
+    MidiCounters_t copy;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        copy = counters;
+    }
+
+    memcpy(data, &copy, sizeof(copy));
+}
+
+/** Send every queued event in one packet if the IN bank is free. Never waits. */
+void Midi_USBTask(void)
+{
+    uint8_t* span;
+    uint8_t length;
+    uint8_t count = 0;
+    uint8_t i;
+
+    if (USB_DeviceState != DEVICE_STATE_Configured)
+      return;
+
+    Endpoint_SelectEndpoint(MIDI_STREAM_OUT_EPNUM);
+    if (Endpoint_IsOUTReceived())
+      Endpoint_ClearOUT();
+
+    Endpoint_SelectEndpoint(MIDI_STREAM_IN_EPNUM);
+    if (!(Endpoint_IsINReady()))
+      return;
+
+    // Events are inserted whole, so spans always end on an event boundary
+    // and the packet size stays a multiple of 4
+    while (count < MIDI_STREAM_IN_EPSIZE && (length = SPSCRingBuffer_GetReadSpan(&buffer, &span)) != 0)
+    {
+        if (length > MIDI_STREAM_IN_EPSIZE - count)
+          length = MIDI_STREAM_IN_EPSIZE - count;
+
+        for (i = 0; i < length; i++)
+        {
+            Endpoint_Write_8(span[i]);
+        }
+
+        // Free the bytes only once they are in the bank
+        SPSCRingBuffer_CommitRead(&buffer, length);
+        count += length;
+    }
+
+    // A full packet is fine without a ZLP: USB-MIDI has no transfer framing
+    if (count)
+    {
+        Endpoint_ClearIN();
+
+        count /= sizeof(MIDI_EventPacket_t);
+        counters.Events += count;
+        if (count > counters.MaxPerPacket)
+          counters.MaxPerPacket = count;
+    }
+}
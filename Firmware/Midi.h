@@ -0,0 +1,84 @@
+/*
+  Pop'n Convertible Arcade Style Controller Project
+ 
+  Copyright 2011 Sam Wong (Sam /@/ hellosam /./ net)
+
+  This work is licensed under the Creative Commons Attribution 3.0 
+  Hong Kong License. 
+
+  To view a copy of this license, visit 
+  http://creativecommons.org/licenses/by/3.0/hk/ or send a letter to 
+  Creative Commons, 444 Castro Street, Suite 900, 
+  Mountain View, California, 94041, USA.  
+*/
+
+#ifndef _MIDI_H_
+#define _MIDI_H_
+
+#include "PopnAsc.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/** USB-MIDI output, next to the HID interface in a composite device.
+ *
+ * With CONFIG_REPORT_MODE_MIDI selected, debounced button edges become
+ * note on and note off events (button n plays MIDI_BASE_NOTE + n) and the
+ * keyboard report stays idle. Midi_QueueEdges() turns the edges of a
+ * frame into 4-byte event packets in a ring buffer from the SOF handler,
+ * and Midi_USBTask() moves everything queued into the IN bank and sends
+ * it as one bulk packet. MIDI_Device_SendEventPacket() would instead
+ * stream and flush each event on its own, waiting for the host every
+ * time; here nothing waits, and events stay queued while the bank is
+ * busy. Events that do not fit the ring are dropped and counted.
+ *
+ * Velocity comes from the press timing when the inputs measure it (hall
+ * effect buttons: the time from the top of the stroke to actuation),
+ * otherwise it is MIDI_STANDARD_VELOCITY.
+ *
+ * Anything the host sends is discarded.
+ *
+ * Feature report (HID_REPORTID_MIDI, MIDI_FEATURE_REPORT_SIZE bytes):
+ *  GET: Byte 0-1: Events sent (wrapping)
+ *       Byte 2-3: Events dropped because the ring was full (saturating)
+ *       Byte 4:   Most events sent in one packet
+ */
+
+/// MIDI channel of the note events, 1 to 16
+#ifndef MIDI_CHANNEL_NUMBER
+#define MIDI_CHANNEL_NUMBER 10
+#endif
+
+/// Note played by button 0
+#ifndef MIDI_BASE_NOTE
+#define MIDI_BASE_NOTE 36
+#endif
+
+/// Ring buffer size in bytes (4 per event); a power of two up to 128
+#ifndef MIDI_BUFFER_SIZE
+#define MIDI_BUFFER_SIZE 64
+#endif
+
+/// Velocity lost per ADC sweep (~470us) of travel before actuation
+#define MIDI_VELOCITY_PER_SWEEP 2
+
+/// Feature report payload size, excluding the report ID
+#define MIDI_FEATURE_REPORT_SIZE 32
+
+typedef struct
+{
+    /// Events sent, wrapping
+    uint16_t Events;
+    /// Events dropped because the ring was full, saturating
+    uint16_t Dropped;
+    /// Most events sent in one packet
+    uint8_t MaxPerPacket;
+} MidiCounters_t;
+
+void Midi_Init(void);
+bool Midi_ConfigureEndpoints(void);
+void Midi_USBTask(void);
+void Midi_QueueEdges(ButtonBitmap_t state, ButtonBitmap_t change);
+void Midi_CreateFeatureReport(uint8_t* data);
+
+#endif
@@ -0,0 +1,303 @@
+/*
+  Pop'n Convertible Arcade Style Controller Project
+ 
+  Copyright 2011 Sam Wong (Sam /@/ hellosam /./ net)
+
+  This work is licensed under the Creative Commons Attribution 3.0 
+  Hong Kong License. 
+
+  To view a copy of this license, visit 
+  http://creativecommons.org/licenses/by/3.0/hk/ or send a letter to 
+  Creative Commons, 444 Castro Street, Suite 900, 
+  Mountain View, California, 94041, USA.  
+*/
+
+#include "Network.h"
+#include "Descriptors.h"
+#include "Telemetry.h"
+
+#include <LUFA/Drivers/USB/USB.h>
+#include <LUFA/Drivers/Misc/SPSCRingBuffer.h>
+
+#include <avr/pgmspace.h>
+#include <string.h>
+
+/// Ethernet, IPv4 and UDP headers in front of each payload
+#define NETWORK_HEADER_SIZE (14 + 20 + 8)
+
+/// Largest segment Network_USBTask() builds at once: the RNDIS packet message header, of 11 32-bit fields
+#define NETWORK_SEGMENT_SIZE 44
+
+#if NETWORK_HEADER_SIZE > NETWORK_SEGMENT_SIZE || TELEMETRY_MAX_PAYLOAD + 4 > NETWORK_SEGMENT_SIZE
+#error Network_USBTask() builds segments in a buffer of NETWORK_SEGMENT_SIZE; a header or telemetry frame outgrew it.
+#endif
+
+/// Source MAC of the datagrams, locally administered
+#define NETWORK_DEVICE_MAC 0x02, 0x00, 0x50, 0x4F, 0x4E, 0x02
+
+/// Parts of each packet of a transfer, in the order they are written
+enum
+{
+    SEGMENT_RNDIS_HEADER,
+    SEGMENT_UDP_HEADER,
+    SEGMENT_PAYLOAD,
+    SEGMENT_END
+};
+
+/** LUFA RNDIS Class driver interface configuration and state information. Its control message
+ *  handling and endpoint setup are used; data goes through Network_USBTask().
+ */
+static USB_ClassInfo_RNDIS_Device_t Network_RNDIS_Interface =
+    {
+        .Config =
+            {
+                .ControlInterfaceNumber         = NETWORK_CCI_INTERFACE,
+
+                .DataINEndpointNumber           = NETWORK_TX_EPNUM,
+                .DataINEndpointSize             = NETWORK_TXRX_EPSIZE,
+                .DataINEndpointDoubleBank       = false,
+
+                .DataOUTEndpointNumber          = NETWORK_RX_EPNUM,
+                .DataOUTEndpointSize            = NETWORK_TXRX_EPSIZE,
+                .DataOUTEndpointDoubleBank      = false,
+
+                .NotificationEndpointNumber     = NETWORK_NOTIFICATION_EPNUM,
+                .NotificationEndpointSize       = NETWORK_NOTIFICATION_EPSIZE,
+                .NotificationEndpointDoubleBank = false,
+
+                .AdapterVendorDescription       = "PopnAsc",
+                .AdapterMACAddress              = {{0x02, 0x00, 0x50, 0x4F, 0x4E, 0x01}},
+            },
+    };
+
+/// Ethernet, IPv4 and UDP headers, completed per datagram by Network_CreateHeaders()
+static const uint8_t PROGMEM headerTemplate[NETWORK_HEADER_SIZE] =
+{
+    // Ethernet: broadcast destination, device source, IPv4
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, NETWORK_DEVICE_MAC, 0x08, 0x00,
+    // IPv4: 20 byte header, total length, ID, not fragmented, TTL 64, UDP,
+    // checksum, device source, broadcast destination
+    0x45, 0x00, 0, 0, 0, 0, 0x00, 0x00, 64, 17, 0, 0,
+    NETWORK_DEVICE_IP, 255, 255, 255, 255,
+    // UDP: ports, length, no checksum
+    NETWORK_UDP_PORT >> 8, NETWORK_UDP_PORT & 0xFF, NETWORK_UDP_PORT >> 8, NETWORK_UDP_PORT & 0xFF, 0, 0, 0, 0
+};
+
+static uint8_t bufferData[NETWORK_BUFFER_SIZE];
+static SPSCRingBuffer_t buffer = SPSC_RINGBUFFER_INITIALIZER(bufferData);
+
+/// Transfer in progress: its packet count (0 if none), and where writing is up to
+static uint8_t transferPackets;
+static uint8_t packetIndex;
+static uint8_t segment;
+static uint16_t bytesProcessed;
+/// Queue offset of the frame of the current packet
+static uint8_t payloadOffset;
+/// IPv4 ID of the first datagram of the transfer
+static uint16_t datagramId;
+
+void Network_Init(void)
+{
+    SPSCRingBuffer_InitBuffer(&buffer, bufferData, NETWORK_BUFFER_SIZE);
+}
+
+/** Forget the transfer in progress; its frames stay queued and go in the next one */
+static void Network_ResetTransfer(void)
+{
+    transferPackets = 0;
+    packetIndex = 0;
+    segment = SEGMENT_RNDIS_HEADER;
+    bytesProcessed = 0;
+    payloadOffset = 0;
+}
+
+bool Network_ConfigureEndpoints(void)
+{
+    Network_ResetTransfer();
+    return RNDIS_Device_ConfigureEndpoints(&Network_RNDIS_Interface);
+}
+
+void Network_ProcessControlRequest(void)
+{
+    RNDIS_Device_ProcessControlRequest(&Network_RNDIS_Interface);
+}
+
+/** Queue one whole telemetry frame, or drop it if it does not fit. SOF event only. */
+bool Network_QueueFrame(const uint8_t* frame, uint8_t length)
+{
+    if (SPSCRingBuffer_GetFreeCount(&buffer) < length)
+      return false;
+
+    while (length--)
+    {
+        SPSCRingBuffer_Insert(&buffer, *frame++);
+    }
+
+    return true;
+}
+
+/** Queued byte at the given offset from the oldest one */
+static uint8_t Network_PeekAt(uint8_t offset)
+{
+    return buffer.Data[(uint8_t) (buffer.Out + offset) & buffer.Mask];
+}
+
+/** Length of the whole frame at the given queue offset */
+static uint8_t Network_FrameLength(uint8_t offset)
+{
+    return Network_PeekAt(offset + 2) + 4;
+}
+
+/** IPv4 header checksum */
+static uint16_t Network_Checksum(const uint8_t* data, uint8_t length)
+{
+    uint32_t sum = 0;
+    uint8_t i;
+
+    for (i = 0; i < length; i += 2)
+    {
+        sum += ((uint16_t) data[i] << 8) | data[i + 1];
+    }
+
+    while (sum >> 16)
+    {
+        sum = (sum & 0xFFFF) + (sum >> 16);
+    }
+
+    return ~sum;
+}
+
+/** Build the Ethernet, IPv4 and UDP headers of a datagram */
+static void Network_CreateHeaders(uint8_t* data, uint8_t payloadLength, uint16_t id)
+{
+    uint16_t ipLength = 20 + 8 + payloadLength;
+    uint16_t checksum;
+
+    memcpy_P(data, headerTemplate, NETWORK_HEADER_SIZE);
+
+    data[16] = ipLength >> 8;
+    data[17] = ipLength & 0xFF;
+    data[18] = id >> 8;
+    data[19] = id & 0xFF;
+    checksum = Network_Checksum(&data[14], 20);
+    data[24] = checksum >> 8;
+    data[25] = checksum & 0xFF;
+
+    data[38] = (8 + payloadLength) >> 8;
+    data[39] = (8 + payloadLength) & 0xFF;
+}
+
+/** Take as many whole queued frames as fit one transfer */
+static bool Network_StartTransfer(void)
+{
+    uint8_t count = SPSCRingBuffer_GetCount(&buffer);
+    uint8_t offset = 0;
+    uint16_t size = 0;
+
+    Network_ResetTransfer();
+
+    while (offset < count && transferPackets < NETWORK_BATCH_PACKETS)
+    {
+        uint8_t length = Network_FrameLength(offset);
+
+        if ((uint8_t) (count - offset) < length)
+          break;
+
+        size += sizeof(RNDIS_Packet_Message_t) + NETWORK_HEADER_SIZE + length;
+        if (size > Network_RNDIS_Interface.State.HostMaxTransferSize)
+          break;
+
+        offset += length;
+        transferPackets++;
+    }
+
+    return (transferPackets != 0);
+}
+
+/** Write as much of a transfer as the IN bank takes, starting one if frames are queued. Never waits. */
+void Network_USBTask(void)
+{
+    uint8_t data[NETWORK_SEGMENT_SIZE];
+    uint8_t frameLength;
+    uint8_t length;
+    uint8_t error;
+    uint8_t i;
+
+    if (USB_DeviceState != DEVICE_STATE_Configured)
+      return;
+
+    RNDIS_Device_USBTask(&Network_RNDIS_Interface);
+
+    // Nothing the host sends is used
+    Endpoint_SelectEndpoint(NETWORK_RX_EPNUM);
+    if (Endpoint_IsOUTReceived())
+      Endpoint_ClearOUT();
+
+    if (transferPackets == 0)
+    {
+        if (!RNDIS_Device_IsReadyToSend(&Network_RNDIS_Interface) || !Network_StartTransfer())
+          return;
+    }
+
+    for (;;)
+    {
+        if (segment == SEGMENT_END)
+        {
+            error = RNDIS_Device_EndTransfer(&Network_RNDIS_Interface);
+            if (error == ENDPOINT_RWSTREAM_IncompleteTransfer)
+              return;
+
+            if (error == ENDPOINT_RWSTREAM_NoError)
+            {
+                SPSCRingBuffer_CommitRead(&buffer, payloadOffset);
+                datagramId += transferPackets;
+            }
+
+            Network_ResetTransfer();
+            return;
+        }
+
+        // The segment is rebuilt on every call, and written from where the last call stopped
+        frameLength = Network_FrameLength(payloadOffset);
+
+        switch (segment)
+        {
+            case SEGMENT_RNDIS_HEADER:
+                RNDIS_Device_CreatePacketHeader((RNDIS_Packet_Message_t*) data, NETWORK_HEADER_SIZE + frameLength);
+                length = sizeof(RNDIS_Packet_Message_t);
+                break;
+            case SEGMENT_UDP_HEADER:
+                Network_CreateHeaders(data, frameLength, datagramId + packetIndex);
+                length = NETWORK_HEADER_SIZE;
+                break;
+            default:
+                for (i = 0; i < frameLength; i++)
+                {
+                    data[i] = Network_PeekAt(payloadOffset + i);
+                }
+                length = frameLength;
+                break;
+        }
+
+        error = RNDIS_Device_WriteTransfer(&Network_RNDIS_Interface, data, length, &bytesProcessed);
+        if (error == ENDPOINT_RWSTREAM_IncompleteTransfer)
+          return;
+
+        if (error != ENDPOINT_RWSTREAM_NoError)
+        {
+            // The host halted or reset the adapter; drop the part written
+            if (USB_DeviceState == DEVICE_STATE_Configured)
+              Endpoint_ResetEndpoint(NETWORK_TX_EPNUM);
+            Network_ResetTransfer();
+            return;
+        }
+
+        bytesProcessed = 0;
+        if (++segment == SEGMENT_END)
+        {
+            payloadOffset += frameLength;
+            if (++packetIndex < transferPackets)
+              segment = SEGMENT_RNDIS_HEADER;
+        }
+    }
+}
@@ -0,0 +1,70 @@
+/*
+  Pop'n Convertible Arcade Style Controller Project
+ 
+  Copyright 2011 Sam Wong (Sam /@/ hellosam /./ net)
+
+  This work is licensed under the Creative Commons Attribution 3.0 
+  Hong Kong License. 
+
+  To view a copy of this license, visit 
+  http://creativecommons.org/licenses/by/3.0/hk/ or send a letter to 
+  Creative Commons, 444 Castro Street, Suite 900, 
+  Mountain View, California, 94041, USA.  
+*/
+
+#ifndef _NETWORK_H_
+#define _NETWORK_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/** Telemetry over Ethernet-over-USB (RNDIS), next to the HID interface.
+ *
+ * Each telemetry frame (see Telemetry.h) is sent unchanged as the payload
+ * of one UDP datagram, broadcast from NETWORK_DEVICE_IP to port
+ * NETWORK_UDP_PORT. Frames are queued from the SOF event and sent by
+ * Network_USBTask() from the report task; the frames queued while one
+ * transfer is in flight all go in the next one, as back to back RNDIS
+ * packet messages (up to NETWORK_BATCH_PACKETS and the host's maximum
+ * transfer size). Nothing waits for the host: a transfer is written a
+ * bank at a time as the host takes them, headers are rebuilt for the bank
+ * being written instead of buffered, and frames that do not fit the queue
+ * are dropped whole and counted with the UART drops.
+ *
+ * On a Linux host the interface comes up under rndis_host. It only needs
+ * a link-local address to receive the broadcasts, e.g.
+ *     ip addr add 169.254.80.1/16 dev usb0 && ip link set usb0 up
+ * then Tools/telemetry_udp.py decodes the stream and prints its rate.
+ * Anything the host sends (ARP, DHCP, neighbour discovery) is discarded.
+ *
+ * The RNDIS class driver keeps about 140 bytes of state, on top of the
+ * queue; check the headroom with the memory feature report (Memory.h).
+ */
+
+/// Queue size; a power of two up to 128
+#ifndef NETWORK_BUFFER_SIZE
+#define NETWORK_BUFFER_SIZE 64
+#endif
+
+/// Most datagrams in one RNDIS transfer
+#ifndef NETWORK_BATCH_PACKETS
+#define NETWORK_BATCH_PACKETS 8
+#endif
+
+/// UDP port the datagrams are broadcast to, and sent from
+#ifndef NETWORK_UDP_PORT
+#define NETWORK_UDP_PORT 5005
+#endif
+
+/// Source IPv4 address as four comma separated bytes; link-local, so the host needs no route to it
+#ifndef NETWORK_DEVICE_IP
+#define NETWORK_DEVICE_IP 169, 254, 80, 2
+#endif
+
+void Network_Init(void);
+bool Network_ConfigureEndpoints(void);
+void Network_ProcessControlRequest(void);
+void Network_USBTask(void);
+bool Network_QueueFrame(const uint8_t* frame, uint8_t length);
+
+#endif
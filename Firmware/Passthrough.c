@@ -0,0 +1,225 @@
+/*
+  Pop'n Convertible Arcade Style Controller Project
+ 
+  Copyright 2011 Sam Wong (Sam /@/ hellosam /./ net)
+
+  This work is licensed under the Creative Commons Attribution 3.0 
+  Hong Kong License. 
+
+  To view a copy of this license, visit 
+  http://creativecommons.org/licenses/by/3.0/hk/ or send a letter to 
+  Creative Commons, 444 Castro Street, Suite 900, 
+  Mountain View, California, 94041, USA.  
+*/
+
+#include "Passthrough.h"
+
+#include <LUFA/Drivers/Peripheral/SerialBuffered.h>
+
+#include <util/atomic.h>
+#include <util/crc16.h>
+#include <stdbool.h>
+#include <string.h>
+
+#if PASSTHROUGH_TIMEOUT_MS < 1 || PASSTHROUGH_TIMEOUT_MS > 255
+#error PASSTHROUGH_TIMEOUT_MS must be 1 to 255.
+#endif
+
+/// Microseconds per USB frame, the scan's period
+#define PASSTHROUGH_FRAME_US 1000UL
+
+/// Microseconds a state frame takes on the wire (10 bits per byte)
+#define PASSTHROUGH_LINK_US ((PASSTHROUGH_FRAME_SIZE * 10UL * 1000000UL) / TELEMETRY_BAUD)
+
+/// Parser states, by the next byte expected
+enum
+{
+    PARSE_SYNC,
+    PARSE_TYPE,
+    PARSE_LENGTH,
+    PARSE_PAYLOAD,
+    PARSE_CRC
+};
+
+/// Frame parser, main loop only
+static uint8_t parseState;
+static uint8_t parseIndex;
+static uint8_t parseCrc;
+static uint8_t parseType;
+static bool parseValid;
+static uint8_t payload[PASSTHROUGH_PAYLOAD_SIZE];
+
+/// Latest valid frame, written by the main loop and taken by the scan
+static volatile bool pending;
+static uint16_t pendingSequence;
+static uint16_t pendingAge;
+static uint32_t pendingState;
+static uint8_t pendingScan;
+
+/// Scans so far, counted by the scan; Timer 1 is not for ISRs
+static volatile uint8_t scans;
+
+/// Scan side state, SOF event only
+static uint32_t currentState;
+static uint16_t lastSequence;
+static uint8_t silentFrames;
+
+static PassthroughStats_t stats;
+
+/** Start the UART receiver; the bridge is assumed absent until it sends */
+void Passthrough_Init(void)
+{
+    SerialBuffered_Init(TELEMETRY_BAUD, true);
+    parseState = PARSE_SYNC;
+    silentFrames = PASSTHROUGH_TIMEOUT_MS;
+}
+
+/** Keep the slowest of the samples in a stats field */
+static inline void UpdateMax(uint16_t* max, uint16_t value)
+{
+    if (value > *max)
+      *max = value;
+}
+
+/** Hand a complete, valid frame to the scan */
+static void Passthrough_Accept(void)
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        pendingSequence = payload[0] | ((uint16_t) payload[1] << 8);
+        pendingAge = payload[2] | ((uint16_t) payload[3] << 8);
+        memcpy(&pendingState, &payload[4], sizeof(pendingState));
+        pendingScan = scans;
+        pending = true;
+    }
+}
+
+/** Parse whatever the UART has received; called from the main loop */
+void Passthrough_Task(void)
+{
+    int16_t received;
+
+    while ((received = SerialBuffered_ReceiveByte()) >= 0)
+    {
+        uint8_t data = (uint8_t) received;
+
+        switch (parseState)
+        {
+            case PARSE_SYNC:
+                // Anything else is noise, or a frame joined halfway
+                if (data == TELEMETRY_SYNC)
+                {
+                    parseCrc = 0;
+                    parseState = PARSE_TYPE;
+                }
+                continue;
+            case PARSE_TYPE:
+                parseType = data;
+                parseState = PARSE_LENGTH;
+                break;
+            case PARSE_LENGTH:
+                // A length that cannot be ours may still be a frame to skip
+                if (data > TELEMETRY_MAX_PAYLOAD)
+                {
+                    stats.BadFrames++;
+                    parseState = PARSE_SYNC;
+                    continue;
+                }
+                parseValid = (parseType == PASSTHROUGH_FRAME_STATE && data == PASSTHROUGH_PAYLOAD_SIZE);
+                parseIndex = data;
+                parseState = (data != 0) ? PARSE_PAYLOAD : PARSE_CRC;
+                break;
+            case PARSE_PAYLOAD:
+                if (parseValid)
+                  payload[PASSTHROUGH_PAYLOAD_SIZE - parseIndex] = data;
+                if (--parseIndex == 0)
+                  parseState = PARSE_CRC;
+                break;
+            case PARSE_CRC:
+                // Frames of other types are not for us, and not errors
+                if (data != parseCrc || (!parseValid && parseType == PASSTHROUGH_FRAME_STATE))
+                  stats.BadFrames++;
+                else if (parseValid)
+                  Passthrough_Accept();
+                parseState = PARSE_SYNC;
+                continue;
+        }
+
+        parseCrc = _crc_ibutton_update(parseCrc, data);
+    }
+}
+
+/** [Bitmap] Latest bridged state (active high), from the SOF event */
+uint32_t Passthrough_GetState(void)
+{
+    uint16_t sequence;
+    uint16_t age;
+    uint32_t wait;
+    uint32_t latency;
+
+    scans++;
+
+    if (!pending)
+    {
+        if (silentFrames < PASSTHROUGH_TIMEOUT_MS)
+        {
+            if (++silentFrames == PASSTHROUGH_TIMEOUT_MS)
+            {
+                currentState = 0;
+                stats.Timeouts++;
+            }
+        }
+        return currentState;
+    }
+
+    // Interrupts are off in the SOF event, so the frame can't change under us
+    pending = false;
+    sequence = pendingSequence;
+    age = pendingAge;
+    currentState = pendingState;
+    // In whole frames, the one the state arrived in included: an upper bound
+    wait = (uint32_t) (uint8_t) (scans - pendingScan) * PASSTHROUGH_FRAME_US;
+    if (wait > 0xFFFF)
+      wait = 0xFFFF;
+    silentFrames = 0;
+
+    // A repeat of the last report while the pad is idle, not a new one
+    if (sequence == lastSequence && stats.Frames != 0)
+      return currentState;
+
+    if (stats.Frames != 0)
+      stats.Lost += (uint16_t) (sequence - lastSequence - 1);
+    lastSequence = sequence;
+    stats.Frames++;
+
+    latency = age + PASSTHROUGH_LINK_US + wait;
+    if (latency > 0xFFFF)
+      latency = 0xFFFF;
+
+    stats.LastAge = age;
+    stats.LastWait = (uint16_t) wait;
+    stats.LastLatency = (uint16_t) latency;
+    UpdateMax(&stats.MaxAge, age);
+    UpdateMax(&stats.MaxWait, (uint16_t) wait);
+    UpdateMax(&stats.MaxLatency, (uint16_t) latency);
+
+    return currentState;
+}
+
+/** Fill the passthrough statistics feature report */
+void Passthrough_CreateFeatureReport(uint8_t* data)
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        memcpy(data, &stats, sizeof(stats));
+    }
+}
+
+/** Any SET of the passthrough feature report clears the statistics */
+void Passthrough_ProcessFeatureReport(const uint8_t* data, uint16_t size)
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        memset(&stats, 0, sizeof(stats));
+    }
+}
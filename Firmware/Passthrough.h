@@ -0,0 +1,102 @@
+/*
+  Pop'n Convertible Arcade Style Controller Project
+ 
+  Copyright 2011 Sam Wong (Sam /@/ hellosam /./ net)
+
+  This work is licensed under the Creative Commons Attribution 3.0 
+  Hong Kong License. 
+
+  To view a copy of this license, visit 
+  http://creativecommons.org/licenses/by/3.0/hk/ or send a letter to 
+  Creative Commons, 444 Castro Street, Suite 900, 
+  Mountain View, California, 94041, USA.  
+*/
+
+#ifndef _PASSTHROUGH_H_
+#define _PASSTHROUGH_H_
+
+#include "Telemetry.h"
+
+#include <stdint.h>
+
+/** Passthrough inputs: re-emit a pad attached to an external USB host.
+ *
+ * The AT90USB162 has no host mode, so the pad is read by a bridge: any
+ * USB host capable MCU that polls the pad's interrupt IN pipe, maps its
+ * fields to button bits and sends the bitmap to RXD1 as a frame in the
+ * telemetry format (see Telemetry.h), at TELEMETRY_BAUD:
+ *
+ * Byte 0:      TELEMETRY_SYNC
+ * Byte 1:      PASSTHROUGH_FRAME_STATE
+ * Byte 2:      PASSTHROUGH_PAYLOAD_SIZE
+ * Byte 3-4:    Sequence, incremented once per report read from the pad
+ * Byte 5-6:    Age: microseconds from the pad's report reaching the
+ *              bridge to the SYNC byte of this frame leaving it
+ * Byte 7-10:   [Bitmap] Button state (active high), input n at bit n
+ * Byte 11:     CRC-8 (_crc_ibutton_update) of bytes 1 to 10
+ *
+ * The bridge sends a frame for every report the pad sends, and repeats
+ * the last one (same sequence) at least every PASSTHROUGH_TIMEOUT_MS / 2
+ * while the pad is idle. Without a valid frame for PASSTHROUGH_TIMEOUT_MS
+ * all buttons are released, so an unplugged bridge does not hold keys.
+ *
+ * Frames are parsed from the main loop as soon as their last byte is in,
+ * and the SOF scan takes the latest one, so a report leaves on the next
+ * frame after the bridge's. Each new sequence is timed as age + time on
+ * the wire + time waiting for the scan; the host's poll of the IN
+ * endpoint adds up to one more frame, which is out of the device's view.
+ * The wait is counted in scans, so the frame a state arrives in counts
+ * whole: a bound on the wait to the frame, not a measure within it.
+ *
+ * Feature report (HID_REPORTID_PASSTHROUGH, PASSTHROUGH_FEATURE_REPORT_SIZE
+ * bytes): GET returns PassthroughStats_t, little endian. Any SET clears it.
+ */
+
+/// Frame type of a bridge state frame, bridge to device
+#define PASSTHROUGH_FRAME_STATE 0x10
+
+/// Payload size of PASSTHROUGH_FRAME_STATE
+#define PASSTHROUGH_PAYLOAD_SIZE 8
+
+/// Size of a whole state frame on the wire
+#define PASSTHROUGH_FRAME_SIZE (PASSTHROUGH_PAYLOAD_SIZE + 4)
+
+/// Number of inputs carried in a state frame
+#define PASSTHROUGH_BUTTON_COUNT 32
+
+/// Milliseconds without a valid frame before all buttons are released
+#ifndef PASSTHROUGH_TIMEOUT_MS
+#define PASSTHROUGH_TIMEOUT_MS 50
+#endif
+
+/// Feature report payload size, excluding the report ID
+#define PASSTHROUGH_FEATURE_REPORT_SIZE 32
+
+typedef struct
+{
+    /// New states taken by the scan
+    uint16_t Frames;
+    /// Frames with a bad CRC or length (read from the main loop); other frame types are skipped
+    uint16_t BadFrames;
+    /// Sequence numbers skipped: states the scan never saw
+    uint16_t Lost;
+    /// Times the bridge went silent for PASSTHROUGH_TIMEOUT_MS
+    uint16_t Timeouts;
+    /// Age reported by the bridge, in microseconds
+    uint16_t LastAge;
+    uint16_t MaxAge;
+    /// Frame received to SOF scan, in microseconds, rounded up to whole USB frames
+    uint16_t LastWait;
+    uint16_t MaxWait;
+    /// Pad report at the bridge to SOF scan, in microseconds
+    uint16_t LastLatency;
+    uint16_t MaxLatency;
+} PassthroughStats_t;
+
+void Passthrough_Init(void);
+void Passthrough_Task(void);
+uint32_t Passthrough_GetState(void);
+void Passthrough_CreateFeatureReport(uint8_t* data);
+void Passthrough_ProcessFeatureReport(const uint8_t* data, uint16_t size);
+
+#endif
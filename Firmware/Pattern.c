@@ -0,0 +1,97 @@
+/*
+  Pop'n Convertible Arcade Style Controller Project
+ 
+  Copyright 2011 Sam Wong (Sam /@/ hellosam /./ net)
+
+  This work is licensed under the Creative Commons Attribution 3.0 
+  Hong Kong License. 
+
+  To view a copy of this license, visit 
+  http://creativecommons.org/licenses/by/3.0/hk/ or send a letter to 
+  Creative Commons, 444 Castro Street, Suite 900, 
+  Mountain View, California, 94041, USA.  
+*/
+
+#include "Pattern.h"
+#include "Config.h"
+
+#include <LUFA/Common/Common.h>
+
+#include <avr/pgmspace.h>
+
+/// Steps of each pattern, as pressed report bits; 0 is all keys up
+static const uint16_t PROGMEM holdSteps[] = { 0xFFFF };
+static const uint16_t PROGMEM chordSteps[] = { 0x015, 0, 0x00A, 0, 0x0A0, 0, 0x140, 0, 0x1FF, 0 };
+static const uint16_t PROGMEM trillSteps[] = { 0x008, 0x020 };
+static const uint16_t PROGMEM jackSteps[] = { 0x010, 0 };
+static const uint16_t PROGMEM streamSteps[] =
+{
+    0x001, 0, 0x002, 0, 0x004, 0, 0x008, 0, 0x010, 0, 0x020, 0, 0x040, 0, 0x080, 0,
+    0x100, 0, 0x080, 0, 0x040, 0, 0x020, 0, 0x010, 0, 0x008, 0, 0x004, 0, 0x002, 0
+};
+
+typedef struct
+{
+    const uint16_t* Steps;
+    uint8_t Count;
+} PatternInfo_t;
+
+static const PatternInfo_t PROGMEM patterns[PATTERN_COUNT] =
+{
+    [PATTERN_HOLD]   = { holdSteps,   sizeof(holdSteps) / sizeof(uint16_t) },
+    [PATTERN_CHORDS] = { chordSteps,  sizeof(chordSteps) / sizeof(uint16_t) },
+    [PATTERN_TRILL]  = { trillSteps,  sizeof(trillSteps) / sizeof(uint16_t) },
+    [PATTERN_JACK]   = { jackSteps,   sizeof(jackSteps) / sizeof(uint16_t) },
+    [PATTERN_STREAM] = { streamSteps, sizeof(streamSteps) / sizeof(uint16_t) },
+};
+
+/// Selected pattern, written from the control request and read by the scan
+static volatile uint8_t selected = PATTERN_HOLD;
+static volatile uint8_t stepTime = PATTERN_DEFAULT_STEP_TIME;
+
+/// Playback position, scan only
+static uint8_t step;
+static uint8_t elapsed;
+
+/** Select the pattern and step time (1 to 255 ms); returns a CONFIG_STATUS_* */
+uint8_t Pattern_Select(uint8_t pattern, uint8_t time)
+{
+    if (pattern >= PATTERN_COUNT || time == 0)
+      return CONFIG_STATUS_BAD_VALUE;
+
+    selected = pattern;
+    stepTime = time;
+
+    return CONFIG_STATUS_OK;
+}
+
+/** Start from the first step at the next Pattern_Next() */
+void Pattern_Restart(void)
+{
+    step = 0;
+    elapsed = 0;
+}
+
+/** [Bitmap] Report bits pressed in this millisecond; call once per scan */
+uint16_t Pattern_Next(void)
+{
+    const PatternInfo_t* info = &patterns[selected];
+    const uint16_t* steps = pgm_read_ptr(&info->Steps);
+    uint8_t count = pgm_read_byte(&info->Count);
+    uint16_t state;
+
+    // A pattern selected mid-play may be shorter than the last one
+    if (step >= count)
+      step = 0;
+
+    state = pgm_read_word(&steps[step]);
+
+    if (++elapsed >= stepTime)
+    {
+        elapsed = 0;
+        if (++step >= count)
+          step = 0;
+    }
+
+    return state;
+}
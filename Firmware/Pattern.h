@@ -0,0 +1,64 @@
+/*
+  Pop'n Convertible Arcade Style Controller Project
+ 
+  Copyright 2011 Sam Wong (Sam /@/ hellosam /./ net)
+
+  This work is licensed under the Creative Commons Attribution 3.0 
+  Hong Kong License. 
+
+  To view a copy of this license, visit 
+  http://creativecommons.org/licenses/by/3.0/hk/ or send a letter to 
+  Creative Commons, 444 Castro Street, Suite 900, 
+  Mountain View, California, 94041, USA.  
+*/
+
+#ifndef _PATTERN_H_
+#define _PATTERN_H_
+
+#include <stdint.h>
+
+/** Synthetic button patterns, played while the board's debug button is held.
+ *
+ * Each pattern is a loop of steps, each a set of pressed report bits held
+ * for the step time. The steps replace the scanned inputs ahead of the
+ * debounce stage, so they go through the same debounce, statistics,
+ * telemetry and report path as real presses. Presses closer together
+ * than the debounce times are merged by design, exactly as they would be
+ * from the buttons.
+ *
+ * To load test a host, play a pattern for a while and compare the key
+ * events the host saw with the press counts of the statistics feature
+ * report (Stats.h), which counts what the device reported.
+ *
+ * The pattern is selected with CONFIG_COMMAND_PATTERN (see Config.h) and
+ * is not saved; at power-up it is PATTERN_HOLD, all keys down, as the
+ * debug button always did. A pattern restarts each time the button is
+ * pressed. For a note pattern (a press step then a release step), one
+ * note lasts two steps, so 16th notes at B BPM need a step time of
+ * 7500 / B ms: 37ms at 200 BPM, 25ms at 300 BPM.
+ */
+
+/// Patterns
+enum
+{
+    /// All keys down for as long as the button is held
+    PATTERN_HOLD,
+    /// Three, two and nine key chords, each released before the next
+    PATTERN_CHORDS,
+    /// Two keys alternating with no gap, one released as the other is pressed
+    PATTERN_TRILL,
+    /// One key pressed and released repeatedly
+    PATTERN_JACK,
+    /// Notes walking across all nine keys and back
+    PATTERN_STREAM,
+    PATTERN_COUNT
+};
+
+/// Power-up step time, in milliseconds: 16th notes at about 200 BPM
+#define PATTERN_DEFAULT_STEP_TIME 37
+
+uint8_t Pattern_Select(uint8_t pattern, uint8_t time);
+void Pattern_Restart(void);
+uint16_t Pattern_Next(void);
+
+#endif
@@ -38,31 +38,63 @@
 */
 
 #include "PopnAsc.h"
+#include "Telemetry.h"
+#include "Expanders.h"
+#include "Config.h"
+#include "Remap.h"
+#include "Stats.h"
+#include "Memory.h"
+#include "Console.h"
+#include "Midi.h"
+#include "Suspend.h"
+#include "Boot.h"
+#include "ConfigDrive.h"
+#include "Recorder.h"
+#include "Passthrough.h"
+#include "Network.h"
+#include "Pattern.h"
+#include "Watchdog.h"
 
 #include <LUFA/Drivers/Board/LEDs.h>
 #include <LUFA/Drivers/Board/Buttons.h>
 #include <LUFA/Drivers/USB/USB.h>
+#include <LUFA/Scheduler/DeadlineScheduler.h>
 
 #include <avr/io.h>
-#include <avr/wdt.h>
 #include <avr/power.h>
 #include <avr/interrupt.h>
+#include <util/atomic.h>
 #include <stdbool.h>
 #include <string.h>
 
-/// Button edge changes are ignored for how many milliseconds?
-#define DEBOUNCE_DOWN_TIME 20 
-#define DEBOUNCE_UP_TIME 5
-
 /// Current timestamp (millisecond)
 unsigned char timeMark;
 
+/// Set while the debug button is held, to restart the test pattern on each press
+static bool debugHeld;
+
 /// Button status management: When was the button pushed?
-unsigned char lastTime[9];
+unsigned char lastTime[BUTTON_COUNT];
 /// Button status management: [Bitmap] The current button states (active high)
-unsigned short buttonState;
+ButtonBitmap_t buttonState;
 /// Button status management: [Bitmap] If a button is in debounce delay phase, during which button state changes will be ignored
-unsigned short buttonDebounce;
+ButtonBitmap_t buttonDebounce;
+/// Button status management: [Bitmap] Undebounced states of the last scan, to see bounces
+ButtonBitmap_t lastRawState;
+/// [Bitmap] Remapped inputs of the last scan that could apply the map
+static uint16_t lastMapped;
+
+#if STATS_FEATURE_REPORT_SIZE > CONFIG_FEATURE_REPORT_SIZE || MEMORY_FEATURE_REPORT_SIZE > CONFIG_FEATURE_REPORT_SIZE || \
+    PASSTHROUGH_FEATURE_REPORT_SIZE > CONFIG_FEATURE_REPORT_SIZE || WATCHDOG_FEATURE_REPORT_SIZE > CONFIG_FEATURE_REPORT_SIZE || \
+    SCHEDULER_FEATURE_REPORT_SIZE > CONFIG_FEATURE_REPORT_SIZE || MIDI_FEATURE_REPORT_SIZE > CONFIG_FEATURE_REPORT_SIZE
+#error The feature reports must fit keyboardReportBuffer.
+#endif
+
+/// Report buffers of the HID interfaces: the largest report plus its ID
+static uint8_t keyboardReportBuffer[CONFIG_FEATURE_REPORT_SIZE + 1];
+#if defined(TWO_PLAYER_ENABLED)
+static uint8_t player2ReportBuffer[BUTTON_REPORT_BYTES(PLAYER2_BUTTON_COUNT) + 1];
+#endif
 
 /** LUFA HID Class driver interface configuration and state information. */
 USB_ClassInfo_HID_Device_t Keyboard_HID_Interface =
@@ -76,15 +108,77 @@ USB_ClassInfo_HID_Device_t Keyboard_HID_Interface =
                 .ReportINEndpointDoubleBank   = false,
 
                 .PrevReportINBuffer           = NULL,
-                .PrevReportINBufferSize       = DEVICE_ENDPOINT_SIZE,
+                .PrevReportINBufferSize       = CONFIG_FEATURE_REPORT_SIZE,
+
+                .ReportBuffer                 = keyboardReportBuffer,
+                .ReportBufferSize             = sizeof(keyboardReportBuffer),
+            },
+    };
+
+#if defined(TWO_PLAYER_ENABLED)
+/** LUFA HID Class driver interface of player 2, reporting the inputs after player 1's. */
+USB_ClassInfo_HID_Device_t Player2_HID_Interface =
+    {
+        .Config =
+            {
+                .InterfaceNumber              = PLAYER2_INTERFACE,
+
+                .ReportINEndpointNumber       = PLAYER2_ENDPOINT_NUM,
+                .ReportINEndpointSize         = DEVICE_ENDPOINT_SIZE,
+                .ReportINEndpointDoubleBank   = false,
+
+                .PrevReportINBuffer           = NULL,
+                .PrevReportINBufferSize       = BUTTON_REPORT_BYTES(PLAYER2_BUTTON_COUNT),
+
+                .ReportBuffer                 = player2ReportBuffer,
+                .ReportBufferSize             = sizeof(player2ReportBuffer),
             },
     };
+#endif
+
 
+/// Indexes of the tasks in the deadline scheduler task list
+enum
+{
+    REPORT_TASK,
+#if defined(EXPANDERS_ENABLED)
+    LAMP_TASK,
+#endif
+};
 
 void init_hardware(void);
 void Popn_Buttons_Init(void);
 void CalculateButtonState(void);
 
+DEADLINE_TASK(ReportTask);
+#if defined(EXPANDERS_ENABLED)
+DEADLINE_TASK(LampTask);
+#endif
+
+/** Deadline scheduler task list. The report task is released by every SOF right after the buttons are
+ *  scanned, and is also polled every millisecond so that control requests are serviced before SOF events
+ *  are enabled. The lamp task is released by every SOF too, and only has to queue its write before the
+ *  next one.
+ *
+ *  The scan and the telemetry stay in the SOF handler: the scan is timed by the SOF, and the telemetry
+ *  frames are all produced there, as the UART and RNDIS queues take a single producer.
+ */
+DEADLINE_TASK_LIST
+{
+    [REPORT_TASK] = { .Task     = ReportTask,
+                      .Priority = 0,
+                      .Period   = DEADLINE_SCHEDULER_MS_TO_TICKS(1),
+                      .Deadline = DEADLINE_SCHEDULER_US_TO_TICKS(100),
+                      .Enabled  = true },
+#if defined(EXPANDERS_ENABLED)
+    [LAMP_TASK]   = { .Task     = LampTask,
+                      .Priority = 1,
+                      .Period   = 0,
+                      .Deadline = DEADLINE_SCHEDULER_US_TO_TICKS(900),
+                      .Enabled  = true },
+#endif
+};
+
 /** Main program entry point. This routine contains the overall program flow, including initial
  *  setup of all components and the main program loop.
  */
@@ -96,37 +190,153 @@ int main(void)
 
     for (;;)
     {
-        wdt_reset();
-        HID_Device_USBTask(&Keyboard_HID_Interface);
-        USB_USBTask();
+        // Pets the watchdog only if the scan and the report task kept up
+        Watchdog_Service();
+        DeadlineScheduler_RunOnce();
+#if defined(PASSTHROUGH_INPUTS)
+        // Take bridge frames as they complete, not at the next scan
+        Passthrough_Task();
+#endif
+
+        // Power down for as long as the bus is suspended
+        if (USB_DeviceState == DEVICE_STATE_Suspended)
+          Suspend_Sleep();
     }
 }
 
+/** Sends the HID report and services the USB control endpoint. */
+DEADLINE_TASK(ReportTask)
+{
+    Watchdog_Beat(WATCHDOG_BEAT_REPORT);
+    Boot_Poll();
+    HID_Device_USBTask(&Keyboard_HID_Interface);
+#if defined(TWO_PLAYER_ENABLED)
+    // Both banks are filled from the same scan in this task run, so the
+    // host collects player 1 then player 2 in the same frame
+    HID_Device_USBTask(&Player2_HID_Interface);
+#endif
+#if defined(DEBUG_CONSOLE_ENABLED)
+    // After the HID report, and never waits for the host
+    Console_USBTask();
+#endif
+#if defined(MIDI_ENABLED)
+    // The note events of the frame, as one packet
+    Midi_USBTask();
+#endif
+#if defined(CONFIG_DRIVE_ENABLED)
+    // Last, as it waits on the host while a command is in progress
+    ConfigDrive_USBTask();
+#endif
+#if defined(RECORDER_ENABLED)
+    // A few packets of a dump, if one is running
+    Recorder_USBTask();
+#endif
+#if defined(NETWORK_ENABLED)
+    // The telemetry queued so far, a bank at a time
+    Network_USBTask();
+#endif
+    USB_USBTask();
+}
+
+#if defined(EXPANDERS_ENABLED)
+/** Queues the lamp write of the frame's button state. */
+DEADLINE_TASK(LampTask)
+{
+    ButtonBitmap_t state;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        state = buttonState;
+    }
+
+    Expanders_SetLamps(state);
+}
+#endif
+
 /** Configures the board hardware and chip peripherals for the demo's functionality. */
 void init_hardware(void)
 {
-    // Turn on Watchdog
-    wdt_enable(WDTO_500MS);
+    // Turn on Watchdog, after taking note of why the last reset happened
+    Watchdog_Init();
 
     // Disable clock prescaler
     clock_prescale_set(clock_div_1);
 
+    // The boot is timed from here
+    DeadlineScheduler_Init();
+    Boot_Start();
+
+#if defined(FAST_BOOT_ENABLED)
+    // Let the PLL lock while the pins are set up, then attach right away so
+    // that the host's connect debounce and bus reset overlap the rest of
+    // the setup. Nothing USB is serviced before interrupts are enabled.
+    USB_PLL_On();
+    LEDs_Init();
+    Buttons_Init();
+    Popn_Buttons_Init();
+    USB_Init();
+    Boot_Mark(BOOT_MARK_USB_ATTACHED);
+#else
     // Initialize other driver
     LEDs_Init();
     Buttons_Init();
     Popn_Buttons_Init();
+#endif
+    Config_Init();
+#if defined(DEBUG_CONSOLE_ENABLED)
+    Console_Init();
+    Watchdog_LogReset();
+#endif
+#if defined(MIDI_ENABLED)
+    Midi_Init();
+#endif
+#if defined(CONFIG_DRIVE_ENABLED)
+    ConfigDrive_Init();
+#endif
+#if defined(RECORDER_ENABLED)
+    Recorder_Init();
+#endif
+#if defined(NETWORK_ENABLED)
+    Network_Init();
+#endif
+#if defined(TELEMETRY_ENABLED)
+    Telemetry_Init();
+#endif
+#if defined(EXPANDERS_ENABLED)
+    Expanders_Init();
+#endif
+#if defined(FAST_BOOT_ENABLED)
+    // Scan once so the first report already holds the buttons pressed at power-up
+    CalculateButtonState();
+#else
     USB_Init();
+    Boot_Mark(BOOT_MARK_USB_ATTACHED);
+#endif
 }
 
 /** Initialize Pop'n buttons */
 void Popn_Buttons_Init(void)
 {
+#if defined(SHIFT_REGISTER_INPUTS)
+    // Buttons are connected through chained 74HC165 on the SPI pins
+    ShiftRegister_Init();
+#elif defined(HALL_INPUTS)
+    // Buttons are analog hall-effect sensors on the ADC inputs
+    HallInputs_Init();
+#elif defined(MATRIX_INPUTS)
+    // Buttons are a key matrix, columns on PB0 to PB7
+    Matrix_Init();
+#elif defined(PASSTHROUGH_INPUTS)
+    // Buttons are a pad on a USB host bridge, sent to RXD1
+    Passthrough_Init();
+#else
     // Buttons are connected to PB0 to PB7 and PC7
     DDRB  = 0;
     PORTB = 0xFF;
     
     DDRC  &= ~_BV(7);
     PORTC |=  _BV(7);
+#endif
 }
 
 /** Event handler for the library USB Connection event. */
@@ -141,12 +351,47 @@ void EVENT_USB_Device_Disconnect(void)
     LEDs_TurnOnLEDs(LEDS_LED1);
 }
 
+/** Event handler for the library USB Reset event. */
+void EVENT_USB_Device_Reset(void)
+{
+#if defined(DEBUG_CONSOLE_ENABLED)
+    static uint16_t busResets;
+#endif
+
+    Boot_MarkFromISR(BOOT_MARK_BUS_RESET);
+    CONSOLE_LOG("bus reset ", ++busResets);
+}
+
 /** Event handler for the library USB Configuration Changed event. */
 void EVENT_USB_Device_ConfigurationChanged(void)
 {
     bool ConfigSuccess = true;
 
+    Boot_Mark(BOOT_MARK_CONFIGURED);
+
     ConfigSuccess &= HID_Device_ConfigureEndpoints(&Keyboard_HID_Interface);
+#if defined(TWO_PLAYER_ENABLED)
+    ConfigSuccess &= HID_Device_ConfigureEndpoints(&Player2_HID_Interface);
+#endif
+#if defined(DEBUG_CONSOLE_ENABLED)
+    ConfigSuccess &= Console_ConfigureEndpoints();
+    Console_PrintP(PSTR("PopnAsc console\r\n"));
+#endif
+#if defined(MIDI_ENABLED)
+    ConfigSuccess &= Midi_ConfigureEndpoints();
+#endif
+#if defined(CONFIG_DRIVE_ENABLED)
+    ConfigSuccess &= ConfigDrive_ConfigureEndpoints();
+#endif
+#if defined(RECORDER_ENABLED)
+    ConfigSuccess &= Recorder_ConfigureEndpoints();
+#endif
+#if defined(NETWORK_ENABLED)
+    ConfigSuccess &= Network_ConfigureEndpoints();
+#endif
+
+    if (!ConfigSuccess)
+      CONSOLE_LOG("endpoint setup failed ", USB_ConfigurationNumber);
 
     USB_Device_EnableSOFEvents();
 
@@ -157,68 +402,239 @@ void EVENT_USB_Device_ConfigurationChanged(void)
 void EVENT_USB_Device_ControlRequest(void)
 {
     HID_Device_ProcessControlRequest(&Keyboard_HID_Interface);
+#if defined(TWO_PLAYER_ENABLED)
+    HID_Device_ProcessControlRequest(&Player2_HID_Interface);
+#endif
+#if defined(DEBUG_CONSOLE_ENABLED)
+    Console_ProcessControlRequest();
+#endif
+#if defined(CONFIG_DRIVE_ENABLED)
+    ConfigDrive_ProcessControlRequest();
+#endif
+#if defined(RECORDER_ENABLED)
+    Recorder_ProcessControlRequest();
+#endif
+#if defined(NETWORK_ENABLED)
+    Network_ProcessControlRequest();
+#endif
 }
 
 /** Event handler for the USB device Start Of Frame event. */
 void EVENT_USB_Device_StartOfFrame(void)
 {
     HID_Device_MillisecondElapsed(&Keyboard_HID_Interface);
+#if defined(TWO_PLAYER_ENABLED)
+    HID_Device_MillisecondElapsed(&Player2_HID_Interface);
+#endif
     CalculateButtonState();
+    Watchdog_Beat(WATCHDOG_BEAT_SOF);
+    DeadlineScheduler_ReleaseTask(REPORT_TASK);
+#if defined(EXPANDERS_ENABLED)
+    DeadlineScheduler_ReleaseTask(LAMP_TASK);
+    Expanders_StartOfFrame();
+#endif
+#if defined(TELEMETRY_ENABLED)
+    Telemetry_StartOfFrame(USB_Device_GetFrameNumber());
+    Boot_StartOfFrame();
+#endif
 }
 
+/** Event handler for the library USB Suspend event; the main loop then powers down. */
 void EVENT_USB_Device_Suspend()
 {
-    wdt_disable();
+    Watchdog_Stop();
+    LEDs_TurnOffLEDs(LEDS_LED1);
 }
 
+/** Event handler for the library USB Wake Up event, from a host resume or a remote wakeup. */
 void EVENT_USB_Device_WakeUp()
 {
-    wdt_enable(WDTO_500MS);
+    Watchdog_Start();
+    LEDs_TurnOnLEDs(LEDS_LED1);
 }
 
 void CalculateButtonState(void)
 {
+#if !defined(HALL_INPUTS)
     unsigned char i;    
-    unsigned short currentState;
-    unsigned short oldState = buttonState;
-    short change;
+    unsigned char byte;
+    uint8_t mask;
+    uint8_t* debounceBits = (uint8_t*) &buttonDebounce;
+    const uint8_t* stateBits = (const uint8_t*) &buttonState;
+    const uint8_t* changeBits;
+    const uint8_t* bounceBits;
+    ButtonBitmap_t bounce;
+#endif
+    ButtonBitmap_t currentState;
+    ButtonBitmap_t oldState = buttonState;
+    ButtonBitmap_t change;
     
     timeMark++;
     
     // If any debug button is presed
     if (Buttons_GetStatus() != 0) 
     {
-        // Assume all key down
-        currentState = (unsigned short) 0x01FF;
+        if (!debugHeld)
+          Pattern_Restart();
+        debugHeld = true;
+
+        // Play the test pattern, already in report bits so not remapped
+        currentState = Pattern_Next() & (((ButtonBitmap_t) 1 << PLAYER1_BUTTON_COUNT) - 1);
     } else {
+        debugHeld = false;
+
+#if defined(SHIFT_REGISTER_INPUTS)
+        // Read the shift register chain (already flipped to active high)
+        currentState = (ButtonBitmap_t) ShiftRegister_Read();
+#elif defined(HALL_INPUTS)
+        // Rapid trigger state, updated by the ADC sweep
+        currentState = (ButtonBitmap_t) HallInputs_GetState();
+#elif defined(MATRIX_INPUTS)
+        // One byte per row of the last complete scan, ghost keys held
+        currentState = 0;
+        Matrix_Read((uint8_t*) &currentState);
+#elif defined(PASSTHROUGH_INPUTS)
+        // Latest state frame from the bridge, already remapped to inputs
+        currentState = (ButtonBitmap_t) Passthrough_GetState();
+#else
         // Read actual push button 
         // (Push button are active low, so remember to flip them)
-        currentState = (unsigned short) ~(((PINC & _BV(7)) << 1) | PINB);
+        currentState = (ButtonBitmap_t) ~(((PINC & _BV(7)) << 1) | PINB);
+#endif
+#if defined(EXPANDERS_ENABLED)
+        // Buttons may also be wired to the expander inputs, in the same order, all of them mappable
+        currentState |= (ButtonBitmap_t) Expanders_GetInputs() & BUTTON_MASK;
+#endif
+
+        // Apply the configured input to report bit mapping. While a new map is compiled the tables are
+        // part old and part new, so the last scan's mapped inputs stand in rather than phantom edges.
+        if (!remapCompiling)
+          lastMapped = Remap_Apply((uint16_t) currentState);
+        currentState = (currentState & ~(ButtonBitmap_t) 0xFFFF) | lastMapped;
     }
     
+#if defined(HALL_INPUTS)
+    // Rapid trigger hysteresis already filters the analog buttons, and a
+    // debounce delay would hold off the re-trigger it exists for
+    buttonState = currentState;
+    change = buttonState ^ oldState;
+#else
+    // Raw edges of buttons in debounce are the rejected ones
+    bounce = (currentState ^ lastRawState) & buttonDebounce;
+    lastRawState = currentState;
+
     // Use old state if still in debounce interval, or else new state
     buttonState = (buttonState & buttonDebounce) | (~buttonDebounce & currentState);
 
     // Was the state changed?
     change = buttonState ^ oldState;
     
-    for (i = 0; i < 9; i++)
+    // Work a byte of the bitmaps at a time (AVR is little endian, so byte n
+    // holds buttons 8n to 8n+7), skipping bytes with nothing changing or in
+    // debounce. A wide bitmap shifted per button would be a libgcc call.
+    changeBits = (const uint8_t*) &change;
+    bounceBits = (const uint8_t*) &bounce;
+    for (i = 0, byte = 0; i < BUTTON_COUNT; byte++)
     {
-        if (buttonDebounce & _BV(i))
+        if ((debounceBits[byte] | changeBits[byte]) == 0)
+        {
+            i += 8;
+            continue;
+        }
+
+        for (mask = 1; mask && i < BUTTON_COUNT; mask <<= 1, i++)
         {
-            // Release debounce state if interval has passed
-            if (timeMark == lastTime[i])
+            if (debounceBits[byte] & mask)
             {
-                buttonDebounce &= ~_BV(i);
-            }
-        } else {
-            // If change, kick into debounce state
-            if (change & _BV(i)) {
-                lastTime[i] = timeMark + (buttonState & _BV(i) ? DEBOUNCE_DOWN_TIME : DEBOUNCE_UP_TIME);
-                buttonDebounce |= _BV(i);
+                if (bounceBits[byte] & mask)
+                {
+                    // Time into the debounce = debounce time - time left
+                    uint8_t length = stateBits[byte] & mask ? configTables.DebounceDownTime : configTables.DebounceUpTime;
+                    uint8_t left = lastTime[i] - timeMark;
+
+                    Stats_Bounce(i, left < length ? length - left : 0);
+                }
+
+                // Release debounce state if interval has passed
+                if (timeMark == lastTime[i])
+                {
+                    debounceBits[byte] &= ~mask;
+                }
+            } else {
+                // If change, kick into debounce state
+                if (changeBits[byte] & mask) {
+                    lastTime[i] = timeMark + (stateBits[byte] & mask ? configTables.DebounceDownTime : configTables.DebounceUpTime);
+                    debounceBits[byte] |= mask;
+
+                    if (stateBits[byte] & mask)
+                      Stats_Press(i);
+                }
             }
         }
     }
+#endif
+
+#if defined(MIDI_ENABLED)
+    if (change && configTables.ReportMode == CONFIG_REPORT_MODE_MIDI)
+    {
+        Midi_QueueEdges(buttonState, change);
+    }
+#endif
+
+#if defined(TELEMETRY_ENABLED)
+    if (change)
+    {
+        Telemetry_SendButtonEdge(USB_Device_GetFrameNumber(), &buttonState, &change, sizeof(ButtonBitmap_t));
+    }
+#endif
+
+#if defined(RECORDER_ENABLED)
+    // Every frame, as it also keeps time and starts page programs
+    Recorder_Frame(buttonState, change);
+#endif
+}
+
+/** [Bitmap] Buttons to report as keys; none while they play notes instead */
+static inline ButtonBitmap_t ReportedButtons(void)
+{
+    return (configTables.ReportMode == CONFIG_REPORT_MODE_KEYBOARD) ? buttonState : 0;
+}
+
+/** Copy count buttons, starting at input first, into a report as in ButtonLayout.h. With constant
+ *  arguments this is a constant shift, a fixed size copy and a mask: no per-button work or branches.
+ */
+static inline void PackButtons(uint8_t* data, ButtonBitmap_t state, const uint8_t first, const uint8_t count)
+{
+    ButtonBitmap_t bits = state >> first;
+
+    memcpy(data, &bits, BUTTON_REPORT_BYTES(count));
+    data[BUTTON_REPORT_BYTES(count) - 1] &= BUTTON_REPORT_LAST_MASK(count);
+}
+
+/** Scheduler feature report, see PopnAsc.h. Runs in the report task, as does the scheduler's bookkeeping. */
+static void CreateSchedulerReport(uint8_t* data)
+{
+    *data++ = DeadlineScheduler_TotalTasks;
+
+    for (uint8_t i = 0; i < DeadlineScheduler_TotalTasks; i++)
+    {
+        uint16_t latency = DeadlineScheduler_TaskList[i].MaxStartLatency;
+        uint16_t us = (latency > 0xFFFF / SCHEDULER_TICK_US) ? 0xFFFF : latency * SCHEDULER_TICK_US;
+
+        *data++ = us & 0xFF;
+        *data++ = us >> 8;
+        *data++ = DeadlineScheduler_TaskList[i].DeadlineMisses;
+    }
+}
+
+/** Restart the scheduler statistics, e.g. before a measurement run */
+static void ClearSchedulerStats(void)
+{
+    for (uint8_t i = 0; i < DeadlineScheduler_TotalTasks; i++)
+    {
+        DeadlineScheduler_TaskList[i].MaxStartLatency = 0;
+        DeadlineScheduler_TaskList[i].DeadlineMisses  = 0;
+    }
 }
 
 /** HID IN report */
@@ -227,10 +643,67 @@ bool CALLBACK_HID_Device_CreateHIDReport(USB_ClassInfo_HID_Device_t* const HIDIn
 {
     uint8_t* data = (uint8_t*) ReportData;
 
-    data[0] = buttonState & 0xFF;
-    data[1] = (buttonState >> 8) & 0xFF;
+#if defined(TWO_PLAYER_ENABLED)
+    if (HIDInterfaceInfo == &Player2_HID_Interface)
+    {
+        // No report ID and no feature reports on player 2's interface
+        PackButtons(data, ReportedButtons(), PLAYER1_BUTTON_COUNT, PLAYER2_BUTTON_COUNT);
+        *ReportSize = BUTTON_REPORT_BYTES(PLAYER2_BUTTON_COUNT);
+
+        return true;
+    }
+#endif
+
+    if (ReportType == HID_REPORT_ITEM_Feature)
+    {
+        if (*ReportID == HID_REPORTID_CONFIG)
+        {
+            Config_CreateFeatureReport(data);
+            *ReportSize = CONFIG_FEATURE_REPORT_SIZE;
+        }
+        else if (*ReportID == HID_REPORTID_STATS)
+        {
+            Stats_CreateFeatureReport(data);
+            *ReportSize = STATS_FEATURE_REPORT_SIZE;
+        }
+        else if (*ReportID == HID_REPORTID_MEMORY)
+        {
+            Memory_CreateFeatureReport(data);
+            *ReportSize = MEMORY_FEATURE_REPORT_SIZE;
+        }
+        else if (*ReportID == HID_REPORTID_WATCHDOG)
+        {
+            Watchdog_CreateFeatureReport(data);
+            *ReportSize = WATCHDOG_FEATURE_REPORT_SIZE;
+        }
+        else if (*ReportID == HID_REPORTID_SCHEDULER)
+        {
+            CreateSchedulerReport(data);
+            *ReportSize = SCHEDULER_FEATURE_REPORT_SIZE;
+        }
+#if defined(MIDI_ENABLED)
+        else if (*ReportID == HID_REPORTID_MIDI)
+        {
+            Midi_CreateFeatureReport(data);
+            *ReportSize = MIDI_FEATURE_REPORT_SIZE;
+        }
+#endif
+#if defined(PASSTHROUGH_INPUTS)
+        else if (*ReportID == HID_REPORTID_PASSTHROUGH)
+        {
+            Passthrough_CreateFeatureReport(data);
+            *ReportSize = PASSTHROUGH_FEATURE_REPORT_SIZE;
+        }
+#endif
+
+        return false;
+    }
+
+    *ReportID = HID_REPORTID_BUTTONS;
+    Boot_Mark(BOOT_MARK_FIRST_REPORT);
 
-    *ReportSize = 2;
+    PackButtons(data, ReportedButtons(), 0, PLAYER1_BUTTON_COUNT);
+    *ReportSize = BUTTON_REPORT_BYTES(PLAYER1_BUTTON_COUNT);
 
     return true;
 }
@@ -242,6 +715,32 @@ void CALLBACK_HID_Device_ProcessHIDReport(USB_ClassInfo_HID_Device_t* const HIDI
                                           const void* ReportData,
                                           const uint16_t ReportSize)
 {
-    // No-op
+#if defined(TWO_PLAYER_ENABLED)
+    if (HIDInterfaceInfo == &Player2_HID_Interface)
+      return;
+#endif
+
+    // Every report fits the buffer; an oversized one is dropped whole, its first chunk included
+    if (!HID_Device_IsWholeReport(HIDInterfaceInfo, ReportSize))
+      return;
+
+    if (ReportType == HID_REPORT_ITEM_Feature && ReportID == HID_REPORTID_CONFIG)
+    {
+        Config_ProcessFeatureReport((const uint8_t*) ReportData, ReportSize);
+    }
+    else if (ReportType == HID_REPORT_ITEM_Feature && ReportID == HID_REPORTID_STATS)
+    {
+        Stats_ProcessFeatureReport((const uint8_t*) ReportData, ReportSize);
+    }
+    else if (ReportType == HID_REPORT_ITEM_Feature && ReportID == HID_REPORTID_SCHEDULER)
+    {
+        ClearSchedulerStats();
+    }
+#if defined(PASSTHROUGH_INPUTS)
+    else if (ReportType == HID_REPORT_ITEM_Feature && ReportID == HID_REPORTID_PASSTHROUGH)
+    {
+        Passthrough_ProcessFeatureReport((const uint8_t*) ReportData, ReportSize);
+    }
+#endif
 }
 
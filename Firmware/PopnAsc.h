@@ -41,8 +41,75 @@
 
 #include "Descriptors.h"
 
+#if defined(SHIFT_REGISTER_INPUTS)
+#include "ShiftRegister.h"
+
+/// Number of debounced inputs: 8 per chained 74HC165
+#define BUTTON_COUNT (SHIFT_REGISTER_COUNT * 8)
+#elif defined(HALL_INPUTS)
+#include "HallInputs.h"
+
+/// Number of debounced inputs: one per analog channel
+#define BUTTON_COUNT HALL_CHANNEL_COUNT
+#elif defined(MATRIX_INPUTS)
+#include "Matrix.h"
+
+/// Number of debounced inputs: 8 columns per matrix row
+#define BUTTON_COUNT (MATRIX_ROWS * 8)
+#elif defined(PASSTHROUGH_INPUTS)
+#include "Passthrough.h"
+
+/// Number of debounced inputs: as carried by the bridge's state frames
+#define BUTTON_COUNT PASSTHROUGH_BUTTON_COUNT
+#else
+#include "Expanders.h"
+
+#if defined(EXPANDERS_ENABLED) && EXPANDER_COUNT > 1
+/// Number of debounced inputs: PB0 to PB7 and PC7, and the second expander's port A from input 8
+#define BUTTON_COUNT 16
+#else
+/// Number of debounced inputs: PB0 to PB7 and PC7
+#define BUTTON_COUNT 9
+#endif
+#endif
+
+/// [Bitmap] Every input; shifted in 64 bits so that a full ButtonBitmap_t does not overflow
+#define BUTTON_MASK ((ButtonBitmap_t) ((2ULL << (BUTTON_COUNT - 1)) - 1))
+
+#if defined(TWO_PLAYER_ENABLED) && BUTTON_COUNT < PLAYER1_BUTTON_COUNT + PLAYER2_BUTTON_COUNT
+#error TWO_PLAYER_ENABLED needs more inputs: use SHIFT_REGISTER_INPUTS, MATRIX_INPUTS or PASSTHROUGH_INPUTS.
+#endif
+
+/// Power-up debounce times in milliseconds, until the EEPROM config is loaded
+#define DEBOUNCE_DOWN_TIME 20 
+#define DEBOUNCE_UP_TIME 5
+
+/// [Bitmap] One bit per input, wide enough for BUTTON_COUNT
+#if BUTTON_COUNT > 32
+typedef uint64_t ButtonBitmap_t;
+#elif BUTTON_COUNT > 16
+typedef uint32_t ButtonBitmap_t;
+#else
+typedef uint16_t ButtonBitmap_t;
+#endif
+
+/** Scheduler feature report (HID_REPORTID_SCHEDULER, SCHEDULER_FEATURE_REPORT_SIZE bytes):
+ *  GET: Byte 0:   Number of tasks
+ *       Per task, in task list order (report task, then the lamp task with EXPANDERS_ENABLED):
+ *       Byte 0-1: Worst start latency since the last clear, in microseconds (saturating)
+ *       Byte 2:   Late starts since the last clear (saturating)
+ *  SET: Any payload clears the statistics.
+ *
+ *  The latency of a task released by the SOF is an upper bound, see DeadlineScheduler.h.
+ */
+#define SCHEDULER_FEATURE_REPORT_SIZE 32
+
+/// Length of a scheduler tick in microseconds
+#define SCHEDULER_TICK_US (1000000UL / DEADLINE_SCHEDULER_TICK_HZ)
+
 void EVENT_USB_Device_Connect(void);
 void EVENT_USB_Device_Disconnect(void);
+void EVENT_USB_Device_Reset(void);
 void EVENT_USB_Device_ConfigurationChanged(void);
 void EVENT_USB_Device_ControlRequest(void);
 void EVENT_USB_Device_StartOfFrame(void);
@@ -0,0 +1,333 @@
+/*
+  Pop'n Convertible Arcade Style Controller Project
+ 
+  Copyright 2011 Sam Wong (Sam /@/ hellosam /./ net)
+
+  This work is licensed under the Creative Commons Attribution 3.0 
+  Hong Kong License. 
+
+  To view a copy of this license, visit 
+  http://creativecommons.org/licenses/by/3.0/hk/ or send a letter to 
+  Creative Commons, 444 Castro Street, Suite 900, 
+  Mountain View, California, 94041, USA.  
+*/
+
+#include "Recorder.h"
+#include "Descriptors.h"
+
+#include <LUFA/Drivers/Board/Dataflash.h>
+#include <LUFA/Drivers/USB/USB.h>
+
+#include <util/atomic.h>
+
+#if !defined(SHIFT_REGISTER_INPUTS)
+#error RECORDER_ENABLED needs SHIFT_REGISTER_INPUTS, the only input backend that leaves the SPI pins free.
+#endif
+
+/// Records after the header of a page
+#define RECORDS_PER_PAGE ((DATAFLASH_PAGE_SIZE - sizeof(RecorderPageHeader_t)) / sizeof(RecorderRecord_t))
+
+/// Sequence number read from an erased page
+#define SEQUENCE_ERASED 0xFFFFFFFFUL
+
+enum
+{
+    RECORDER_OFF,
+    RECORDER_RECORDING,
+    /// Dump requested: the page being filled is programmed first
+    RECORDER_FLUSHING,
+    RECORDER_DUMPING,
+};
+
+/// RECORDER_*; only the SOF handler leaves RECORDING or FLUSHING
+static volatile uint8_t mode;
+
+/// Page being filled, its sequence number and the records in it so far
+static uint16_t page;
+static uint32_t sequence;
+static uint8_t count;
+/// Chip buffer being filled (0 or 1); the other may be programming the last page
+static uint8_t buffer;
+/// Set once every page has been written
+static bool wrapped;
+static uint16_t session;
+/// Edges lost since the last page header, saturating
+static uint8_t dropped;
+/// Milliseconds since power-up
+static uint32_t now;
+
+/// Dump position: page, byte in it, and pages still to send
+static uint16_t dumpPage;
+static uint16_t dumpOffset;
+static uint16_t dumpPagesLeft;
+
+/** Read the status register once; true if no page program is running */
+static bool Recorder_IsReady(void)
+{
+    uint8_t status;
+
+    Dataflash_SelectChip(DATAFLASH_CHIP1);
+    Dataflash_SendByte(DF_CMD_GETSTATUS);
+    status = Dataflash_ReceiveByte();
+    Dataflash_DeselectChip();
+
+    return status & DF_STATUS_READY;
+}
+
+/** Start a continuous read of main memory; the caller clocks in the data and deselects */
+static void Recorder_StartRead(uint16_t pageAddress, uint16_t offset)
+{
+    Dataflash_SelectChip(DATAFLASH_CHIP1);
+    Dataflash_SendByte(DF_CMD_CONTARRAYREAD_LF);
+    Dataflash_SendAddressBytes(pageAddress, offset);
+}
+
+static void Recorder_ReadHeader(uint16_t pageAddress, RecorderPageHeader_t* header)
+{
+    uint8_t* data = (uint8_t*) header;
+    uint8_t i;
+
+    Recorder_StartRead(pageAddress, 0);
+    for (i = 0; i < sizeof(RecorderPageHeader_t); i++)
+    {
+        data[i] = Dataflash_ReceiveByte();
+    }
+    Dataflash_DeselectChip();
+}
+
+/** Write into the chip buffer being filled */
+static void Recorder_WriteBuffer(uint16_t offset, const void* data, uint8_t length)
+{
+    const uint8_t* bytes = (const uint8_t*) data;
+
+    Dataflash_SelectChip(DATAFLASH_CHIP1);
+    Dataflash_SendByte(buffer ? DF_CMD_BUFF2WRITE : DF_CMD_BUFF1WRITE);
+    Dataflash_SendAddressBytes(0, offset);
+    while (length--)
+    {
+        Dataflash_SendByte(*bytes++);
+    }
+    Dataflash_DeselectChip();
+}
+
+/** Complete the header of the buffer being filled and start programming it; the chip must be ready */
+static void Recorder_Commit(void)
+{
+    RecorderPageHeader_t header = { .Sequence = sequence, .Session = session, .Count = count, .Dropped = dropped };
+
+    Recorder_WriteBuffer(0, &header, sizeof(header));
+
+    Dataflash_SelectChip(DATAFLASH_CHIP1);
+    Dataflash_SendByte(buffer ? DF_CMD_BUFF2TOMAINMEMWITHERASE : DF_CMD_BUFF1TOMAINMEMWITHERASE);
+    Dataflash_SendAddressBytes(page, 0);
+    Dataflash_DeselectChip();
+
+    // Records go to the other buffer while this one programs
+    buffer ^= 1;
+    count = 0;
+    dropped = 0;
+    sequence++;
+
+    if (++page == DATAFLASH_PAGES)
+    {
+        page = 0;
+        wrapped = true;
+    }
+}
+
+/** Find where the last session stopped. The SPI is already set up for the shift registers. */
+void Recorder_Init(void)
+{
+    RecorderPageHeader_t header;
+    uint32_t first;
+    uint16_t low;
+    uint16_t high;
+    uint16_t middle;
+    uint8_t manufacturer;
+
+    Dataflash_Init();
+
+    Dataflash_SelectChip(DATAFLASH_CHIP1);
+    Dataflash_SendByte(DF_CMD_READMANUFACTURERDEVICEINFO);
+    manufacturer = Dataflash_ReceiveByte();
+    Dataflash_DeselectChip();
+
+    if (manufacturer != DF_MANUFACTURER_ATMEL)
+    {
+        // No chip fitted
+        mode = RECORDER_OFF;
+        return;
+    }
+
+    Recorder_ReadHeader(0, &header);
+    if (header.Sequence == SEQUENCE_ERASED)
+    {
+        page = 0;
+        sequence = 0;
+        session = 0;
+        wrapped = false;
+    }
+    else
+    {
+        // Page 0 starts a run of consecutive sequence numbers which ends at the
+        // last page written, so the end of the run can be binary searched
+        first = header.Sequence;
+        low = 0;
+        high = DATAFLASH_PAGES;
+        while (high - low > 1)
+        {
+            middle = (low + high) / 2;
+            Recorder_ReadHeader(middle, &header);
+            if (header.Sequence == first + middle)
+              low = middle;
+            else
+              high = middle;
+        }
+
+        Recorder_ReadHeader(low, &header);
+        sequence = header.Sequence + 1;
+        session = header.Session + 1;
+        page = (low + 1 == DATAFLASH_PAGES) ? 0 : low + 1;
+
+        // The page after the last one only holds data once the ring has wrapped
+        Recorder_ReadHeader(page, &header);
+        wrapped = (header.Sequence != SEQUENCE_ERASED);
+    }
+
+    buffer = 0;
+    count = 0;
+    dropped = 0;
+    now = 0;
+    mode = RECORDER_RECORDING;
+}
+
+bool Recorder_ConfigureEndpoints(void)
+{
+    // A dump cut short by a reset is not resumed
+    if (mode == RECORDER_DUMPING)
+      mode = RECORDER_RECORDING;
+
+    return Endpoint_ConfigureEndpoint(RECORDER_IN_EPNUM, EP_TYPE_BULK, ENDPOINT_DIR_IN,
+                                      RECORDER_EPSIZE, ENDPOINT_BANK_SINGLE);
+}
+
+void Recorder_ProcessControlRequest(void)
+{
+    if (USB_ControlRequest.wIndex != RECORDER_INTERFACE || mode == RECORDER_OFF)
+      return;
+
+    // Unhandled requests are stalled by the library, as is a dump without a chip
+    if (USB_ControlRequest.bmRequestType == (REQDIR_HOSTTODEVICE | REQTYPE_VENDOR | REQREC_INTERFACE) &&
+        USB_ControlRequest.bRequest == RECORDER_REQUEST_DUMP)
+    {
+        Endpoint_ClearSETUP();
+
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+        {
+            if (mode == RECORDER_RECORDING)
+              mode = RECORDER_FLUSHING;
+        }
+
+        Endpoint_ClearStatusStage();
+    }
+}
+
+/** Record the edges of a frame. Called from the SOF handler right after the scan, every frame. */
+void Recorder_Frame(ButtonBitmap_t state, ButtonBitmap_t change)
+{
+    RecorderRecord_t record;
+
+    if (mode == RECORDER_OFF)
+      return;
+
+    now++;
+
+    if (change)
+    {
+        if (mode != RECORDER_DUMPING && count < RECORDS_PER_PAGE)
+        {
+            record.Time = now;
+            record.State = state;
+            Recorder_WriteBuffer(sizeof(RecorderPageHeader_t) + count * sizeof(RecorderRecord_t),
+                                 &record, sizeof(record));
+            count++;
+        }
+        else if (dropped != 0xFF)
+        {
+            dropped++;
+        }
+    }
+
+    if (mode == RECORDER_DUMPING)
+      return;
+
+    // Program the page once it is full (or a dump wants it) and the chip has
+    // finished the last one; until then the status is polled once a frame
+    if ((count == RECORDS_PER_PAGE || (mode == RECORDER_FLUSHING && count != 0)) && Recorder_IsReady())
+    {
+        Recorder_Commit();
+    }
+
+    if (mode == RECORDER_FLUSHING && count == 0)
+    {
+        dumpPage = wrapped ? page : 0;
+        dumpPagesLeft = wrapped ? DATAFLASH_PAGES : page;
+        dumpOffset = 0;
+        mode = RECORDER_DUMPING;
+    }
+}
+
+/** Send the next packets of a dump, reading the dataflash straight into the endpoint bank */
+void Recorder_USBTask(void)
+{
+    uint8_t packets;
+    uint8_t i;
+    bool ready;
+
+    if (mode != RECORDER_DUMPING || USB_DeviceState != DEVICE_STATE_Configured)
+      return;
+
+    Endpoint_SelectEndpoint(RECORDER_IN_EPNUM);
+
+    for (packets = 0; packets < RECORDER_DUMP_PACKETS && Endpoint_IsINReady(); packets++)
+    {
+        if (dumpPagesLeft == 0)
+        {
+            // Pages are whole packets, so a zero length packet ends the transfer
+            Endpoint_ClearIN();
+            mode = RECORDER_RECORDING;
+            return;
+        }
+
+        // The SOF handler shares the SPI bus for the shift registers
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+        {
+            // If the last page is still programming, leave it to a later
+            // call rather than wait here. The packet's read itself does run
+            // with interrupts held off, one packet per block.
+            ready = Recorder_IsReady();
+            if (ready)
+            {
+                Recorder_StartRead(dumpPage, dumpOffset);
+                for (i = 0; i < RECORDER_EPSIZE; i++)
+                {
+                    Endpoint_Write_8(Dataflash_ReceiveByte());
+                }
+                Dataflash_DeselectChip();
+            }
+        }
+
+        if (!ready)
+          return;
+
+        Endpoint_ClearIN();
+
+        dumpOffset += RECORDER_EPSIZE;
+        if (dumpOffset == DATAFLASH_PAGE_SIZE)
+        {
+            dumpOffset = 0;
+            dumpPage = (dumpPage + 1 == DATAFLASH_PAGES) ? 0 : dumpPage + 1;
+            dumpPagesLeft--;
+        }
+    }
+}
@@ -0,0 +1,86 @@
+/*
+  Pop'n Convertible Arcade Style Controller Project
+ 
+  Copyright 2011 Sam Wong (Sam /@/ hellosam /./ net)
+
+  This work is licensed under the Creative Commons Attribution 3.0 
+  Hong Kong License. 
+
+  To view a copy of this license, visit 
+  http://creativecommons.org/licenses/by/3.0/hk/ or send a letter to 
+  Creative Commons, 444 Castro Street, Suite 900, 
+  Mountain View, California, 94041, USA.  
+*/
+
+#ifndef _RECORDER_H_
+#define _RECORDER_H_
+
+#include "PopnAsc.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/** Black-box recorder of button edges to an external dataflash.
+ *
+ * Every frame with a debounced edge appends a record (milliseconds since
+ * power-up and the button state) to one of the chip's two SRAM buffers,
+ * from the SOF handler right after the scan, which already owns the SPI
+ * bus. A full buffer is programmed to its page while records go into the
+ * other buffer, so the scan path never waits on Dataflash_WaitWhileBusy():
+ * a page program is only started once a status read shows the chip
+ * ready, and edges that come while both buffers are full are dropped and
+ * counted in the next page header.
+ *
+ * Pages form a ring over the whole chip with consecutive sequence numbers;
+ * at power-up a binary search over the page headers finds where the last
+ * session stopped, and a new session starts on the next page.
+ *
+ * The vendor request RECORDER_REQUEST_DUMP to the recorder interface ends
+ * the current page early and streams every page, oldest first, out of the
+ * bulk IN endpoint, ending with a zero length packet. Edges are dropped
+ * while the dump runs. Tools/recorder.py on the host requests the dump
+ * and decodes it.
+ *
+ * Needs SHIFT_REGISTER_INPUTS for the SPI pins. The 74HC165 output is
+ * always driven, so it must reach MISO through a buffer that is disabled
+ * while the dataflash is selected (PD6 low).
+ */
+
+/// Vendor request (host to device, interface recipient) that starts a dump
+#define RECORDER_REQUEST_DUMP 0x01
+
+/// Packets sent per report task run during a dump; the SPI reads behind
+/// each one hold off the SOF handler for about 200us
+#ifndef RECORDER_DUMP_PACKETS
+#define RECORDER_DUMP_PACKETS 2
+#endif
+
+/** Header at the start of every page */
+typedef struct
+{
+    /// Consecutive over the ring; 0xFFFFFFFF for an erased page
+    uint32_t Sequence;
+    /// Power-ups since the chip was erased
+    uint16_t Session;
+    /// Records following the header
+    uint8_t Count;
+    /// Edges lost since the previous page, saturating
+    uint8_t Dropped;
+} RecorderPageHeader_t;
+
+/** One debounced edge */
+typedef struct
+{
+    /// Milliseconds (frames) since power-up
+    uint32_t Time;
+    /// [Bitmap] Button state after the edge
+    uint32_t State;
+} RecorderRecord_t;
+
+void Recorder_Init(void);
+bool Recorder_ConfigureEndpoints(void);
+void Recorder_ProcessControlRequest(void);
+void Recorder_USBTask(void);
+void Recorder_Frame(ButtonBitmap_t state, ButtonBitmap_t change);
+
+#endif
@@ -0,0 +1,64 @@
+/*
+  Pop'n Convertible Arcade Style Controller Project
+ 
+  Copyright 2011 Sam Wong (Sam /@/ hellosam /./ net)
+
+  This work is licensed under the Creative Commons Attribution 3.0 
+  Hong Kong License. 
+
+  To view a copy of this license, visit 
+  http://creativecommons.org/licenses/by/3.0/hk/ or send a letter to 
+  Creative Commons, 444 Castro Street, Suite 900, 
+  Mountain View, California, 94041, USA.  
+*/
+
+#include "Remap.h"
+
+#include <util/atomic.h>
+
+uint16_t remapTable[REMAP_NIBBLES][16];
+volatile bool remapCompiling;
+
+/** Build the nibble tables from a map of input to report bit (see Config_t) */
+void Remap_Compile(const uint8_t* map)
+{
+    uint16_t bits[4];
+    uint16_t* table;
+    uint8_t nibble;
+    uint8_t input;
+    uint8_t value;
+
+    // The blocks also keep the table writes between the flag changes
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        remapCompiling = true;
+    }
+
+    for (nibble = 0; nibble < REMAP_NIBBLES; nibble++)
+    {
+        table = remapTable[nibble];
+
+        // Report bit of each input in this nibble; inputs past BUTTON_COUNT
+        // do not exist and would only ever read as noise
+        for (input = 0; input < 4; input++)
+        {
+            uint8_t index = nibble * 4 + input;
+            uint8_t bit = map[index];
+
+            bits[input] = (index >= BUTTON_COUNT || bit == CONFIG_UNMAPPED) ? 0 : (uint16_t) 1 << bit;
+        }
+
+        // Each value is a smaller value plus its highest input
+        table[0] = 0;
+        for (value = 1; value < 16; value++)
+        {
+            input = (value & 0x08) ? 3 : (value & 0x04) ? 2 : (value & 0x02) ? 1 : 0;
+            table[value] = table[value & ~(1 << input)] | bits[input];
+        }
+    }
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        remapCompiling = false;
+    }
+}
@@ -0,0 +1,84 @@
+/*
+  Pop'n Convertible Arcade Style Controller Project
+ 
+  Copyright 2011 Sam Wong (Sam /@/ hellosam /./ net)
+
+  This work is licensed under the Creative Commons Attribution 3.0 
+  Hong Kong License. 
+
+  To view a copy of this license, visit 
+  http://creativecommons.org/licenses/by/3.0/hk/ or send a letter to 
+  Creative Commons, 444 Castro Street, Suite 900, 
+  Mountain View, California, 94041, USA.  
+*/
+
+#ifndef _REMAP_H_
+#define _REMAP_H_
+
+#include "PopnAsc.h"
+#include "Config.h"
+
+#include <stdbool.h>
+
+/** Input to report bit remapping in constant time.
+ *
+ * Any mapping of the first CONFIG_MAPPED_BUTTONS inputs (permutations,
+ * several inputs on one bit, unmapped inputs) is compiled into one
+ * 16-entry table per nibble of inputs. Each entry holds the report bits
+ * set by that nibble's inputs in that combination, so applying the map is
+ * one load and OR per nibble: ~8 cycles each, whatever the inputs are.
+ *
+ * Only as many nibbles as there are inputs get a table: 3 (96 bytes) for
+ * the 9 direct buttons, 4 (128 bytes) from 13 inputs up.
+ *
+ * The tables are compiled in place, with remapCompiling set throughout:
+ * the scan must not apply them then, as some nibbles would hold the old
+ * map and some the new one.
+ */
+
+#if BUTTON_COUNT < CONFIG_MAPPED_BUTTONS
+#define REMAP_NIBBLES ((BUTTON_COUNT + 3) / 4)
+#else
+#define REMAP_NIBBLES (CONFIG_MAPPED_BUTTONS / 4)
+#endif
+
+/// [Bitmap] Report bits for each value of each input nibble
+extern uint16_t remapTable[REMAP_NIBBLES][16];
+/// Set while Remap_Compile() is rewriting the tables
+extern volatile bool remapCompiling;
+
+void Remap_Compile(const uint8_t* map);
+
+/** [Bitmap] Map the first CONFIG_MAPPED_BUTTONS inputs to report bits */
+static inline uint16_t Remap_Apply(uint16_t inputs)
+{
+    uint16_t mapped = remapTable[0][inputs & 0x0F];
+
+#if REMAP_NIBBLES > 1
+    mapped |= remapTable[1][(inputs >> 4) & 0x0F];
+#endif
+#if REMAP_NIBBLES > 2
+    mapped |= remapTable[2][(inputs >> 8) & 0x0F];
+#endif
+#if REMAP_NIBBLES > 3
+    mapped |= remapTable[3][inputs >> 12];
+#endif
+
+    return mapped;
+}
+
+/** Input mapped to a report bit, or CONFIG_MAPPED_BUTTONS if none (the first one if several) */
+static inline uint8_t Remap_FindInput(uint8_t bit)
+{
+    uint8_t input;
+
+    for (input = 0; input < REMAP_NIBBLES * 4; input++)
+    {
+        if (remapTable[input >> 2][1 << (input & 0x03)] == (uint16_t) 1 << bit)
+          return input;
+    }
+
+    return CONFIG_MAPPED_BUTTONS;
+}
+
+#endif
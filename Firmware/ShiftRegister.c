@@ -0,0 +1,59 @@
+/*
+  Pop'n Convertible Arcade Style Controller Project
+ 
+  Copyright 2011 Sam Wong (Sam /@/ hellosam /./ net)
+
+  This work is licensed under the Creative Commons Attribution 3.0 
+  Hong Kong License. 
+
+  To view a copy of this license, visit 
+  http://creativecommons.org/licenses/by/3.0/hk/ or send a letter to 
+  Creative Commons, 444 Castro Street, Suite 900, 
+  Mountain View, California, 94041, USA.  
+*/
+
+#include "ShiftRegister.h"
+
+#include <LUFA/Drivers/Peripheral/SPI.h>
+
+#if SHIFT_REGISTER_COUNT < 1 || SHIFT_REGISTER_COUNT > 4
+#error SHIFT_REGISTER_COUNT must be 1 to 4.
+#endif
+
+/** Initialize SPI and the SH/LD latch line */
+void ShiftRegister_Init(void)
+{
+    // Sample on the rising edge: QH already holds input H after the load,
+    // and the register shifts the next bit out on that same edge
+    SPI_Init(SPI_SPEED_FCPU_DIV_2 | SPI_SCK_LEAD_RISING | SPI_SAMPLE_LEADING |
+             SPI_ORDER_MSB_FIRST | SPI_MODE_MASTER);
+
+    // SS as output keeps the SPI in master mode; idle high = shift mode
+    PORTB |= _BV(0);
+    DDRB  |= _BV(0);
+}
+
+/** [Bitmap] Read all inputs (active high), register n at bits 8n to 8n+7 */
+uint32_t ShiftRegister_Read(void)
+{
+    uint8_t data[4];
+    uint8_t i;
+
+    // Pulse SH/LD low to load the parallel inputs
+    PORTB &= ~_BV(0);
+    PORTB |=  _BV(0);
+
+    // Back-to-back transfers: start each byte as soon as the last completes.
+    // MSB first, so input H lands in bit 7 and input A in bit 0.
+    for (i = 0; i < SHIFT_REGISTER_COUNT; i++)
+    {
+        data[i] = ~SPI_ReceiveByte();
+    }
+    for (; i < 4; i++)
+    {
+        data[i] = 0;
+    }
+
+    return ((uint32_t) data[3] << 24) | ((uint32_t) data[2] << 16) |
+           ((uint16_t) data[1] << 8) | data[0];
+}
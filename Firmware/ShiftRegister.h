@@ -0,0 +1,43 @@
+/*
+  Pop'n Convertible Arcade Style Controller Project
+ 
+  Copyright 2011 Sam Wong (Sam /@/ hellosam /./ net)
+
+  This work is licensed under the Creative Commons Attribution 3.0 
+  Hong Kong License. 
+
+  To view a copy of this license, visit 
+  http://creativecommons.org/licenses/by/3.0/hk/ or send a letter to 
+  Creative Commons, 444 Castro Street, Suite 900, 
+  Mountain View, California, 94041, USA.  
+*/
+
+#ifndef _SHIFTREGISTER_H_
+#define _SHIFTREGISTER_H_
+
+#include <stdint.h>
+
+/** Chained 74HC165 parallel-in shift registers read over SPI.
+ *
+ * Wiring:
+ *  - PB0 (SS, driven as output) to SH/LD of every register
+ *  - PB1 (SCK) to CLK of every register, CLK INH tied low
+ *  - PB3 (MISO) to QH of the first register; QH of each register to SER
+ *    of the next, SER of the last register tied high
+ *  - Inputs A to H of register n are buttons 8n+1 to 8n+8, pulled up and
+ *    switched to ground like the direct buttons
+ *
+ * Timing at 8MHz with SCK = F_CPU/2: each byte is 16 cycles on the wire,
+ * plus ~7 cycles to collect it and start the next transfer, so 4 registers
+ * (32 inputs) take ~100 cycles = ~13us per scan including the latch pulse.
+ */
+
+/// Number of chained registers (1 to 4)
+#ifndef SHIFT_REGISTER_COUNT
+#define SHIFT_REGISTER_COUNT 4
+#endif
+
+void ShiftRegister_Init(void);
+uint32_t ShiftRegister_Read(void);
+
+#endif
@@ -0,0 +1,64 @@
+/*
+  Pop'n Convertible Arcade Style Controller Project
+ 
+  Copyright 2011 Sam Wong (Sam /@/ hellosam /./ net)
+
+  This work is licensed under the Creative Commons Attribution 3.0 
+  Hong Kong License. 
+
+  To view a copy of this license, visit 
+  http://creativecommons.org/licenses/by/3.0/hk/ or send a letter to 
+  Creative Commons, 444 Castro Street, Suite 900, 
+  Mountain View, California, 94041, USA.  
+*/
+
+#include "Stats.h"
+
+#include <util/atomic.h>
+#include <string.h>
+
+ButtonStats_t buttonStats[STATS_BUTTONS];
+
+/// First button of the page GET returns, selected by STATS_COMMAND_SEEK
+static uint8_t pageStart;
+
+/** Fill the selected page; a GET has no side effects, so a retry or a second reader sees the same page */
+
+void Stats_CreateFeatureReport(uint8_t* data)
+{
+    uint8_t count = STATS_BUTTONS - pageStart;
+
+    if (count > STATS_PAGE_BUTTONS)
+      count = STATS_PAGE_BUTTONS;
+
+    data[0] = pageStart;
+    data[1] = count;
+    data[2] = STATS_BUTTONS;
+
+    // The debounce stage updates the counters from the SOF interrupt
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        memcpy(&data[3], &buttonStats[pageStart], count * sizeof(ButtonStats_t));
+    }
+}
+
+void Stats_ProcessFeatureReport(const uint8_t* data, uint16_t size)
+{
+    if (size < 1)
+      return;
+
+    switch (data[0])
+    {
+        case STATS_COMMAND_CLEAR:
+            ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+            {
+                memset(buttonStats, 0, sizeof(buttonStats));
+            }
+            pageStart = 0;
+            break;
+        case STATS_COMMAND_SEEK:
+            if (size >= 2 && data[1] < STATS_BUTTONS)
+              pageStart = data[1];
+            break;
+    }
+}
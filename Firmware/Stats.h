@@ -0,0 +1,99 @@
+/*
+  Pop'n Convertible Arcade Style Controller Project
+ 
+  Copyright 2011 Sam Wong (Sam /@/ hellosam /./ net)
+
+  This work is licensed under the Creative Commons Attribution 3.0 
+  Hong Kong License. 
+
+  To view a copy of this license, visit 
+  http://creativecommons.org/licenses/by/3.0/hk/ or send a letter to 
+  Creative Commons, 444 Castro Street, Suite 900, 
+  Mountain View, California, 94041, USA.  
+*/
+
+#ifndef _STATS_H_
+#define _STATS_H_
+
+#include "PopnAsc.h"
+
+/** Per-button switch wear statistics, collected by the debounce stage.
+ *
+ * For each button: debounced presses, transitions rejected while the
+ * button was debouncing (bounce and chatter), and the longest bounce seen,
+ * i.e. the latest rejected transition after an accepted edge. All
+ * counters saturate instead of wrapping. A healthy switch has a chatter
+ * count that is a small fraction of its presses and a bounce well under
+ * the debounce time; a worn one shows both climbing.
+ *
+ * Updates only happen for buttons that are changing or debouncing, which
+ * the debounce stage visits anyway, and cost a few cycles each. Analog
+ * (hall-effect) buttons have no debounce stage and are not counted.
+ *
+ * Feature report (HID_REPORTID_STATS, STATS_FEATURE_REPORT_SIZE bytes), read
+ * in pages: a SET of STATS_COMMAND_SEEK selects the page, and every GET
+ * returns the selected one (the first after a clear or power-up), so a
+ * host reads button n onwards with a SEEK to n then a GET:
+ *  GET: Byte 0:   Index of the first button in this page
+ *       Byte 1:   Number of buttons in this page
+ *       Byte 2:   STATS_BUTTONS
+ *       Byte 3-:  ButtonStats_t of each button in the page
+ *  SET: Byte 0:   STATS_COMMAND_CLEAR (which also selects page 0), or
+ *                 STATS_COMMAND_SEEK with the page's first button index in
+ *                 byte 1
+ */
+
+/// Buttons with statistics, counted from button 0; 4 bytes of RAM each
+#ifndef STATS_BUTTONS
+#if BUTTON_COUNT > 16
+#define STATS_BUTTONS 16
+#else
+#define STATS_BUTTONS BUTTON_COUNT
+#endif
+#endif
+
+/// Feature report payload size, excluding the report ID
+#define STATS_FEATURE_REPORT_SIZE 32
+
+/// Button records per feature report page
+#define STATS_PAGE_BUTTONS ((STATS_FEATURE_REPORT_SIZE - 3) / sizeof(ButtonStats_t))
+
+/// Feature report SET commands
+#define STATS_COMMAND_CLEAR 0x01
+#define STATS_COMMAND_SEEK  0x02
+
+typedef struct
+{
+    /// Debounced presses
+    uint16_t Presses;
+    /// Transitions rejected during debounce
+    uint8_t Chatter;
+    /// Longest bounce, in milliseconds after the accepted edge
+    uint8_t MaxBounce;
+} ButtonStats_t;
+
+extern ButtonStats_t buttonStats[STATS_BUTTONS];
+
+/** Count a debounced press */
+static inline void Stats_Press(uint8_t button)
+{
+    if (button < STATS_BUTTONS && buttonStats[button].Presses != 0xFFFF)
+      buttonStats[button].Presses++;
+}
+
+/** Count a transition rejected the given milliseconds into the debounce */
+static inline void Stats_Bounce(uint8_t button, uint8_t elapsed)
+{
+    if (button >= STATS_BUTTONS)
+      return;
+
+    if (buttonStats[button].Chatter != 0xFF)
+      buttonStats[button].Chatter++;
+    if (elapsed > buttonStats[button].MaxBounce)
+      buttonStats[button].MaxBounce = elapsed;
+}
+
+void Stats_CreateFeatureReport(uint8_t* data);
+void Stats_ProcessFeatureReport(const uint8_t* data, uint16_t size);
+
+#endif
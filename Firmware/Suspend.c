@@ -0,0 +1,125 @@
+/*
+  Pop'n Convertible Arcade Style Controller Project
+ 
+  Copyright 2011 Sam Wong (Sam /@/ hellosam /./ net)
+
+  This work is licensed under the Creative Commons Attribution 3.0 
+  Hong Kong License. 
+
+  To view a copy of this license, visit 
+  http://creativecommons.org/licenses/by/3.0/hk/ or send a letter to 
+  Creative Commons, 444 Castro Street, Suite 900, 
+  Mountain View, California, 94041, USA.  
+*/
+
+#include "Suspend.h"
+
+#include <LUFA/Drivers/USB/USB.h>
+
+#include <avr/io.h>
+#include <avr/sleep.h>
+#include <avr/interrupt.h>
+
+#if !defined(SHIFT_REGISTER_INPUTS) && !defined(HALL_INPUTS) && !defined(MATRIX_INPUTS)
+/// The buttons are on PB0-PB7 (PCINT0-7) and PC7 (INT4), and can wake the CPU
+#define SUSPEND_BUTTON_WAKE
+#endif
+
+/// Set by the button wake interrupts
+static volatile bool buttonWake;
+
+#if defined(SUSPEND_BUTTON_WAKE)
+/// Remote wakeup sent; only the host's resume is waited for until it comes
+static bool wakeupSent;
+
+/// Bit of PC7 (INT4) in Suspend_ButtonsDown(), after PB0-PB7
+#define SUSPEND_PC7_DOWN 0x100
+
+/** Buttons pressed, PB0-PB7 then PC7. Pins are active low. */
+static inline uint16_t Suspend_ButtonsDown(void)
+{
+    return (uint8_t) ~PINB | ((PINC & _BV(7)) ? 0 : SUSPEND_PC7_DOWN);
+}
+
+ISR(PCINT0_vect, ISR_BLOCK)
+{
+    PCICR &= ~_BV(PCIE0);
+    buttonWake = true;
+}
+
+/** Level triggered, so it has to disarm itself */
+ISR(INT4_vect, ISR_BLOCK)
+{
+    EIMSK &= ~_BV(INT4);
+    buttonWake = true;
+}
+#endif
+
+/** Power down until the host resumes the bus, or a button wakes it up. Never waits once resumed. */
+void Suspend_Sleep(void)
+{
+#if defined(SUSPEND_BUTTON_WAKE)
+    // Buttons already held when the bus went idle do not wake the host
+    uint16_t heldAtEntry = Suspend_ButtonsDown();
+#endif
+
+    buttonWake = false;
+
+#if defined(SUSPEND_BUTTON_WAKE)
+    if (!wakeupSent)
+    {
+        PCMSK0 = 0xFF;
+        PCIFR  = _BV(PCIF0);
+        PCICR |= _BV(PCIE0);
+
+        // Low level is the only INT4 sense that works without the I/O clock,
+        // so with PC7 held it would fire at once, and again on every call.
+        // It is armed on a later call, once PC7 is seen released.
+        if (!(heldAtEntry & SUSPEND_PC7_DOWN))
+        {
+            EICRB &= ~(_BV(ISC41) | _BV(ISC40));
+            EIFR   = _BV(INTF4);
+            EIMSK |= _BV(INT4);
+        }
+    }
+#endif
+
+    set_sleep_mode(SLEEP_MODE_PWR_DOWN);
+
+    // Interrupts are enabled right before the sleep instruction, so a wake
+    // between the check and the sleep is not lost
+    cli();
+    while (USB_DeviceState == DEVICE_STATE_Suspended && !buttonWake)
+    {
+        sleep_enable();
+        sei();
+        sleep_cpu();
+        sleep_disable();
+        cli();
+    }
+    sei();
+
+    // Before any return: the deadline scheduler sleeps in idle mode, and
+    // power-down would stop the USB interrupts that wake it
+    set_sleep_mode(SLEEP_MODE_IDLE);
+
+#if defined(SUSPEND_BUTTON_WAKE)
+    PCICR &= ~_BV(PCIE0);
+    EIMSK &= ~_BV(INT4);
+
+    if (USB_DeviceState != DEVICE_STATE_Suspended)
+    {
+        wakeupSent = false;
+        return;
+    }
+
+    // Only a new press wakes the host, not a release, a glitch or a button
+    // held since before the suspend; the main loop calls back after a
+    // release, so a held button wakes once released and pressed again
+    if (buttonWake && USB_RemoteWakeupEnabled && (Suspend_ButtonsDown() & ~heldAtEntry))
+    {
+        USB_Device_SendRemoteWakeup();
+        wakeupSent = true;
+    }
+#endif
+}
@@ -0,0 +1,42 @@
+/*
+  Pop'n Convertible Arcade Style Controller Project
+ 
+  Copyright 2011 Sam Wong (Sam /@/ hellosam /./ net)
+
+  This work is licensed under the Creative Commons Attribution 3.0 
+  Hong Kong License. 
+
+  To view a copy of this license, visit 
+  http://creativecommons.org/licenses/by/3.0/hk/ or send a letter to 
+  Creative Commons, 444 Castro Street, Suite 900, 
+  Mountain View, California, 94041, USA.  
+*/
+
+#ifndef _SUSPEND_H_
+#define _SUSPEND_H_
+
+#include <stdbool.h>
+
+/** Power-down while the host has the bus suspended, and remote wakeup.
+ *
+ * The main loop calls Suspend_Sleep() once LUFA reports the suspended
+ * state. By then the USB clock is frozen and the PLL is off. The CPU
+ * powers down, which also stops the scheduler, scan and telemetry timers,
+ * until either the host resumes the bus (the USB wakeup interrupt) or a
+ * button is pressed. A press sends a remote wakeup if the host enabled
+ * it; the button is then debounced and reported from the first frames
+ * after the resume, like any other press.
+ *
+ * Button wake needs the inputs on pin change or level interrupts, which
+ * only the direct PB0-PB7/PC7 wiring has (PCINT0-7 and INT4). With the
+ * other input backends only the host can end the suspend.
+ *
+ * Only a button pressed after the suspend wakes the host. One held through
+ * it has to be released and pressed again. INT4 is level triggered, so it
+ * stays disarmed while PC7 is held: releasing PC7 is not seen until
+ * another button changes or the host resumes.
+ */
+
+void Suspend_Sleep(void);
+
+#endif
@@ -0,0 +1,113 @@
+/*
+  Pop'n Convertible Arcade Style Controller Project
+ 
+  Copyright 2011 Sam Wong (Sam /@/ hellosam /./ net)
+
+  This work is licensed under the Creative Commons Attribution 3.0 
+  Hong Kong License. 
+
+  To view a copy of this license, visit 
+  http://creativecommons.org/licenses/by/3.0/hk/ or send a letter to 
+  Creative Commons, 444 Castro Street, Suite 900, 
+  Mountain View, California, 94041, USA.  
+*/
+
+#include "Telemetry.h"
+#include "Network.h"
+
+#include <LUFA/Drivers/Peripheral/SerialBuffered.h>
+
+#include <util/crc16.h>
+#include <string.h>
+
+/// Telemetry frames which could not be queued in full
+static uint16_t framesDropped;
+
+/** Initialize the telemetry UART */
+void Telemetry_Init(void)
+{
+    SerialBuffered_Init(TELEMETRY_BAUD, true);
+    framesDropped = 0;
+}
+
+/** Queue one telemetry frame, or drop it whole if the UART buffer is full.
+ *  A payload over TELEMETRY_MAX_PAYLOAD is dropped and counted too.
+ *  Must only be called from one context (the SOF event).
+ */
+void Telemetry_SendFrame(uint8_t type, const uint8_t* payload, uint8_t length)
+{
+    uint8_t frame[TELEMETRY_MAX_PAYLOAD + 4];
+    uint8_t crc = 0;
+    uint8_t i;
+
+    if (length > TELEMETRY_MAX_PAYLOAD)
+    {
+        if (framesDropped != 0xFFFF)
+        {
+            framesDropped++;
+        }
+        return;
+    }
+
+    frame[0] = TELEMETRY_SYNC;
+    frame[1] = type;
+    frame[2] = length;
+    memcpy(&frame[3], payload, length);
+
+    for (i = 1; i < length + 3; i++)
+    {
+        crc = _crc_ibutton_update(crc, frame[i]);
+    }
+    frame[length + 3] = crc;
+
+#if defined(NETWORK_ENABLED)
+    if (!Network_QueueFrame(frame, length + 4))
+#else
+    if (!SerialBuffered_SendData(frame, length + 4))
+#endif
+    {
+        if (framesDropped != 0xFFFF)
+        {
+            framesDropped++;
+        }
+    }
+}
+
+/** Report a debounced button edge */
+void Telemetry_SendButtonEdge(uint16_t frameNumber, const void* state, const void* change, uint8_t size)
+{
+    uint8_t payload[TELEMETRY_MAX_PAYLOAD];
+
+    if (2 + 2 * size > TELEMETRY_MAX_PAYLOAD)
+      return;
+
+    payload[0] = frameNumber & 0xFF;
+    payload[1] = (frameNumber >> 8) & 0xFF;
+    memcpy(&payload[2], state, size);
+    memcpy(&payload[2 + size], change, size);
+
+    Telemetry_SendFrame(TELEMETRY_FRAME_BUTTON_EDGE, payload, 2 + 2 * size);
+}
+
+/** Called on every USB frame; sends the status frame every 1024 frames */
+void Telemetry_StartOfFrame(uint16_t frameNumber)
+{
+    SerialBuffered_Counters_t counters;
+    uint8_t payload[6];
+
+    if ((frameNumber & 0x3FF) != 0)
+    {
+        return;
+    }
+
+    SerialBuffered_GetCounters(&counters);
+
+    payload[0] = framesDropped & 0xFF;
+    payload[1] = (framesDropped >> 8) & 0xFF;
+    payload[2] = counters.RxDropped & 0xFF;
+    payload[3] = (counters.RxDropped >> 8) & 0xFF;
+    payload[4] = counters.RxOverruns & 0xFF;
+    payload[5] = (counters.RxOverruns >> 8) & 0xFF;
+
+    Telemetry_SendFrame(TELEMETRY_FRAME_STATUS, payload, sizeof(payload));
+}
@@ -0,0 +1,75 @@
+/*
+  Pop'n Convertible Arcade Style Controller Project
+ 
+  Copyright 2011 Sam Wong (Sam /@/ hellosam /./ net)
+
+  This work is licensed under the Creative Commons Attribution 3.0 
+  Hong Kong License. 
+
+  To view a copy of this license, visit 
+  http://creativecommons.org/licenses/by/3.0/hk/ or send a letter to 
+  Creative Commons, 444 Castro Street, Suite 900, 
+  Mountain View, California, 94041, USA.  
+*/
+
+#ifndef _TELEMETRY_H_
+#define _TELEMETRY_H_
+
+#include <stdint.h>
+
+/** Telemetry frames are sent on the UART (TXD1), or with NETWORK_ENABLED
+ * as UDP datagrams (see Network.h), as:
+ *
+ * Byte 0:      TELEMETRY_SYNC
+ * Byte 1:      Frame type
+ * Byte 2:      Payload length N
+ * Byte 3..N+2: Payload (multi-byte fields are little endian)
+ * Byte N+3:    CRC-8 (Dallas/Maxim, as _crc_ibutton_update) of bytes 1 to N+2
+ *
+ * A frame is either queued whole or dropped whole, so the stream never
+ * contains a truncated frame.
+ */
+
+/// Telemetry UART baud rate. 1M baud is exact at 8MHz in double speed mode.
+#ifndef TELEMETRY_BAUD
+#define TELEMETRY_BAUD 1000000
+#endif
+
+/// First byte of every telemetry frame
+#define TELEMETRY_SYNC 0xA5
+
+/// Largest payload a telemetry frame may carry: a button edge of 64 inputs
+#define TELEMETRY_MAX_PAYLOAD (2 + 2 * 8)
+
+/** TELEMETRY_FRAME_BUTTON_EDGE payload, for an N byte button bitmap
+ * (N = 2, 4 or 8 depending on the number of inputs; len = 2 + 2N):
+ * Byte 0-1:        USB frame number of the scan that saw the edge
+ * Byte 2-(N+1):    [Bitmap] Debounced button state after the edge (active high)
+ * Byte (N+2)-2N+1: [Bitmap] Buttons which changed state
+ */
+#define TELEMETRY_FRAME_BUTTON_EDGE 0x01
+
+/** TELEMETRY_FRAME_STATUS payload, sent about once a second:
+ * Byte 0-1: Telemetry frames dropped because the UART buffer (or network
+ *           queue) was full, or the payload was too long
+ * Byte 2-3: UART bytes dropped on receive
+ * Byte 4-5: UART hardware receive overruns
+ */
+#define TELEMETRY_FRAME_STATUS 0x02
+
+/** TELEMETRY_FRAME_BOOT payload, sent once after the first report:
+ * Byte 0-15: uint32 microseconds to each BOOT_MARK_*, see Boot.h
+ */
+#define TELEMETRY_FRAME_BOOT 0x03
+
+/** TELEMETRY_FRAME_RESET payload, sent once with the boot frame:
+ * Byte 0-5: WatchdogReport_t of the last reset, see Watchdog.h
+ */
+#define TELEMETRY_FRAME_RESET 0x04
+
+void Telemetry_Init(void);
+void Telemetry_SendFrame(uint8_t type, const uint8_t* payload, uint8_t length);
+void Telemetry_SendButtonEdge(uint16_t frameNumber, const void* state, const void* change, uint8_t size);
+void Telemetry_StartOfFrame(uint16_t frameNumber);
+
+#endif
@@ -0,0 +1,314 @@
+/** ConfigDrive.c: the drive as a host sees it.
+ *
+ * SCSI commands go through the firmware's command callback, with the
+ * data moving through the emulated endpoint bank (see Host/Usb.h), as
+ * LUFA's mass storage driver would run them.
+ *
+ * Mount: the whole volume is read and taken apart as a FAT driver would.
+ * The boot sector's BPB must describe a FAT12 volume matching the reported
+ * capacity. The FAT must hold the media entries, a chain for CONFIG.TXT
+ * long enough for its size, and nothing else. The root directory must
+ * hold the volume label and CONFIG.TXT. The file must have one line per
+ * field with the active value.
+ *
+ * Write: CONFIG.TXT is edited and written back, in place and at another
+ * cluster, as hosts do. Only the lines that parse may change the staged
+ * configuration, and writes to the FAT and directory must change nothing.
+ * The file read back must then show the new values.
+ */
+
+#include "Host/Host.h"
+#include "Host/Usb.h"
+
+// The firmware file itself, for its static command handler and fields
+#include "../ConfigDrive.c"
+
+/// FAT12 bounds, after the Microsoft FAT specification
+#define FAT12_MAX_CLUSTERS 4084
+#define FAT12_END_OF_CHAIN 0xFF8
+
+/// What the USB core would provide; control requests are not sent
+volatile uint8_t USB_DeviceState = DEVICE_STATE_Configured;
+USB_Request_Header_t USB_ControlRequest;
+
+void USB_USBTask(void)
+{
+}
+
+/// The configuration in use, and the applies the drive asked for
+static Config_t active;
+static uint8_t applies;
+
+const Config_t* Config_GetActive(void)
+{
+    return &active;
+}
+
+uint8_t Config_Apply(const Config_t* config)
+{
+    active = *config;
+    applies++;
+
+    return CONFIG_STATUS_OK;
+}
+
+void Watchdog_Progress(uint8_t operation)
+{
+}
+
+/// Volume image as read over USB
+static uint8_t image[CONFIG_DRIVE_BLOCKS * CONFIG_DRIVE_BLOCK_SIZE];
+
+static uint16_t Get16(const uint8_t* data)
+{
+    return data[0] | (data[1] << 8);
+}
+
+static uint32_t Get32(const uint8_t* data)
+{
+    return Get16(data) | ((uint32_t) Get16(data + 2) << 16);
+}
+
+/** Run a SCSI command with OUT data, if any; returns the command status and the IN data */
+static bool Command(const uint8_t* cdb, uint32_t transferLength, const void* out, uint8_t** in, uint32_t* inLength)
+{
+    bool success;
+
+    Host_UsbReset();
+    if (out)
+      Host_UsbSendOut(out, transferLength);
+
+    memset(&ConfigDrive_MS_Interface.State, 0, sizeof(ConfigDrive_MS_Interface.State));
+    memcpy(ConfigDrive_MS_Interface.State.CommandBlock.SCSICommandData, cdb, 16);
+    ConfigDrive_MS_Interface.State.CommandBlock.DataTransferLength = transferLength;
+
+    UECFG0X = out ? 0 : ENDPOINT_DIR_IN;
+    success = CALLBACK_MS_Device_SCSICommandReceived(&ConfigDrive_MS_Interface);
+
+    // Every byte the host sent is taken, and the residue matches what moved
+    *inLength = Host_UsbReceive(in);
+    HOST_CHECK(!success || Host_UsbPending() == 0);
+    HOST_CHECK(!success || ConfigDrive_MS_Interface.State.CommandBlock.DataTransferLength ==
+                           transferLength - (out ? transferLength : *inLength));
+
+    return success;
+}
+
+/** READ (10) or WRITE (10) of whole blocks */
+static bool Transfer(bool isRead, uint32_t block, uint16_t count, void* data)
+{
+    uint8_t cdb[16] = { isRead ? SCSI_CMD_READ_10 : SCSI_CMD_WRITE_10, 0,
+                        block >> 24, block >> 16, block >> 8, block, 0, count >> 8, count };
+    uint8_t* in;
+    uint32_t inLength;
+    bool success;
+
+    success = Command(cdb, (uint32_t) count * CONFIG_DRIVE_BLOCK_SIZE, isRead ? NULL : data, &in, &inLength);
+
+    if (isRead && success)
+    {
+        HOST_CHECK(inLength == (uint32_t) count * CONFIG_DRIVE_BLOCK_SIZE);
+        memcpy(data, in, inLength);
+    }
+
+    return success;
+}
+
+/// Volume layout, as found from the boot sector
+typedef struct
+{
+    uint32_t FatStart;
+    uint32_t RootStart;
+    uint32_t DataStart;
+    uint32_t Clusters;
+    uint32_t FileCluster;
+    uint32_t FileSize;
+    uint32_t FileOffset;
+} Volume_t;
+
+/** FAT12 entry of a cluster */
+static uint16_t FatEntry(const Volume_t* volume, uint16_t cluster)
+{
+    uint16_t pair = Get16(&image[volume->FatStart + cluster + cluster / 2]);
+
+    return (cluster & 1) ? (pair >> 4) : (pair & 0x0FFF);
+}
+
+/** Read the whole volume and check its structure, as a FAT driver mounting it would */
+static void Mount(Volume_t* volume)
+{
+    uint8_t cdb[16] = { SCSI_CMD_READ_CAPACITY_10 };
+    uint8_t* in;
+    uint32_t inLength;
+
+    // Capacity: last block and block size, big endian
+    HOST_CHECK(Command(cdb, 8, NULL, &in, &inLength));
+    HOST_CHECK(inLength == 8);
+    HOST_CHECK(((in[2] << 8) | in[3]) == CONFIG_DRIVE_BLOCKS - 1);
+    HOST_CHECK(((in[6] << 8) | in[7]) == CONFIG_DRIVE_BLOCK_SIZE);
+
+    HOST_CHECK(Transfer(true, 0, CONFIG_DRIVE_BLOCKS, image));
+
+    // Boot sector
+    const uint8_t* boot = image;
+    uint16_t bytesPerSector = Get16(&boot[11]);
+    uint8_t sectorsPerCluster = boot[13];
+    uint16_t reserved = Get16(&boot[14]);
+    uint8_t fats = boot[16];
+    uint16_t rootEntries = Get16(&boot[17]);
+    uint32_t totalSectors = Get16(&boot[19]) ? Get16(&boot[19]) : Get32(&boot[32]);
+    uint16_t sectorsPerFat = Get16(&boot[22]);
+    uint32_t rootSectors = (rootEntries * 32 + bytesPerSector - 1) / bytesPerSector;
+
+    HOST_CHECK(boot[0] == 0xEB || boot[0] == 0xE9);
+    HOST_CHECK(boot[510] == 0x55 && boot[511] == 0xAA);
+    HOST_CHECK(bytesPerSector == CONFIG_DRIVE_BLOCK_SIZE);
+    HOST_CHECK(sectorsPerCluster != 0 && (sectorsPerCluster & (sectorsPerCluster - 1)) == 0);
+    HOST_CHECK(reserved >= 1 && fats >= 1 && sectorsPerFat >= 1);
+    HOST_CHECK(totalSectors == CONFIG_DRIVE_BLOCKS);
+    HOST_CHECK(boot[21] == image[reserved * bytesPerSector]);
+    HOST_CHECK(boot[38] == 0x29 && memcmp(&boot[54], "FAT12   ", 8) == 0);
+
+    volume->FatStart  = reserved * bytesPerSector;
+    volume->RootStart = (reserved + fats * sectorsPerFat) * bytesPerSector;
+    volume->DataStart = volume->RootStart + rootSectors * bytesPerSector;
+    volume->Clusters  = (totalSectors - volume->DataStart / bytesPerSector) / sectorsPerCluster;
+
+    // The cluster count alone makes a volume FAT12, and the FAT must hold every entry
+    HOST_CHECK(volume->Clusters >= 1 && volume->Clusters <= FAT12_MAX_CLUSTERS);
+    HOST_CHECK((volume->Clusters + 2) * 3 / 2 <= (uint32_t) sectorsPerFat * bytesPerSector);
+    HOST_CHECK(FatEntry(volume, 0) == (0xF00 | boot[21]));
+    HOST_CHECK(FatEntry(volume, 1) >= FAT12_END_OF_CHAIN);
+
+    // Root directory: the label, then CONFIG.TXT
+    bool labelFound = false;
+    bool fileFound = false;
+
+    for (uint16_t entry = 0; entry < rootEntries; entry++)
+    {
+        const uint8_t* dir = &image[volume->RootStart + entry * 32];
+
+        if (dir[0] == 0x00)
+          break;
+        if (dir[0] == 0xE5)
+          continue;
+
+        if (dir[11] & 0x08)
+        {
+            HOST_CHECK(memcmp(dir, &boot[43], 11) == 0);
+            labelFound = true;
+        }
+        else
+        {
+            HOST_CHECK(memcmp(dir, "CONFIG  TXT", 11) == 0 && !(dir[11] & 0x10));
+            volume->FileCluster = Get16(&dir[26]);
+            volume->FileSize    = Get32(&dir[28]);
+            fileFound = true;
+        }
+    }
+    HOST_CHECK(labelFound && fileFound);
+    HOST_CHECK(volume->FileSize == DRIVE_FILE_SIZE);
+
+    // The chain of CONFIG.TXT covers its size, and every other cluster is free
+    uint32_t clusterBytes = (uint32_t) sectorsPerCluster * bytesPerSector;
+    uint32_t chainLength = 0;
+    uint16_t cluster = volume->FileCluster;
+    bool used[FAT12_MAX_CLUSTERS + 2] = { false };
+
+    while (cluster < FAT12_END_OF_CHAIN)
+    {
+        HOST_CHECK(cluster >= 2 && cluster < volume->Clusters + 2 && !used[cluster]);
+        used[cluster] = true;
+        chainLength++;
+        cluster = FatEntry(volume, cluster);
+    }
+    HOST_CHECK(chainLength == (volume->FileSize + clusterBytes - 1) / clusterBytes);
+
+    for (cluster = 2; cluster < volume->Clusters + 2; cluster++)
+      HOST_CHECK(used[cluster] || FatEntry(volume, cluster) == 0);
+
+    volume->FileOffset = volume->DataStart + (volume->FileCluster - 2) * clusterBytes;
+
+    printf("mount: FAT12, %u clusters, CONFIG.TXT %u bytes in cluster %u\n",
+           (unsigned) volume->Clusters, (unsigned) volume->FileSize, (unsigned) volume->FileCluster);
+}
+
+/** CONFIG.TXT must be exactly one "NAME=value" line per field, with the active values */
+static void CheckFile(const Volume_t* volume)
+{
+    const char* file = (const char*) &image[volume->FileOffset];
+    uint8_t field;
+
+    for (field = 0; field < sizeof(fields) / sizeof(fields[0]); field++)
+    {
+        const char* line = &file[field * DRIVE_LINE_LENGTH];
+        char expected[DRIVE_LINE_LENGTH + 1];
+
+        snprintf(expected, sizeof(expected), "%-*.*s=%03u\r\n", DRIVE_NAME_LENGTH, DRIVE_NAME_LENGTH, fields[field].Name,
+                 ((const uint8_t*) &active)[fields[field].Offset]);
+        HOST_CHECK(memcmp(line, expected, DRIVE_LINE_LENGTH) == 0);
+    }
+}
+
+/** Write a file of the given text to a block, as a host saving the edited file */
+static void WriteFile(uint32_t block, const char* text)
+{
+    uint8_t data[CONFIG_DRIVE_BLOCK_SIZE] = { 0 };
+
+    memcpy(data, text, strlen(text));
+    HOST_CHECK(Transfer(false, block, 1, data));
+}
+
+int main(void)
+{
+    Volume_t volume;
+    Config_t before;
+
+    memset(&active, 0, sizeof(active));
+    active.Version          = CONFIG_VERSION;
+    active.DebounceDownTime = 20;
+    active.DebounceUpTime   = 5;
+    for (uint8_t input = 0; input < CONFIG_MAPPED_BUTTONS; input++)
+      active.ButtonMap[input] = (input < 9) ? input : CONFIG_UNMAPPED;
+    active.HallActuation    = 128;
+    active.HallSensitivity  = 16;
+
+    Mount(&volume);
+    CheckFile(&volume);
+
+    // Edited in place, with a stray line, a bad value and an unknown name
+    before = active;
+    WriteFile(DRIVE_DATA_BLOCK,
+              "DEBOUNCE_DOWN_MS=007\r\n"
+              "MAP_INPUT_03    =012\r\n"
+              "  HALL_ACTUATION = 200\n"
+              "DEBOUNCE_UP_MS=300\r\n"
+              "NOT_A_FIELD=001\r\n"
+              "garbage\r\n"
+              "REPORT_MODE=1x\r\n");
+    HOST_CHECK(applies == 1);
+    before.DebounceDownTime = 7;
+    before.ButtonMap[2]     = 12;
+    before.HallActuation    = 200;
+    HOST_CHECK(memcmp(&active, &before, sizeof(before)) == 0);
+
+    // Saved to a new cluster, as some hosts do, with the last line unterminated
+    WriteFile(DRIVE_DATA_BLOCK + 10, "DEBOUNCE_UP_MS=009");
+    HOST_CHECK(applies == 2 && active.DebounceUpTime == 9);
+
+    // The FAT and directory updates that follow change nothing
+    memset(image, 0x41, CONFIG_DRIVE_BLOCK_SIZE);
+    HOST_CHECK(Transfer(false, DRIVE_FAT_BLOCK, 2, image));
+    HOST_CHECK(applies == 2);
+
+    // Out of range
+    HOST_CHECK(!Transfer(true, CONFIG_DRIVE_BLOCKS - 1, 2, image));
+    HOST_CHECK(senseKey == SCSI_SENSE_KEY_ILLEGAL_REQUEST);
+
+    Mount(&volume);
+    CheckFile(&volume);
+
+    printf("write: in place and in another cluster, bad lines ignored\n");
+    printf("ConfigDrive: OK\n");
+    return 0;
+}
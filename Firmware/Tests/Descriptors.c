@@ -0,0 +1,151 @@
+/*
+  Pop'n Convertible Arcade Style Controller Project
+ 
+  Copyright 2011 Sam Wong (Sam /@/ hellosam /./ net)
+
+  This work is licensed under the Creative Commons Attribution 3.0 
+  Hong Kong License. 
+
+  To view a copy of this license, visit 
+  http://creativecommons.org/licenses/by/3.0/hk/ or send a letter to 
+  Creative Commons, 444 Castro Street, Suite 900, 
+  Mountain View, California, 94041, USA.  
+*/
+
+/** Descriptors.c: the generated button reports, as a host parses them.
+ *
+ * KeyboardReport and Player2Report, as CALLBACK_USB_GetDescriptor() hands
+ * them out, go through LUFA's USB_ProcessHIDReport(). Each button of the
+ * ButtonLayout.h tables must come out as a one-bit input of its usage at
+ * its table index, and each report must be its buttons padded to whole
+ * bytes. Every feature report of the vendor collection must be 32 bytes,
+ * and the lengths in the HID class descriptors must match the reports.
+ *
+ * The feature reports are 32 one-byte items each, which is far beyond
+ * LUFA's default HID_MAX_REPORTITEMS of 20; the makefile raises it for
+ * this test, and an #error below keeps it high enough.
+ */
+
+#include "Host/Host.h"
+
+#include "../Descriptors.h"
+#include "../Config.h"
+
+#include <LUFA/Drivers/USB/Class/Common/HIDParser.h>
+
+/// Feature reports of the vendor collection, as in KeyboardReport
+static const uint8_t featureReportIDs[] =
+{
+    HID_REPORTID_CONFIG,
+    HID_REPORTID_STATS,
+    HID_REPORTID_MEMORY,
+#if defined(PASSTHROUGH_INPUTS)
+    HID_REPORTID_PASSTHROUGH,
+#endif
+    HID_REPORTID_WATCHDOG,
+    HID_REPORTID_SCHEDULER,
+#if defined(MIDI_ENABLED)
+    HID_REPORTID_MIDI,
+#endif
+};
+
+#define FEATURE_REPORT_COUNT sizeof(featureReportIDs)
+
+/// The most KeyboardReport can have: every feature report, each of 32 one-byte items
+#define MAX_REPORT_ITEMS (PLAYER1_BUTTON_COUNT + 7 * CONFIG_FEATURE_REPORT_SIZE)
+
+// LUFA counts report items in a uint8_t, so 255 is the most it can take
+#if HID_MAX_REPORTITEMS < MAX_REPORT_ITEMS || MAX_REPORT_ITEMS > 255
+#error HID_MAX_REPORTITEMS is too low for KeyboardReport and its feature reports.
+#endif
+
+#define BUTTON_USAGE(Usage) (Usage),
+
+static const uint8_t player1Usages[] = { PLAYER1_BUTTONS(BUTTON_USAGE) };
+#if defined(TWO_PLAYER_ENABLED)
+static const uint8_t player2Usages[] = { PLAYER2_BUTTONS(BUTTON_USAGE) };
+#endif
+
+extern const USB_Descriptor_Configuration_t ConfigurationDescriptor;
+
+static HID_ReportInfo_t info;
+
+bool CALLBACK_HIDParser_FilterHIDReportItem(HID_ReportItem_t* const CurrentItem)
+{
+    return true;
+}
+
+/** Fetch a report descriptor as the host would, and parse it */
+static uint16_t Parse(const uint8_t interface)
+{
+    const void* address;
+    uint16_t size = CALLBACK_USB_GetDescriptor(HID_DTYPE_Report << 8, interface, &address);
+
+    HOST_CHECK(size != NO_DESCRIPTOR);
+    HOST_CHECK(USB_ProcessHIDReport(address, size, &info) == HID_PARSE_Successful);
+    return size;
+}
+
+/** Check a parsed report's button inputs against its table */
+static void CheckButtons(const uint8_t reportID, const uint8_t* usages, const uint8_t count)
+{
+    uint8_t found = 0;
+
+    for (uint8_t i = 0; i < info.TotalReportItems; i++)
+    {
+        const HID_ReportItem_t* item = &info.ReportItems[i];
+
+        if (item->ItemType != HID_REPORT_ITEM_In)
+          continue;
+
+        HOST_CHECK(item->ReportID == reportID);
+        HOST_CHECK(found < count);
+        HOST_CHECK(item->BitOffset == found);
+        HOST_CHECK(item->Attributes.BitSize == 1);
+        HOST_CHECK(item->Attributes.Usage.Page == 0x07);
+        HOST_CHECK(item->Attributes.Usage.Usage == usages[found]);
+        HOST_CHECK(item->Attributes.Logical.Minimum == 0 && item->Attributes.Logical.Maximum == 1);
+        found++;
+    }
+
+    HOST_CHECK(found == count);
+    HOST_CHECK(USB_GetHIDReportSize(&info, reportID, HID_REPORT_ITEM_In) == BUTTON_REPORT_BYTES(count));
+    HOST_CHECK(USB_GetHIDReportSize(&info, reportID, HID_REPORT_ITEM_Out) == 0);
+}
+
+int main(void)
+{
+    uint16_t size;
+
+    // Player 1, with the feature reports
+    size = Parse(ConfigurationDescriptor.HID_Interface.InterfaceNumber);
+    HOST_CHECK(size == ConfigurationDescriptor.HID_KeyboardHID.HIDReportLength);
+    CheckButtons(HID_REPORTID_BUTTONS, player1Usages, PLAYER1_BUTTON_COUNT);
+    HOST_CHECK(USB_GetHIDReportSize(&info, HID_REPORTID_BUTTONS, HID_REPORT_ITEM_Feature) == 0);
+    HOST_CHECK(info.TotalReportItems == PLAYER1_BUTTON_COUNT + FEATURE_REPORT_COUNT * CONFIG_FEATURE_REPORT_SIZE);
+
+    for (uint8_t i = 0; i < FEATURE_REPORT_COUNT; i++)
+    {
+        HOST_CHECK(USB_GetHIDReportSize(&info, featureReportIDs[i], HID_REPORT_ITEM_Feature) == CONFIG_FEATURE_REPORT_SIZE);
+        HOST_CHECK(USB_GetHIDReportSize(&info, featureReportIDs[i], HID_REPORT_ITEM_In) == 0);
+    }
+
+    printf("KeyboardReport: %u bytes, %u buttons in %u report bytes, %u feature reports of %u bytes\n",
+           size, PLAYER1_BUTTON_COUNT, BUTTON_REPORT_BYTES(PLAYER1_BUTTON_COUNT),
+           (unsigned) FEATURE_REPORT_COUNT, CONFIG_FEATURE_REPORT_SIZE);
+
+#if defined(TWO_PLAYER_ENABLED)
+    // Player 2, without a report ID
+    size = Parse(PLAYER2_INTERFACE);
+    HOST_CHECK(size == ConfigurationDescriptor.Player2_KeyboardHID.HIDReportLength);
+    HOST_CHECK(!info.UsingReportIDs);
+    CheckButtons(0, player2Usages, PLAYER2_BUTTON_COUNT);
+    HOST_CHECK(info.TotalReportItems == PLAYER2_BUTTON_COUNT);
+
+    printf("Player2Report: %u bytes, %u buttons in %u report bytes\n",
+           size, PLAYER2_BUTTON_COUNT, BUTTON_REPORT_BYTES(PLAYER2_BUTTON_COUNT));
+#endif
+
+    printf("Descriptors: OK\n");
+    return 0;
+}
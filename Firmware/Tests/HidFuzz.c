@@ -0,0 +1,288 @@
+/*
+  Pop'n Convertible Arcade Style Controller Project
+ 
+  Copyright 2011 Sam Wong (Sam /@/ hellosam /./ net)
+
+  This work is licensed under the Creative Commons Attribution 3.0 
+  Hong Kong License. 
+
+  To view a copy of this license, visit 
+  http://creativecommons.org/licenses/by/3.0/hk/ or send a letter to 
+  Creative Commons, 444 Castro Street, Suite 900, 
+  Mountain View, California, 94041, USA.  
+*/
+
+/** HidFuzz.c: random requests through the HID class driver's control path.
+ *
+ * GET_REPORT: random report IDs, sizes and wLength. The reply must be the
+ * report the callback built, with its ID first, cut to wLength, and the
+ * report buffer must never be overrun.
+ *
+ * SET_REPORT: random report IDs and types, lengths of up to several times
+ * the report buffer, random data, and about a quarter of them abandoned
+ * by the host part way through. Every callback must get the next chunk of
+ * what the host sent, at its offset, never more than the buffer. And
+ * HID_Device_IsWholeReport(), which the firmware applies reports by, must
+ * hold for exactly one call of each complete report that fits the buffer
+ * with all of it, and for no other call: not for the first chunk of a
+ * longer report, and not for anything of an abandoned one.
+ */
+
+#include "Host/Host.h"
+#include "Host/Usb.h"
+
+#include <LUFA/Drivers/USB/USB.h>
+
+#include <string.h>
+
+/// Requests of each kind
+#define REQUESTS 200000UL
+
+/// As the firmware's keyboard interface: a 32 byte feature report and its ID
+#define BUFFER_SIZE 33
+
+/// Longest SET_REPORT sent, in report buffers
+#define MAX_SET_BUFFERS 4
+
+/// Guard bytes around the report buffer
+#define GUARD_SIZE 16
+#define GUARD      0xA5
+
+/// What the USB core would provide
+volatile uint8_t USB_DeviceState = DEVICE_STATE_Configured;
+USB_Request_Header_t USB_ControlRequest;
+
+void USB_USBTask(void)
+{
+}
+
+static struct
+{
+    uint8_t Before[GUARD_SIZE];
+    uint8_t Buffer[BUFFER_SIZE];
+    uint8_t After[GUARD_SIZE];
+} reportBuffer;
+
+static USB_ClassInfo_HID_Device_t interface =
+    {
+        .Config =
+            {
+                .InterfaceNumber              = 0,
+                .ReportINEndpointNumber       = 1,
+                .ReportINEndpointSize         = 8,
+                .ReportINEndpointDoubleBank   = false,
+                .PrevReportINBuffer           = NULL,
+                .PrevReportINBufferSize       = BUFFER_SIZE - 1,
+                .ReportBuffer                 = reportBuffer.Buffer,
+                .ReportBufferSize             = BUFFER_SIZE,
+            },
+    };
+
+/// GET_REPORT: the report the callback builds
+static uint8_t createID;
+static uint16_t createSize;
+
+/// SET_REPORT: the report sent, what the callbacks got of it, and the whole reports seen
+static uint8_t sent[MAX_SET_BUFFERS * BUFFER_SIZE + 1];
+static uint16_t sentLength;
+static uint8_t sentID;
+static uint8_t sentType;
+static uint16_t received;
+static uint8_t wholeReports;
+
+static uint8_t Pattern(const uint16_t index)
+{
+    return (uint8_t) (index * 7 + createID);
+}
+
+bool CALLBACK_HID_Device_CreateHIDReport(USB_ClassInfo_HID_Device_t* const HIDInterfaceInfo,
+                                         uint8_t* const ReportID,
+                                         const uint8_t ReportType,
+                                         void* ReportData,
+                                         uint16_t* const ReportSize)
+{
+    uint8_t* data = (uint8_t*) ReportData;
+
+    // The driver hands over a cleared payload after the ID byte
+    HOST_CHECK(data == &reportBuffer.Buffer[1]);
+    for (uint16_t i = 0; i < BUFFER_SIZE - 1; i++)
+      HOST_CHECK(data[i] == 0);
+
+    for (uint16_t i = 0; i < createSize && i < BUFFER_SIZE - 1; i++)
+      data[i] = Pattern(i);
+
+    *ReportID   = createID;
+    *ReportSize = createSize;
+    return false;
+}
+
+void CALLBACK_HID_Device_ProcessHIDReport(USB_ClassInfo_HID_Device_t* const HIDInterfaceInfo,
+                                          const uint8_t ReportID,
+                                          const uint8_t ReportType,
+                                          const void* ReportData,
+                                          const uint16_t ReportSize)
+{
+    const uint8_t* payload = &sent[sentID ? 1 : 0];
+    uint16_t payloadLength = sentLength - (sentID ? 1 : 0);
+
+    HOST_CHECK(ReportID == sentID && ReportType == sentType);
+    HOST_CHECK(ReportSize <= BUFFER_SIZE);
+    HOST_CHECK(HIDInterfaceInfo->State.ReportLength == payloadLength);
+
+    // Chunks in order, each the next part of what was sent
+    HOST_CHECK(HIDInterfaceInfo->State.ReportOffset == received);
+    HOST_CHECK(received + ReportSize <= payloadLength);
+    HOST_CHECK(memcmp(ReportData, &payload[received], ReportSize) == 0);
+    received += ReportSize;
+
+    if (HID_Device_IsWholeReport(HIDInterfaceInfo, ReportSize))
+    {
+        HOST_CHECK(ReportSize == payloadLength);
+        wholeReports++;
+    }
+}
+
+static void CheckGuards(void)
+{
+    for (uint8_t i = 0; i < GUARD_SIZE; i++)
+      HOST_CHECK(reportBuffer.Before[i] == GUARD && reportBuffer.After[i] == GUARD);
+}
+
+static void Setup(const uint8_t bmRequestType, const uint8_t bRequest, const uint16_t wValue, const uint16_t wLength)
+{
+    USB_ControlRequest.bmRequestType = bmRequestType;
+    USB_ControlRequest.bRequest      = bRequest;
+    USB_ControlRequest.wValue        = wValue;
+    USB_ControlRequest.wIndex        = interface.Config.InterfaceNumber;
+    USB_ControlRequest.wLength       = wLength;
+
+    Host_UsbSetup(FIXED_CONTROL_ENDPOINT_SIZE, (bmRequestType & REQDIR_DEVICETOHOST) != 0, wLength);
+}
+
+static void FuzzGetReport(void)
+{
+    uint32_t truncated = 0;
+
+    for (uint32_t request = 0; request < REQUESTS; request++)
+    {
+        uint16_t wLength = Host_Random() % (BUFFER_SIZE + 16);
+        uint8_t* in;
+        uint32_t inLength;
+
+        createID   = (Host_Random() & 1) ? (1 + Host_Random() % 8) : 0;
+        createSize = Host_Random() % (BUFFER_SIZE + 8);
+
+        Setup(REQDIR_DEVICETOHOST | REQTYPE_CLASS | REQREC_INTERFACE, HID_REQ_GetReport,
+              ((HID_REPORT_ITEM_Feature + 1) << 8) | createID, wLength);
+        HID_Device_ProcessControlRequest(&interface);
+        CheckGuards();
+
+        // The report, clamped to the buffer, with its ID first, cut to wLength
+        uint16_t size   = (createSize >= BUFFER_SIZE) ? BUFFER_SIZE - 1 : createSize;
+        uint16_t length = size + (createID ? 1 : 0);
+
+        if (length > wLength)
+        {
+            length = wLength;
+            truncated++;
+        }
+
+        inLength = Host_UsbReceive(&in);
+        HOST_CHECK(inLength == length);
+        HOST_CHECK(Host_UsbPending() == 0);
+
+        for (uint16_t i = 0; i < inLength; i++)
+        {
+            if (createID && i == 0)
+              HOST_CHECK(in[i] == createID);
+            else
+              HOST_CHECK(in[i] == Pattern(i - (createID ? 1 : 0)));
+        }
+    }
+
+    printf("GET_REPORT: %lu requests, %lu cut to wLength\n", (unsigned long) REQUESTS, (unsigned long) truncated);
+}
+
+static void FuzzSetReport(void)
+{
+    uint32_t complete = 0;
+    uint32_t oversized = 0;
+    uint32_t abandoned = 0;
+
+    for (uint32_t request = 0; request < REQUESTS; request++)
+    {
+        uint16_t packets;
+        bool isAbandoned = (Host_Random() % 4) == 0;
+
+        sentID     = (Host_Random() & 1) ? (1 + Host_Random() % 8) : 0;
+        sentType   = (Host_Random() & 1) ? HID_REPORT_ITEM_Feature : HID_REPORT_ITEM_Out;
+        sentLength = Host_Random() % (MAX_SET_BUFFERS * BUFFER_SIZE + 1);
+
+        // Lengths around the buffer size are the interesting ones
+        if (Host_Random() & 1)
+          sentLength = BUFFER_SIZE - 2 + Host_Random() % 4;
+
+        if (sentID && sentLength == 0)
+          sentLength = 1;
+
+        for (uint16_t i = 0; i < sentLength; i++)
+          sent[i] = Host_Random();
+        if (sentID)
+          sent[0] = sentID;
+
+        received     = 0;
+        wholeReports = 0;
+
+        Setup(REQDIR_HOSTTODEVICE | REQTYPE_CLASS | REQREC_INTERFACE, HID_REQ_SetReport,
+              ((sentType + 1) << 8) | sentID, sentLength);
+
+        packets = (sentLength + FIXED_CONTROL_ENDPOINT_SIZE - 1) / FIXED_CONTROL_ENDPOINT_SIZE;
+        if (isAbandoned && packets != 0)
+        {
+            // Some of the data stage, then a new SETUP
+            Host_UsbSendOut(sent, (Host_Random() % packets) * FIXED_CONTROL_ENDPOINT_SIZE);
+            Host_UsbSetupWhenIdle();
+        }
+        else
+        {
+            isAbandoned = false;
+            Host_UsbSendOut(sent, sentLength);
+        }
+
+        HID_Device_ProcessControlRequest(&interface);
+        CheckGuards();
+        HOST_CHECK(Host_UsbPending() == 0);
+
+        uint16_t payloadLength = sentLength - (sentID ? 1 : 0);
+
+        if (isAbandoned)
+        {
+            HOST_CHECK(wholeReports == 0);
+            abandoned++;
+        }
+        else
+        {
+            HOST_CHECK(received == payloadLength);
+            HOST_CHECK(wholeReports == ((payloadLength <= BUFFER_SIZE) ? 1 : 0));
+
+            if (payloadLength <= BUFFER_SIZE)
+              complete++;
+            else
+              oversized++;
+        }
+    }
+
+    printf("SET_REPORT: %lu requests, %lu whole, %lu longer than the buffer, %lu abandoned\n",
+           (unsigned long) REQUESTS, (unsigned long) complete, (unsigned long) oversized, (unsigned long) abandoned);
+}
+
+int main(void)
+{
+    memset(&reportBuffer, GUARD, sizeof(reportBuffer));
+
+    FuzzGetReport();
+    FuzzSetReport();
+
+    printf("HidFuzz: OK\n");
+    return 0;
+}
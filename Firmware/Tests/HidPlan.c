@@ -0,0 +1,257 @@
+/*
+  Pop'n Convertible Arcade Style Controller Project
+ 
+  Copyright 2011 Sam Wong (Sam /@/ hellosam /./ net)
+
+  This work is licensed under the Creative Commons Attribution 3.0 
+  Hong Kong License. 
+
+  To view a copy of this license, visit 
+  http://creativecommons.org/licenses/by/3.0/hk/ or send a letter to 
+  Creative Commons, 444 Castro Street, Suite 900, 
+  Mountain View, California, 94041, USA.  
+*/
+
+/** HIDParser.c: compiled report plans against the per item extraction.
+ *
+ * Correctness: random report descriptors, with and without report IDs,
+ * with input and output items of 1 to 40 bits at any bit offset, mixed
+ * between two reports. For each report ID and type a plan is compiled,
+ * and run on random reports: every value must equal what
+ * USB_GetHIDReportItemInfo() extracts for the same item (the low 32 bits
+ * of longer items). A report of another ID must be refused with the
+ * values left alone.
+ *
+ * Benchmark: a mouse report with buttons, 12 bit axes and odd sized
+ * fields, extracted item by item and with its plan. On the host both are
+ * far faster than on the AVR, where the per item loop costs several
+ * cycles per bit; the ratio is what carries over.
+ */
+
+#include "Host/Host.h"
+
+#include <LUFA/Drivers/USB/USB.h>
+
+#include <string.h>
+
+/// Random descriptors, and random reports run through each of their plans
+#define DESCRIPTORS 20000UL
+#define REPORTS     50
+
+/// Reports extracted in each benchmark
+#define BENCHMARK_REPORTS 2000000UL
+
+/// Largest report of a random descriptor: every item at 40 bits, plus the ID
+#define MAX_REPORT_BYTES (HID_MAX_REPORTITEMS * 40 / 8 + 1)
+
+/// Report items fields may come from
+#define REPORT_ITEM_TYPES 2
+
+static const uint8_t itemTypes[REPORT_ITEM_TYPES] = { HID_REPORT_ITEM_In, HID_REPORT_ITEM_Out };
+
+/// Benchmark mouse: 3 buttons and padding, X and Y of 12 bits, wheel, and fields of 32, 5 and 17 bits
+static const uint8_t mouseDescriptor[] =
+{
+    0x05, 0x01, 0x09, 0x02, 0xA1, 0x01, 0x85, 0x05,
+    0x05, 0x09, 0x19, 0x01, 0x29, 0x03, 0x15, 0x00, 0x25, 0x01, 0x75, 0x01, 0x95, 0x03, 0x81, 0x02,
+    0x75, 0x05, 0x95, 0x01, 0x81, 0x01,
+    0x05, 0x01, 0x09, 0x30, 0x09, 0x31, 0x75, 0x0C, 0x95, 0x02, 0x81, 0x06,
+    0x09, 0x38, 0x75, 0x08, 0x95, 0x01, 0x81, 0x06,
+    0x09, 0x32, 0x75, 0x20, 0x95, 0x01, 0x81, 0x02,
+    0x09, 0x33, 0x75, 0x05, 0x95, 0x01, 0x81, 0x02,
+    0x09, 0x34, 0x75, 0x11, 0x95, 0x01, 0x81, 0x02,
+    0xC0,
+};
+
+static HID_ReportInfo_t info;
+static HID_ReportPlan_t plan;
+
+bool CALLBACK_HIDParser_FilterHIDReportItem(HID_ReportItem_t* const CurrentItem)
+{
+    return true;
+}
+
+/** A random descriptor of up to HID_MAX_REPORTITEMS items; returns its length */
+static uint16_t RandomDescriptor(uint8_t* descriptor, const bool useIDs)
+{
+    uint16_t length = 0;
+    uint8_t items = 0;
+    uint8_t target = 1 + Host_Random() % HID_MAX_REPORTITEMS;
+
+    descriptor[length++] = 0x05;    // Usage Page: Generic Desktop
+    descriptor[length++] = 0x01;
+    descriptor[length++] = 0x09;    // Usage: Game Pad
+    descriptor[length++] = 0x05;
+    descriptor[length++] = 0xA1;    // Collection: Application
+    descriptor[length++] = 0x01;
+
+    while (items < target)
+    {
+        uint8_t count = 1 + Host_Random() % 3;
+
+        if (count > target - items)
+          count = target - items;
+
+        if (useIDs)
+        {
+            descriptor[length++] = 0x85;    // Report ID
+            descriptor[length++] = 1 + Host_Random() % 2;
+        }
+
+        descriptor[length++] = 0x75;        // Report Size
+        descriptor[length++] = 1 + Host_Random() % 40;
+        descriptor[length++] = 0x95;        // Report Count
+        descriptor[length++] = count;
+
+        for (uint8_t i = 0; i < count; i++)
+        {
+            descriptor[length++] = 0x09;    // Usage: X onwards
+            descriptor[length++] = 0x30 + items + i;
+        }
+
+        descriptor[length++] = (Host_Random() & 1) ? 0x81 : 0x91;    // Input or Output: Data, Variable, Absolute
+        descriptor[length++] = 0x02;
+
+        items += count;
+    }
+
+    descriptor[length++] = 0xC0;    // End Collection
+
+    return length;
+}
+
+/** Run every plan of the parsed descriptor, of report IDs up to lastID, on random reports; returns the values checked */
+static uint32_t CheckPlans(const uint8_t lastID)
+{
+    uint32_t checks = 0;
+
+    for (uint8_t id = 0; id <= lastID; id++)
+    {
+        for (uint8_t type = 0; type < REPORT_ITEM_TYPES; type++)
+        {
+            uint8_t result = USB_CompileHIDReportPlan(&info, id, itemTypes[type], &plan);
+            uint8_t items = 0;
+
+            for (uint8_t i = 0; i < info.TotalReportItems; i++)
+            {
+                if (info.ReportItems[i].ReportID == id && info.ReportItems[i].ItemType == itemTypes[type])
+                  items++;
+            }
+
+            if (!items)
+            {
+                HOST_CHECK(result == HID_PARSE_NoUnfilteredReportItems);
+                continue;
+            }
+
+            HOST_CHECK(result == HID_PARSE_Successful);
+            HOST_CHECK(plan.TotalFields == items);
+
+            for (uint16_t n = 0; n < REPORTS; n++)
+            {
+                uint8_t report[MAX_REPORT_BYTES];
+                uint32_t values[HID_MAX_REPORTITEMS];
+
+                for (uint16_t i = 0; i < sizeof(report); i++)
+                  report[i] = Host_Random();
+                report[0] = id ? id : report[0];
+
+                HOST_CHECK(USB_GetHIDReportPlanValues(&plan, report, values));
+
+                for (uint8_t i = 0; i < info.TotalReportItems; i++)
+                {
+                    HID_ReportItem_t* item = &info.ReportItems[i];
+
+                    if (item->ReportID != id || item->ItemType != itemTypes[type])
+                      continue;
+
+                    HOST_CHECK(USB_GetHIDReportItemInfo(report, item));
+                    HOST_CHECK(values[i] == item->Value);
+                    checks++;
+                }
+
+                // Another report's ID: refused, values untouched
+                if (id)
+                {
+                    uint32_t before[HID_MAX_REPORTITEMS];
+
+                    memcpy(before, values, sizeof(values));
+                    report[0] = id + 1;
+                    HOST_CHECK(!USB_GetHIDReportPlanValues(&plan, report, values));
+                    HOST_CHECK(memcmp(before, values, sizeof(values)) == 0);
+                }
+            }
+        }
+    }
+
+    return checks;
+}
+
+static void TestPlans(void)
+{
+    uint8_t descriptor[256];
+    uint32_t checks = 0;
+
+    for (uint32_t n = 0; n < DESCRIPTORS; n++)
+    {
+        uint16_t length = RandomDescriptor(descriptor, n & 1);
+
+        HOST_CHECK(USB_ProcessHIDReport(descriptor, length, &info) == HID_PARSE_Successful);
+        checks += CheckPlans(2);
+    }
+
+    printf("plans: %lu random descriptors, %lu values as extracted per item\n",
+           (unsigned long) DESCRIPTORS, (unsigned long) checks);
+}
+
+static void Benchmark(void)
+{
+    uint8_t report[32] = { 5 };
+    uint32_t values[HID_MAX_REPORTITEMS];
+    volatile uint32_t sink = 0;
+    uint64_t start;
+    double items;
+    double planned;
+
+    HOST_CHECK(USB_ProcessHIDReport(mouseDescriptor, sizeof(mouseDescriptor), &info) == HID_PARSE_Successful);
+    HOST_CHECK(CheckPlans(5) != 0);
+
+    for (uint8_t i = 1; i < sizeof(report); i++)
+      report[i] = Host_Random();
+
+    start = Host_Nanoseconds();
+    for (uint32_t n = 0; n < BENCHMARK_REPORTS; n++)
+    {
+        report[1] = n;
+        for (uint8_t i = 0; i < info.TotalReportItems; i++)
+        {
+            USB_GetHIDReportItemInfo(report, &info.ReportItems[i]);
+            sink += info.ReportItems[i].Value;
+        }
+    }
+    items = (double) (Host_Nanoseconds() - start) / BENCHMARK_REPORTS;
+
+    HOST_CHECK(USB_CompileHIDReportPlan(&info, 5, HID_REPORT_ITEM_In, &plan) == HID_PARSE_Successful);
+
+    start = Host_Nanoseconds();
+    for (uint32_t n = 0; n < BENCHMARK_REPORTS; n++)
+    {
+        report[1] = n;
+        USB_GetHIDReportPlanValues(&plan, report, values);
+        sink += values[plan.Fields[0].Slot];
+    }
+    planned = (double) (Host_Nanoseconds() - start) / BENCHMARK_REPORTS;
+
+    printf("benchmark: mouse report, %u items\n", info.TotalReportItems);
+    printf("benchmark: %-24s %6.1f ns/report\n", "USB_GetHIDReportItemInfo", items);
+    printf("benchmark: %-24s %6.1f ns/report (%.1fx)\n", "plan", planned, items / planned);
+}
+
+int main(void)
+{
+    TestPlans();
+    Benchmark();
+
+    printf("HidPlan: OK\n");
+    return 0;
+}
@@ -0,0 +1,41 @@
+/*
+  Pop'n Convertible Arcade Style Controller Project
+ 
+  Copyright 2011 Sam Wong (Sam /@/ hellosam /./ net)
+
+  This work is licensed under the Creative Commons Attribution 3.0 
+  Hong Kong License. 
+
+  To view a copy of this license, visit 
+  http://creativecommons.org/licenses/by/3.0/hk/ or send a letter to 
+  Creative Commons, 444 Castro Street, Suite 900, 
+  Mountain View, California, 94041, USA.  
+*/
+
+#ifndef _HOST_H_
+#define _HOST_H_
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/** Support for the host-native tests: see Tests/makefile. */
+
+/// Stop the test with the failed condition and where it is
+#define HOST_CHECK(condition)                                                      \
+    do                                                                             \
+    {                                                                              \
+        if (!(condition))                                                          \
+        {                                                                          \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition);   \
+            exit(1);                                                               \
+        }                                                                          \
+    } while (0)
+
+/// Monotonic time in nanoseconds, for the benchmarks
+uint64_t Host_Nanoseconds(void);
+
+/// Deterministic pseudo-random numbers, so that a failure can be repeated
+uint32_t Host_Random(void);
+
+#endif
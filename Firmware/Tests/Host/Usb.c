@@ -0,0 +1,226 @@
+/*
+  Pop'n Convertible Arcade Style Controller Project
+ 
+  Copyright 2011 Sam Wong (Sam /@/ hellosam /./ net)
+
+  This work is licensed under the Creative Commons Attribution 3.0 
+  Hong Kong License. 
+
+  To view a copy of this license, visit 
+  http://creativecommons.org/licenses/by/3.0/hk/ or send a letter to 
+  Creative Commons, 444 Castro Street, Suite 900, 
+  Mountain View, California, 94041, USA.  
+*/
+
+#include "Usb.h"
+
+#include <avr/io.h>
+#include <string.h>
+
+/// Bank of the endpoint: an OUT packet being read, or an IN packet being written
+static uint8_t bank[64];
+static uint8_t bankLength;
+static uint8_t bankIndex;
+static bool bankHoldsOut;
+static uint8_t packetSize;
+
+/// An IN packet sent and not yet taken, and whether the host is polling for it
+static bool inWaiting;
+static bool inHeld;
+
+/// Status register, and its value as the firmware last got it
+static uint8_t status;
+static uint8_t statusSeen;
+
+/// Host side: OUT packets queued (each one a length byte then the data), IN bytes collected
+static uint8_t outQueue[HOST_USB_BUFFER_SIZE];
+static uint32_t outHead;
+static uint32_t outTail;
+static uint8_t inData[HOST_USB_BUFFER_SIZE];
+static uint32_t inLength;
+
+/// Control transfer: the length of a read's data stage, 0 for a write, and a SETUP to come
+static uint16_t controlRead;
+static bool statusQueued;
+static bool setupWhenIdle;
+
+static uint16_t polls;
+
+void Host_UsbReset(void)
+{
+    bankLength    = 0;
+    bankIndex     = 0;
+    bankHoldsOut  = false;
+    packetSize    = sizeof(bank);
+    status        = (1 << TXINI) | (1 << RWAL);
+    statusSeen    = status;
+    outHead       = 0;
+    outTail       = 0;
+    inLength      = 0;
+    controlRead   = 0;
+    statusQueued  = false;
+    setupWhenIdle = false;
+    inWaiting     = false;
+    inHeld        = false;
+}
+
+/** A SETUP packet, with the given control endpoint size, direction and wLength */
+void Host_UsbSetup(uint8_t size, bool isRead, uint16_t length)
+{
+    Host_UsbReset();
+
+    packetSize  = size;
+    controlRead = isRead ? length : 0;
+    status     |= (1 << RXSTPI);
+    statusSeen  = status;
+
+    // A read without a data stage goes straight to the status stage
+    if (isRead && !length)
+    {
+        statusQueued = true;
+        Host_UsbSendOut("", 0);
+    }
+}
+
+void Host_UsbSetupWhenIdle(void)
+{
+    setupWhenIdle = true;
+}
+
+void Host_UsbSendOut(const void* data, uint16_t length)
+{
+    const uint8_t* bytes = (const uint8_t*) data;
+
+    // One packet per endpoint bank
+    do
+    {
+        uint8_t packet = (length > packetSize) ? packetSize : length;
+
+        if (outTail + 1 + packet > sizeof(outQueue))
+          return;
+
+        outQueue[outTail++] = packet;
+        memcpy(&outQueue[outTail], bytes, packet);
+        outTail += packet;
+        bytes   += packet;
+        length  -= packet;
+    } while (length);
+}
+
+/** Act on what the firmware did to the status since it last got it */
+static void Host_UsbUpdate(void)
+{
+    // OUT packet released
+    if (bankHoldsOut && (statusSeen & (1 << RXOUTI)) && !(status & (1 << RXOUTI)))
+    {
+        bankHoldsOut = false;
+        bankIndex    = 0;
+        bankLength   = 0;
+    }
+
+    // IN packet sent
+    if (!bankHoldsOut && (statusSeen & (1 << TXINI)) && !(status & (1 << TXINI)))
+      inWaiting = true;
+
+    // The host takes it when it polls, and the bank is free again
+    if (inWaiting && !inHeld)
+    {
+        if (inLength + bankIndex <= sizeof(inData))
+        {
+            memcpy(&inData[inLength], bank, bankIndex);
+            inLength += bankIndex;
+        }
+
+        // The end of a read's data stage: all that was asked for, or a short packet
+        if (controlRead && !statusQueued && (inLength >= controlRead || bankIndex < packetSize))
+        {
+            statusQueued = true;
+            Host_UsbSendOut("", 0);
+        }
+
+        bankIndex = 0;
+        inWaiting = false;
+        status |= (1 << TXINI);
+    }
+
+    // Next OUT packet, once the bank is free
+    if (!bankHoldsOut && !inWaiting && bankIndex == 0 && outHead < outTail)
+    {
+        bankLength = outQueue[outHead++];
+        memcpy(bank, &outQueue[outHead], bankLength);
+        outHead += bankLength;
+
+        bankHoldsOut = true;
+        status |= (1 << RXOUTI);
+    }
+
+    if (setupWhenIdle && !bankHoldsOut && outHead == outTail)
+    {
+        setupWhenIdle = false;
+        status |= (1 << RXSTPI);
+    }
+
+    if (bankHoldsOut ? (bankIndex < bankLength) : (bankIndex < packetSize))
+      status |= (1 << RWAL);
+    else
+      status &= ~(1 << RWAL);
+
+    statusSeen = status;
+}
+
+void Host_UsbHoldIn(bool hold)
+{
+    inHeld = hold;
+    Host_UsbUpdate();
+}
+
+/** IN bytes the firmware has sent since the last reset */
+uint32_t Host_UsbReceive(uint8_t** data)
+{
+    Host_UsbUpdate();
+
+    *data = inData;
+    return inLength;
+}
+
+/** OUT bytes still queued, the packet in the bank included */
+uint32_t Host_UsbPending(void)
+{
+    Host_UsbUpdate();
+
+    return (outTail - outHead) + (bankHoldsOut ? bankLength - bankIndex : 0);
+}
+
+volatile uint8_t* Host_UsbStatus(void)
+{
+    Host_UsbUpdate();
+
+    if (++polls == HOST_USB_POLLS_PER_FRAME)
+    {
+        polls = 0;
+        UDFNUM++;
+    }
+
+    return (volatile uint8_t*) &status;
+}
+
+volatile uint8_t* Host_UsbData(void)
+{
+    volatile uint8_t* data;
+
+    Host_UsbUpdate();
+
+    // Past the end of the bank, reads and writes are lost as on the AVR
+    data = &bank[(bankIndex < sizeof(bank)) ? bankIndex : sizeof(bank) - 1];
+    if (bankIndex < sizeof(bank))
+      bankIndex++;
+
+    return data;
+}
+
+uint8_t Host_UsbByteCount(void)
+{
+    Host_UsbUpdate();
+
+    return bankHoldsOut ? (bankLength - bankIndex) : bankIndex;
+}
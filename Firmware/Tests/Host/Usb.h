@@ -0,0 +1,61 @@
+/*
+  Pop'n Convertible Arcade Style Controller Project
+ 
+  Copyright 2011 Sam Wong (Sam /@/ hellosam /./ net)
+
+  This work is licensed under the Creative Commons Attribution 3.0 
+  Hong Kong License. 
+
+  To view a copy of this license, visit 
+  http://creativecommons.org/licenses/by/3.0/hk/ or send a letter to 
+  Creative Commons, 444 Castro Street, Suite 900, 
+  Mountain View, California, 94041, USA.  
+*/
+
+#ifndef _HOST_USB_H_
+#define _HOST_USB_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/** USB controller emulation for the tests built with HOST_USB_EMULATION,
+ * in which the test plays the host.
+ *
+ * OUT packets queued with Host_UsbSendOut() are put in the endpoint bank
+ * one at a time, with RXOUTI set, until the firmware clears RXOUTI. An IN
+ * packet is taken from the bank when the firmware clears TXINI, and is
+ * added to the bytes Host_UsbReceive() returns; TXINI is then set again
+ * at once, as if the host had polled. Endpoint numbers are not told
+ * apart, so a test drives one endpoint at a time.
+ *
+ * Control transfers: Host_UsbSetup() raises RXSTPI for a request the test
+ * has put in USB_ControlRequest, with packets of the control endpoint's
+ * size. The host's part of the status stage is played as the firmware
+ * gets to it: after a read's data stage, a zero length OUT packet, and a
+ * write's zero length IN packet is taken as any other. A host giving up
+ * on a write is played by Host_UsbSetupWhenIdle(): a new SETUP arrives
+ * once the OUT packets queued so far have been taken.
+ *
+ * Host_UsbHoldIn() stops the host polling: a packet the firmware sends
+ * then stays in the bank, with TXINI clear, until the hold is released.
+ *
+ * Each poll of the endpoint status takes a little time: the frame number
+ * moves on every HOST_USB_POLLS_PER_FRAME polls, so that the firmware's
+ * timeouts expire if the test never sends what it waits for.
+ */
+
+/// Status polls per USB frame
+#define HOST_USB_POLLS_PER_FRAME 1000
+
+/// Bytes of OUT packets the test may have queued, and of IN packets collected
+#define HOST_USB_BUFFER_SIZE 0x10000UL
+
+void Host_UsbReset(void);
+void Host_UsbSetup(uint8_t packetSize, bool isRead, uint16_t length);
+void Host_UsbSetupWhenIdle(void);
+void Host_UsbHoldIn(bool hold);
+void Host_UsbSendOut(const void* data, uint16_t length);
+uint32_t Host_UsbReceive(uint8_t** data);
+uint32_t Host_UsbPending(void);
+
+#endif
@@ -0,0 +1,23 @@
+/*
+  Pop'n Convertible Arcade Style Controller Project
+ 
+  Copyright 2011 Sam Wong (Sam /@/ hellosam /./ net)
+
+  This work is licensed under the Creative Commons Attribution 3.0 
+  Hong Kong License. 
+
+  To view a copy of this license, visit 
+  http://creativecommons.org/licenses/by/3.0/hk/ or send a letter to 
+  Creative Commons, 444 Castro Street, Suite 900, 
+  Mountain View, California, 94041, USA.  
+*/
+
+#ifndef _HOST_AVR_BOOT_H_
+#define _HOST_AVR_BOOT_H_
+
+#include <stdint.h>
+
+/// No signature row on the host: the serial number reads as zeroes
+#define boot_signature_byte_get(address) ((uint8_t) 0)
+
+#endif
@@ -0,0 +1,31 @@
+/*
+  Pop'n Convertible Arcade Style Controller Project
+ 
+  Copyright 2011 Sam Wong (Sam /@/ hellosam /./ net)
+
+  This work is licensed under the Creative Commons Attribution 3.0 
+  Hong Kong License. 
+
+  To view a copy of this license, visit 
+  http://creativecommons.org/licenses/by/3.0/hk/ or send a letter to 
+  Creative Commons, 444 Castro Street, Suite 900, 
+  Mountain View, California, 94041, USA.  
+*/
+
+#ifndef _HOST_AVR_EEPROM_H_
+#define _HOST_AVR_EEPROM_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/// EEPROM variables are ordinary memory on the host
+#define EEMEM
+
+#define eeprom_read_byte(address)                (*(const uint8_t*) (address))
+#define eeprom_write_byte(address, value)        (*(uint8_t*) (address) = (value))
+#define eeprom_update_byte(address, value)       (*(uint8_t*) (address) = (value))
+#define eeprom_read_block(data, address, size)   memcpy((data), (address), (size))
+#define eeprom_update_block(data, address, size) memcpy((address), (data), (size))
+
+#endif
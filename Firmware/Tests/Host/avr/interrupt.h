@@ -0,0 +1,26 @@
+/*
+  Pop'n Convertible Arcade Style Controller Project
+ 
+  Copyright 2011 Sam Wong (Sam /@/ hellosam /./ net)
+
+  This work is licensed under the Creative Commons Attribution 3.0 
+  Hong Kong License. 
+
+  To view a copy of this license, visit 
+  http://creativecommons.org/licenses/by/3.0/hk/ or send a letter to 
+  Creative Commons, 444 Castro Street, Suite 900, 
+  Mountain View, California, 94041, USA.  
+*/
+
+#ifndef _HOST_AVR_INTERRUPT_H_
+#define _HOST_AVR_INTERRUPT_H_
+
+#include <avr/io.h>
+
+/// There are no interrupts on the host; handlers are plain functions a test may call
+#define ISR(vector, ...)         void vector(void); void vector(void)
+#define EMPTY_INTERRUPT(vector)  void vector(void); void vector(void) { }
+#define sei()                    do { SREG |= 0x80; } while (0)
+#define cli()                    do { SREG &= ~0x80; } while (0)
+
+#endif
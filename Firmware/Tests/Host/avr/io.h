@@ -0,0 +1,144 @@
+/*
+  Pop'n Convertible Arcade Style Controller Project
+ 
+  Copyright 2011 Sam Wong (Sam /@/ hellosam /./ net)
+
+  This work is licensed under the Creative Commons Attribution 3.0 
+  Hong Kong License. 
+
+  To view a copy of this license, visit 
+  http://creativecommons.org/licenses/by/3.0/hk/ or send a letter to 
+  Creative Commons, 444 Castro Street, Suite 900, 
+  Mountain View, California, 94041, USA.  
+*/
+
+#ifndef _HOST_AVR_IO_H_
+#define _HOST_AVR_IO_H_
+
+#include <stdint.h>
+
+/** Host stand-in for <avr/io.h>: the AT90USB162 registers the tested
+ * sources touch, as plain variables (defined in Host.c), with their real
+ * bit positions. A test that defines HOST_USB_EMULATION gets the endpoint
+ * data, status and byte count registers routed through Host_Usb*()
+ * instead, so that it can play the part of the USB controller. One that
+ * defines HOST_TIMER_EMULATION gets TCNT1 from Host_Timer1(), so that
+ * time moves on as the code under test reads it.
+ */
+
+#define _BV(bit) (1 << (bit))
+
+#define RAMSTART 0x100
+#define RAMEND   0x2FF
+#define E2END    0x1FF
+
+#if defined(HOST_REGISTERS_DEFINE)
+#define HOST_REGISTER(type, name) volatile type name
+#else
+#define HOST_REGISTER(type, name) extern volatile type name
+#endif
+
+HOST_REGISTER(uint8_t, SREG);
+HOST_REGISTER(uint8_t, MCUSR);
+#define PORF   0
+#define EXTRF  1
+#define BORF   2
+#define WDRF   3
+
+// Watchdog; the timed sequence is not checked
+HOST_REGISTER(uint8_t, WDTCSR);
+#define WDE    3
+#define WDCE   4
+#define WDP3   5
+#define WDIE   6
+#define WDIF   7
+
+// Timer 1
+HOST_REGISTER(uint8_t, TCCR1A);
+HOST_REGISTER(uint8_t, TCCR1B);
+HOST_REGISTER(uint8_t, TIMSK1);
+HOST_REGISTER(uint8_t, TIFR1);
+HOST_REGISTER(uint16_t, OCR1A);
+#if defined(HOST_TIMER_EMULATION)
+volatile uint16_t* Host_Timer1(void);
+
+#define TCNT1 (*Host_Timer1())
+#else
+HOST_REGISTER(uint16_t, TCNT1);
+#endif
+#define CS10   0
+#define CS11   1
+#define CS12   2
+#define OCIE1A 1
+#define OCF1A  1
+
+// PLL and regulator
+HOST_REGISTER(uint8_t, PLLCSR);
+HOST_REGISTER(uint8_t, REGCR);
+#define PLOCK  0
+#define PLLE   1
+#define REGDIS 0
+
+// USB device
+HOST_REGISTER(uint8_t, USBCON);
+HOST_REGISTER(uint8_t, UDCON);
+HOST_REGISTER(uint8_t, UDINT);
+HOST_REGISTER(uint8_t, UDIEN);
+HOST_REGISTER(uint8_t, UDADDR);
+HOST_REGISTER(uint16_t, UDFNUM);
+#define FRZCLK  5
+#define USBE    7
+#define DETACH  0
+#define RMWKUP  1
+#define SUSPI   0
+#define SOFI    2
+#define EORSTI  3
+#define WAKEUPI 4
+#define SUSPE   0
+#define SOFE    2
+#define EORSTE  3
+#define WAKEUPE 4
+#define ADDEN   7
+
+// USB endpoints
+HOST_REGISTER(uint8_t, UENUM);
+HOST_REGISTER(uint8_t, UERST);
+HOST_REGISTER(uint8_t, UECONX);
+HOST_REGISTER(uint8_t, UECFG0X);
+HOST_REGISTER(uint8_t, UECFG1X);
+HOST_REGISTER(uint8_t, UESTA0X);
+HOST_REGISTER(uint8_t, UEIENX);
+HOST_REGISTER(uint8_t, UEINT);
+#define EPEN     0
+#define RSTDT    3
+#define STALLRQC 4
+#define STALLRQ  5
+#define EPDIR    0
+#define EPTYPE0  6
+#define ALLOC    1
+#define EPBK0    2
+#define EPSIZE0  4
+#define NBUSYBK0 0
+#define CFGOK    7
+#define RXSTPE   3
+#define TXINI    0
+#define RXOUTI   2
+#define RXSTPI   3
+#define RWAL     5
+#define FIFOCON  7
+
+#if defined(HOST_USB_EMULATION)
+volatile uint8_t* Host_UsbData(void);
+volatile uint8_t* Host_UsbStatus(void);
+uint8_t Host_UsbByteCount(void);
+
+#define UEDATX (*Host_UsbData())
+#define UEINTX (*Host_UsbStatus())
+#define UEBCLX (Host_UsbByteCount())
+#else
+HOST_REGISTER(uint8_t, UEDATX);
+HOST_REGISTER(uint8_t, UEINTX);
+HOST_REGISTER(uint8_t, UEBCLX);
+#endif
+
+#endif
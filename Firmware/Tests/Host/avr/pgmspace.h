@@ -0,0 +1,33 @@
+/*
+  Pop'n Convertible Arcade Style Controller Project
+ 
+  Copyright 2011 Sam Wong (Sam /@/ hellosam /./ net)
+
+  This work is licensed under the Creative Commons Attribution 3.0 
+  Hong Kong License. 
+
+  To view a copy of this license, visit 
+  http://creativecommons.org/licenses/by/3.0/hk/ or send a letter to 
+  Creative Commons, 444 Castro Street, Suite 900, 
+  Mountain View, California, 94041, USA.  
+*/
+
+#ifndef _HOST_AVR_PGMSPACE_H_
+#define _HOST_AVR_PGMSPACE_H_
+
+#include <stdint.h>
+#include <string.h>
+
+/// Flash is ordinary memory on the host
+#define PROGMEM
+#define PSTR(string)             (string)
+#define pgm_read_byte(address)   (*(const uint8_t*) (address))
+#define pgm_read_word(address)   (*(const uint16_t*) (address))
+#define pgm_read_dword(address)  (*(const uint32_t*) (address))
+#define pgm_read_ptr(address)    (*(void* const*) (address))
+#define memcpy_P                 memcpy
+#define memcmp_P                 memcmp
+#define strlen_P                 strlen
+#define strnlen_P                strnlen
+
+#endif
@@ -0,0 +1,29 @@
+/*
+  Pop'n Convertible Arcade Style Controller Project
+ 
+  Copyright 2011 Sam Wong (Sam /@/ hellosam /./ net)
+
+  This work is licensed under the Creative Commons Attribution 3.0 
+  Hong Kong License. 
+
+  To view a copy of this license, visit 
+  http://creativecommons.org/licenses/by/3.0/hk/ or send a letter to 
+  Creative Commons, 444 Castro Street, Suite 900, 
+  Mountain View, California, 94041, USA.  
+*/
+
+#ifndef _HOST_AVR_SLEEP_H_
+#define _HOST_AVR_SLEEP_H_
+
+#define SLEEP_MODE_IDLE     0
+#define SLEEP_MODE_PWR_DOWN 2
+
+/// A test that sleeps provides Host_Sleep(), to move time on to the next wake event
+void Host_Sleep(void);
+
+#define set_sleep_mode(mode) do { } while (0)
+#define sleep_enable()       do { } while (0)
+#define sleep_disable()      do { } while (0)
+#define sleep_cpu()          Host_Sleep()
+
+#endif
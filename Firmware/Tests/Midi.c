@@ -0,0 +1,205 @@
+/*
+  Pop'n Convertible Arcade Style Controller Project
+ 
+  Copyright 2011 Sam Wong (Sam /@/ hellosam /./ net)
+
+  This work is licensed under the Creative Commons Attribution 3.0 
+  Hong Kong License. 
+
+  To view a copy of this license, visit 
+  http://creativecommons.org/licenses/by/3.0/hk/ or send a letter to 
+  Creative Commons, 444 Castro Street, Suite 900, 
+  Mountain View, California, 94041, USA.  
+*/
+
+/** Midi.c: note events through the ring and the emulated IN bank.
+ *
+ * Each frame, a burst of random button edges (from none to every one of
+ * the 32 inputs) goes through Midi_QueueEdges(), as from the SOF event,
+ * and Midi_USBTask() runs once, as from the main loop. The host misses
+ * some polls (Host_UsbHoldIn()), so events pile up in the ring and bursts
+ * overflow it.
+ *
+ * Every packet the host takes must be whole events, 4-byte aligned
+ * wherever the ring wrapped, and the events must be the queued edges in
+ * order. Edges are dropped exactly when a model of the ring's occupancy
+ * says they do not fit, and the counters must agree. Events per frame and
+ * per packet are reported: MIDI_Device_SendEventPacket() would send one
+ * per packet, and wait for the host each time.
+ */
+
+#include "Host/Host.h"
+#include "Host/Usb.h"
+
+// The firmware file itself, for its ring and counters
+#include "../Midi.c"
+
+/// Frames simulated
+#define FRAMES 200000UL
+
+/// One in this many frames, the host misses its poll
+#define MISSED_POLL_ODDS 3
+
+volatile uint8_t USB_DeviceState = DEVICE_STATE_Configured;
+
+bool MIDI_Device_ConfigureEndpoints(USB_ClassInfo_MIDI_Device_t* const MIDIInterfaceInfo)
+{
+    return true;
+}
+
+/// Events queued and not yet seen by the host, in order; more than the ring and the bank hold
+#define EXPECTED_SIZE 256
+
+static struct
+{
+    uint8_t Note;
+    bool    On;
+} expected[EXPECTED_SIZE];
+static uint32_t expectedHead;
+static uint32_t expectedTail;
+
+/// Model of the ring: bytes queued, and what fits
+static uint16_t occupancy;
+static uint16_t capacity;
+static bool bankBusy;
+
+static uint32_t drops;
+static uint32_t packets;
+static uint32_t events;
+static uint8_t maxPerPacket;
+
+/** Check the bytes the host took since the last call: at most one packet */
+static void Collect(uint32_t* seen)
+{
+    uint8_t* in;
+    uint32_t length = Host_UsbReceive(&in);
+    uint32_t packet = length - *seen;
+
+    if (packet == 0)
+      return;
+
+    HOST_CHECK(packet % sizeof(MIDI_EventPacket_t) == 0);
+    HOST_CHECK(packet <= MIDI_STREAM_IN_EPSIZE);
+
+    for (uint32_t offset = *seen; offset < length; offset += sizeof(MIDI_EventPacket_t))
+    {
+        uint8_t command = expected[expectedHead % EXPECTED_SIZE].On ? MIDI_COMMAND_NOTE_ON : MIDI_COMMAND_NOTE_OFF;
+
+        HOST_CHECK(expectedHead < expectedTail);
+        HOST_CHECK(in[offset + 0] == command >> 4);
+        HOST_CHECK(in[offset + 1] == (command | MIDI_CHANNEL(MIDI_CHANNEL_NUMBER)));
+        HOST_CHECK(in[offset + 2] == expected[expectedHead % EXPECTED_SIZE].Note);
+        HOST_CHECK(in[offset + 3] == MIDI_STANDARD_VELOCITY);
+        expectedHead++;
+    }
+
+    packets++;
+    events += packet / sizeof(MIDI_EventPacket_t);
+    if (packet / sizeof(MIDI_EventPacket_t) > maxPerPacket)
+      maxPerPacket = packet / sizeof(MIDI_EventPacket_t);
+
+    // The host's buffer is reused; only what is new matters
+    *seen = length;
+    if (length > HOST_USB_BUFFER_SIZE - MIDI_STREAM_IN_EPSIZE)
+    {
+        Host_UsbReset();
+        *seen = 0;
+    }
+}
+
+/** Queue a frame's edges, in the model as in the firmware */
+static void QueueEdges(ButtonBitmap_t* state)
+{
+    ButtonBitmap_t change = 0;
+    uint8_t burst = Host_Random() % (BUTTON_COUNT + 1);
+
+    while (burst--)
+      change |= (ButtonBitmap_t) 1 << (Host_Random() % BUTTON_COUNT);
+
+    *state ^= change;
+
+    for (uint8_t i = 0; i < BUTTON_COUNT; i++)
+    {
+        if (!(change & ((ButtonBitmap_t) 1 << i)))
+          continue;
+
+        if (capacity - occupancy < sizeof(MIDI_EventPacket_t))
+        {
+            drops++;
+            continue;
+        }
+
+        occupancy += sizeof(MIDI_EventPacket_t);
+        expected[expectedTail % EXPECTED_SIZE].Note = (MIDI_BASE_NOTE + i) & 0x7F;
+        expected[expectedTail % EXPECTED_SIZE].On   = (*state >> i) & 1;
+        expectedTail++;
+    }
+
+    Midi_QueueEdges(*state, change);
+}
+
+/** Run the task, and in the model, move what fits a packet out of the ring if the bank is free */
+static void Task(void)
+{
+    if (!bankBusy && occupancy)
+    {
+        occupancy -= (occupancy > MIDI_STREAM_IN_EPSIZE) ? MIDI_STREAM_IN_EPSIZE : occupancy;
+        bankBusy = true;
+    }
+
+    Midi_USBTask();
+}
+
+int main(void)
+{
+    ButtonBitmap_t state = 0;
+    uint32_t seen = 0;
+    uint32_t frames;
+
+    Host_UsbReset();
+    Midi_Init();
+    capacity = SPSCRingBuffer_GetFreeCount(&buffer);
+
+    for (frames = 0; frames < FRAMES; frames++)
+    {
+        bool held = (Host_Random() % MISSED_POLL_ODDS) == 0;
+
+        // A poll of the host frees the bank
+        Host_UsbHoldIn(held);
+        if (!held)
+          bankBusy = false;
+        Collect(&seen);
+
+        QueueEdges(&state);
+        Task();
+        if (!held)
+          bankBusy = false;
+        Collect(&seen);
+
+        HOST_CHECK(SPSCRingBuffer_GetCount(&buffer) == occupancy);
+    }
+
+    // Drain
+    Host_UsbHoldIn(false);
+    bankBusy = false;
+    while (occupancy)
+    {
+        Task();
+        bankBusy = false;
+        Collect(&seen);
+    }
+    Collect(&seen);
+
+    HOST_CHECK(expectedHead == expectedTail);
+    HOST_CHECK(counters.Events == (uint16_t) events);
+    HOST_CHECK(counters.Dropped == ((drops > 0xFFFF) ? 0xFFFF : drops));
+    HOST_CHECK(counters.MaxPerPacket == maxPerPacket);
+
+    printf("%lu frames, %lu edges: %lu sent, %lu dropped, 1 in %u polls missed\n",
+           (unsigned long) FRAMES, (unsigned long) (events + drops), (unsigned long) events,
+           (unsigned long) drops, MISSED_POLL_ODDS);
+    printf("benchmark: %.2f events/frame, %.2f events/packet (most %u), against 1 with MIDI_Device_SendEventPacket()\n",
+           (double) events / FRAMES, (double) events / packets, maxPerPacket);
+    printf("Midi: OK\n");
+    return 0;
+}
@@ -0,0 +1,213 @@
+/*
+  Pop'n Convertible Arcade Style Controller Project
+ 
+  Copyright 2011 Sam Wong (Sam /@/ hellosam /./ net)
+
+  This work is licensed under the Creative Commons Attribution 3.0 
+  Hong Kong License. 
+
+  To view a copy of this license, visit 
+  http://creativecommons.org/licenses/by/3.0/hk/ or send a letter to 
+  Creative Commons, 444 Castro Street, Suite 900, 
+  Mountain View, California, 94041, USA.  
+*/
+
+/** Network.c: telemetry datagrams through a single bank IN endpoint.
+ *
+ * Each simulated USB frame queues a few random telemetry frames, as the
+ * SOF event does, and the main loop runs Network_USBTask() a few times.
+ * At random the host has not yet taken the last packet (Host_UsbHoldIn()),
+ * so RNDIS_Device_WriteTransfer() and RNDIS_Device_EndTransfer() stop
+ * mid-segment and resume on a later call. The host's maximum transfer
+ * size is random per round.
+ *
+ * Everything the host received is parsed back: back to back RNDIS packet
+ * messages, each an Ethernet broadcast carrying an IPv4 header with a
+ * valid checksum and consecutive IDs, a UDP header of the right lengths,
+ * and as payload the next frame the queue took, whole and in order.
+ *
+ * The benchmark is what one bank carries: datagrams and bytes per USB
+ * frame, and datagrams per transfer.
+ */
+
+#include "Host/Host.h"
+#include "Host/Usb.h"
+
+// The firmware file itself, for the RNDIS state
+#include "../Network.c"
+
+/// Rounds, each of some frames and then a drain; a round's bytes stay in HOST_USB_BUFFER_SIZE
+#define ROUNDS 2000
+#define FRAMES_PER_ROUND 100
+
+/// Main loop passes per USB frame, and the odds of the host holding the bank at each
+#define PASSES_PER_FRAME 3
+#define HELD_ODDS 3
+
+volatile uint8_t USB_DeviceState = DEVICE_STATE_Configured;
+USB_Request_Header_t USB_ControlRequest;
+
+void USB_USBTask(void)
+{
+}
+
+/// Frames the queue took and the host has not been seen to receive
+static uint8_t expected[0x10000];
+static uint32_t expectedHead;
+static uint32_t expectedTail;
+
+static uint16_t nextId;
+static uint32_t datagrams;
+static uint32_t bytes;
+static uint32_t transfers;
+static uint32_t dropped;
+
+/** Queue a random telemetry frame, as the SOF event does */
+static void QueueFrame(void)
+{
+    uint8_t frame[TELEMETRY_MAX_PAYLOAD + 4];
+    uint8_t length = Host_Random() % (TELEMETRY_MAX_PAYLOAD + 1);
+
+    frame[0] = TELEMETRY_SYNC;
+    frame[1] = 1 + Host_Random() % 8;
+    frame[2] = length;
+    for (uint8_t i = 0; i <= length; i++)
+      frame[3 + i] = Host_Random();
+
+    if (!Network_QueueFrame(frame, length + 4))
+    {
+        dropped++;
+        return;
+    }
+
+    for (uint8_t i = 0; i < length + 4; i++)
+      expected[expectedTail++ % sizeof(expected)] = frame[i];
+}
+
+/** Ones' complement sum of big endian 16 bit words */
+static uint16_t Sum(const uint8_t* data, uint8_t length)
+{
+    uint32_t sum = 0;
+
+    for (uint8_t i = 0; i < length; i += 2)
+      sum += ((uint16_t) data[i] << 8) | data[i + 1];
+    while (sum >> 16)
+      sum = (sum & 0xFFFF) + (sum >> 16);
+    return sum;
+}
+
+/** Check every datagram the host received in this round */
+static void CheckReceived(void)
+{
+    static const uint8_t ethernet[14] = { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, NETWORK_DEVICE_MAC, 0x08, 0x00 };
+    static const uint8_t addresses[8] = { NETWORK_DEVICE_IP, 255, 255, 255, 255 };
+    uint8_t* in;
+    uint32_t length = Host_UsbReceive(&in);
+    uint32_t offset = 0;
+
+    while (offset < length)
+    {
+        RNDIS_Packet_Message_t header;
+        const uint8_t* packet;
+        uint16_t payload;
+
+        HOST_CHECK(length - offset >= sizeof(header));
+        memcpy(&header, &in[offset], sizeof(header));
+        HOST_CHECK(header.MessageType == REMOTE_NDIS_PACKET_MSG);
+        HOST_CHECK(header.DataOffset == sizeof(header) - sizeof(RNDIS_Message_Header_t));
+        HOST_CHECK(header.MessageLength == sizeof(header) + header.DataLength);
+        HOST_CHECK(header.MessageLength <= length - offset);
+        HOST_CHECK(header.DataLength > NETWORK_HEADER_SIZE);
+
+        packet = &in[offset + sizeof(header)];
+        payload = header.DataLength - NETWORK_HEADER_SIZE;
+
+        // Ethernet
+        HOST_CHECK(memcmp(packet, ethernet, sizeof(ethernet)) == 0);
+
+        // IPv4: version and header length, total length, ID, TTL and protocol, checksum, addresses
+        HOST_CHECK(packet[14] == 0x45);
+        HOST_CHECK(((packet[16] << 8) | packet[17]) == 20 + 8 + payload);
+        HOST_CHECK(((packet[18] << 8) | packet[19]) == nextId);
+        HOST_CHECK(packet[22] == 64 && packet[23] == 17);
+        HOST_CHECK(Sum(&packet[14], 20) == 0xFFFF);
+        HOST_CHECK(memcmp(&packet[26], addresses, sizeof(addresses)) == 0);
+        nextId++;
+
+        // UDP
+        HOST_CHECK(((packet[34] << 8) | packet[35]) == NETWORK_UDP_PORT);
+        HOST_CHECK(((packet[36] << 8) | packet[37]) == NETWORK_UDP_PORT);
+        HOST_CHECK(((packet[38] << 8) | packet[39]) == 8 + payload);
+
+        // The next whole frame queued
+        HOST_CHECK(payload == packet[NETWORK_HEADER_SIZE + 2] + 4);
+        for (uint16_t i = 0; i < payload; i++)
+        {
+            HOST_CHECK(expectedHead < expectedTail);
+            HOST_CHECK(packet[NETWORK_HEADER_SIZE + i] == expected[expectedHead++ % sizeof(expected)]);
+        }
+
+        datagrams++;
+        offset += header.MessageLength;
+    }
+
+    bytes += length;
+}
+
+/** One main loop pass; counts the transfers finished */
+static void Task(void)
+{
+    bool inTransfer = (transferPackets != 0);
+
+    Host_UsbHoldIn(Host_Random() % HELD_ODDS == 0);
+    Network_USBTask();
+
+    if (inTransfer && transferPackets == 0)
+      transfers++;
+}
+
+int main(void)
+{
+    uint32_t frames = 0;
+
+    // Network.c builds the RNDIS header in its segment buffer
+    HOST_CHECK(sizeof(RNDIS_Packet_Message_t) <= NETWORK_SEGMENT_SIZE);
+
+    Host_UsbReset();
+    Network_Init();
+    // The emulation has no endpoints to configure, only the state to clear
+    Network_ConfigureEndpoints();
+
+    for (uint16_t round = 0; round < ROUNDS; round++)
+    {
+        Network_RNDIS_Interface.State.CurrRNDISState = RNDIS_Data_Initialized;
+        Network_RNDIS_Interface.State.HostMaxTransferSize =
+            sizeof(RNDIS_Packet_Message_t) + NETWORK_HEADER_SIZE + TELEMETRY_MAX_PAYLOAD + 4 + Host_Random() % 1024;
+
+        for (uint16_t frame = 0; frame < FRAMES_PER_ROUND; frame++, frames++)
+        {
+            for (uint8_t count = Host_Random() % 4; count; count--)
+              QueueFrame();
+
+            for (uint8_t pass = 0; pass < PASSES_PER_FRAME; pass++)
+              Task();
+        }
+
+        // Drain the queue, then take what is left in the bank
+        while (transferPackets != 0 || SPSCRingBuffer_GetCount(&buffer) != 0)
+          Task();
+        Host_UsbHoldIn(false);
+
+        CheckReceived();
+        HOST_CHECK(expectedHead == expectedTail);
+        Host_UsbReset();
+    }
+
+    printf("%lu frames: %lu datagrams in %lu transfers, %lu frames dropped by a full queue\n",
+           (unsigned long) frames, (unsigned long) datagrams, (unsigned long) transfers,
+           (unsigned long) dropped);
+    printf("benchmark: %.2f datagrams and %.1f bytes per USB frame, %.2f datagrams per transfer, 1 in %u polls held\n",
+           (double) datagrams / frames, (double) bytes / frames, (double) datagrams / transfers, HELD_ODDS);
+    printf("Network: OK\n");
+    return 0;
+}
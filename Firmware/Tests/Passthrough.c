@@ -0,0 +1,366 @@
+/*
+  Pop'n Convertible Arcade Style Controller Project
+ 
+  Copyright 2011 Sam Wong (Sam /@/ hellosam /./ net)
+
+  This work is licensed under the Creative Commons Attribution 3.0 
+  Hong Kong License. 
+
+  To view a copy of this license, visit 
+  http://creativecommons.org/licenses/by/3.0/hk/ or send a letter to 
+  Creative Commons, 444 Castro Street, Suite 900, 
+  Mountain View, California, 94041, USA.  
+*/
+
+/** Passthrough.c: the bridge frame parser and the scan's statistics.
+ *
+ * Bridge frames are scripted into a stand-in for the buffered UART and
+ * parsed by Passthrough_Task(); each Passthrough_GetState() call is one
+ * SOF scan.
+ *
+ * Scripted cases check, one at a time: the state and latency figures of
+ * a frame, a repeat of the last sequence, skipped and overwritten
+ * sequences (Lost), the release of every button after
+ * PASSTHROUGH_TIMEOUT_MS silent scans (Timeouts), and which broken frames
+ * count as BadFrames: a bad CRC or length does, a valid frame of another
+ * type does not, and the parser stays in step after each.
+ *
+ * Then a random stream of good, repeated, corrupted and foreign frames,
+ * delivered a few bytes at a time between scans with silent gaps, must
+ * give the counts of a model of the bridge link.
+ */
+
+#include "Host/Host.h"
+
+// The firmware file itself, for its stats
+#include "../Passthrough.c"
+
+/// Random frames; few enough that the 16 bit counts never wrap
+#define RANDOM_FRAMES 50000UL
+
+/// Bytes received and not yet read by the parser
+static uint8_t rxData[1024];
+static uint16_t rxHead;
+static uint16_t rxTail;
+
+void SerialBuffered_Init(const uint32_t BaudRate, const bool DoubleSpeed)
+{
+    rxHead = rxTail = 0;
+}
+
+int16_t SerialBuffered_ReceiveByte(void)
+{
+    if (rxHead == rxTail)
+      return -1;
+    return rxData[rxHead++ % sizeof(rxData)];
+}
+
+/** Receive a byte from the bridge */
+static void Receive(const uint8_t data)
+{
+    HOST_CHECK((uint16_t) (rxTail - rxHead) < sizeof(rxData));
+    rxData[rxTail++ % sizeof(rxData)] = data;
+}
+
+/** Receive a frame; a non-zero corrupt is XORed into its CRC */
+static void ReceiveFrame(const uint8_t type, const uint8_t* payload, const uint8_t length, const uint8_t corrupt)
+{
+    uint8_t crc = 0;
+
+    Receive(TELEMETRY_SYNC);
+    Receive(type);
+    crc = _crc_ibutton_update(crc, type);
+    Receive(length);
+    crc = _crc_ibutton_update(crc, length);
+    for (uint8_t i = 0; i < length; i++)
+    {
+        Receive(payload[i]);
+        crc = _crc_ibutton_update(crc, payload[i]);
+    }
+    Receive(crc ^ corrupt);
+}
+
+/** Receive a state frame */
+static void ReceiveState(const uint16_t sequence, const uint16_t age, const uint32_t state, const uint8_t corrupt)
+{
+    uint8_t payload[PASSTHROUGH_PAYLOAD_SIZE];
+
+    payload[0] = sequence;
+    payload[1] = sequence >> 8;
+    payload[2] = age;
+    payload[3] = age >> 8;
+    memcpy(&payload[4], &state, sizeof(state));
+    ReceiveFrame(PASSTHROUGH_FRAME_STATE, payload, sizeof(payload), corrupt);
+}
+
+/** Stats, through the feature report */
+static PassthroughStats_t Stats(void)
+{
+    uint8_t report[PASSTHROUGH_FEATURE_REPORT_SIZE];
+    PassthroughStats_t copy;
+
+    Passthrough_CreateFeatureReport(report);
+    memcpy(&copy, report, sizeof(copy));
+    return copy;
+}
+
+/** Clear the stats and let the link time out, as after a reset */
+static void Restart(void)
+{
+    for (uint16_t i = 0; i < PASSTHROUGH_TIMEOUT_MS; i++)
+      Passthrough_GetState();
+    Passthrough_ProcessFeatureReport(NULL, 0);
+    HOST_CHECK(Stats().Frames == 0 && Stats().Timeouts == 0);
+}
+
+static void TestScripted(void)
+{
+    static const uint8_t foreign[5] = { 1, 2, TELEMETRY_SYNC, 4, 5 };
+    PassthroughStats_t s;
+
+    Passthrough_Init();
+
+    // No bridge yet: released, and not counted as a timeout
+    for (uint16_t i = 0; i < 2 * PASSTHROUGH_TIMEOUT_MS; i++)
+      HOST_CHECK(Passthrough_GetState() == 0);
+    HOST_CHECK(Stats().Timeouts == 0);
+
+    // A frame after noise; taken by the next scan with its figures
+    Receive(0x00);
+    Receive(0xFF);
+    ReceiveState(100, 300, 0x80000001UL, 0);
+    Passthrough_Task();
+    HOST_CHECK(Passthrough_GetState() == 0x80000001UL);
+    s = Stats();
+    HOST_CHECK(s.Frames == 1 && s.Lost == 0 && s.BadFrames == 0);
+    HOST_CHECK(s.LastAge == 300 && s.MaxAge == 300);
+    HOST_CHECK(s.LastWait == PASSTHROUGH_FRAME_US);
+    HOST_CHECK(s.LastLatency == 300 + PASSTHROUGH_LINK_US + PASSTHROUGH_FRAME_US);
+    HOST_CHECK(s.MaxLatency == s.LastLatency);
+
+    // The state holds between frames
+    HOST_CHECK(Passthrough_GetState() == 0x80000001UL);
+
+    // A repeat of the same sequence is not a new state
+    ReceiveState(100, 50, 0x80000001UL, 0);
+    Passthrough_Task();
+    Passthrough_GetState();
+    s = Stats();
+    HOST_CHECK(s.Frames == 1 && s.LastAge == 300);
+
+    // Two sequences skipped by the bridge
+    ReceiveState(103, 200, 0x3, 0);
+    Passthrough_Task();
+    HOST_CHECK(Passthrough_GetState() == 0x3);
+    s = Stats();
+    HOST_CHECK(s.Frames == 2 && s.Lost == 2);
+    HOST_CHECK(s.LastAge == 200 && s.MaxAge == 300);
+    HOST_CHECK(s.LastLatency == 200 + PASSTHROUGH_LINK_US + PASSTHROUGH_FRAME_US);
+    HOST_CHECK(s.MaxLatency == 300 + PASSTHROUGH_LINK_US + PASSTHROUGH_FRAME_US);
+
+    // Two frames between scans: the scan sees only the second
+    ReceiveState(104, 10, 0x4, 0);
+    ReceiveState(105, 20, 0x5, 0);
+    Passthrough_Task();
+    HOST_CHECK(Passthrough_GetState() == 0x5);
+    s = Stats();
+    HOST_CHECK(s.Frames == 3 && s.Lost == 3 && s.LastAge == 20);
+
+    // Sequence wrap is not a loss
+    ReceiveState(0xFFFF, 0, 0x6, 0);
+    ReceiveState(0xFFFF, 0, 0x6, 0);
+    Passthrough_Task();
+    Passthrough_GetState();
+    ReceiveState(0x0000, 0, 0x7, 0);
+    Passthrough_Task();
+    HOST_CHECK(Passthrough_GetState() == 0x7);
+    s = Stats();
+    HOST_CHECK(s.Frames == 5 && s.Lost == 3 + (uint16_t) (0xFFFF - 105 - 1));
+
+    // Broken frames: bad CRC, our type with another length, an impossible length
+    Passthrough_ProcessFeatureReport(NULL, 0);
+    ReceiveState(1, 0, 0xFF, 0x40);
+    ReceiveFrame(PASSTHROUGH_FRAME_STATE, foreign, sizeof(foreign), 0);
+    Receive(TELEMETRY_SYNC);
+    Receive(PASSTHROUGH_FRAME_STATE);
+    Receive(TELEMETRY_MAX_PAYLOAD + 1);
+    Passthrough_Task();
+    HOST_CHECK(Passthrough_GetState() == 0x7);
+    HOST_CHECK(Stats().BadFrames == 3);
+
+    // A valid frame of another type is skipped without a count, even with SYNC in its payload
+    ReceiveFrame(0x01, foreign, sizeof(foreign), 0);
+    ReceiveFrame(0x01, foreign, 0, 0);
+    Passthrough_Task();
+    HOST_CHECK(Stats().BadFrames == 3);
+
+    // ... unless its CRC is bad
+    ReceiveFrame(0x01, foreign, sizeof(foreign), 0x01);
+    Passthrough_Task();
+    HOST_CHECK(Stats().BadFrames == 4);
+
+    // And the parser is in step for the next
+    ReceiveState(2, 0, 0x8, 0);
+    Passthrough_Task();
+    HOST_CHECK(Passthrough_GetState() == 0x8);
+    s = Stats();
+    HOST_CHECK(s.Frames == 1 && s.BadFrames == 4);
+
+    // One silent scan short of the timeout keeps the buttons ...
+    for (uint16_t i = 0; i < PASSTHROUGH_TIMEOUT_MS - 1; i++)
+      HOST_CHECK(Passthrough_GetState() == 0x8);
+    HOST_CHECK(Stats().Timeouts == 0);
+
+    // ... the next releases them, once
+    HOST_CHECK(Passthrough_GetState() == 0);
+    for (uint16_t i = 0; i < 2 * PASSTHROUGH_TIMEOUT_MS; i++)
+      HOST_CHECK(Passthrough_GetState() == 0);
+    HOST_CHECK(Stats().Timeouts == 1);
+
+    // A frame after the timeout brings the state back
+    ReceiveState(3, 0, 0x9, 0);
+    Passthrough_Task();
+    HOST_CHECK(Passthrough_GetState() == 0x9);
+    HOST_CHECK(Stats().Frames == 2 && Stats().Lost == 0);
+
+    printf("scripted: latency %u us = age %u + link %lu + wait %u\n",
+           Stats().LastLatency, Stats().LastAge, PASSTHROUGH_LINK_US, Stats().LastWait);
+}
+
+/// Model of the scan for the random stream
+static struct
+{
+    bool Pending;
+    bool Any;
+    uint16_t Sequence;
+    uint16_t LastSequence;
+    uint32_t State;
+    uint16_t Silent;
+    uint32_t Frames;
+    uint32_t Lost;
+    uint32_t Timeouts;
+} model;
+
+/** One scan, checked against the model */
+static void Scan(void)
+{
+    if (model.Pending)
+    {
+        if (!model.Any || model.Sequence != model.LastSequence)
+        {
+            if (model.Any)
+              model.Lost += (uint16_t) (model.Sequence - model.LastSequence - 1);
+            model.LastSequence = model.Sequence;
+            model.Frames++;
+        }
+        model.Any = true;
+        model.Pending = false;
+        model.Silent = 0;
+    } else if (model.Silent < PASSTHROUGH_TIMEOUT_MS && ++model.Silent == PASSTHROUGH_TIMEOUT_MS) {
+        model.State = 0;
+        model.Timeouts++;
+    }
+
+    HOST_CHECK(Passthrough_GetState() == model.State);
+}
+
+static void TestRandom(void)
+{
+    uint16_t sequence = 0;
+    uint32_t state = 0;
+    uint32_t bad = 0;
+    uint16_t maxAge = 0;
+    uint32_t sent;
+    uint32_t scans;
+    PassthroughStats_t s;
+
+    Restart();
+    memset(&model, 0, sizeof(model));
+    model.Silent = PASSTHROUGH_TIMEOUT_MS;
+
+    for (sent = 0, scans = 0; sent < RANDOM_FRAMES; scans++)
+    {
+        uint8_t count = Host_Random() % 3;
+
+        // Now and then the bridge goes quiet for a while
+        if (Host_Random() % 200 == 0)
+        {
+            for (uint16_t gap = Host_Random() % (2 * PASSTHROUGH_TIMEOUT_MS); gap; gap--, scans++)
+              Scan();
+        }
+
+        for (uint8_t i = 0; i < count; i++, sent++)
+        {
+            uint8_t payload[TELEMETRY_MAX_PAYLOAD];
+            uint16_t age = Host_Random() % 2000;
+
+            for (uint8_t j = 0; j < sizeof(payload); j++)
+              payload[j] = Host_Random();
+
+            switch (Host_Random() % 6)
+            {
+                case 0:
+                case 1:
+                    // A new report, after any the bridge skipped
+                    sequence += 1 + ((Host_Random() % 8 == 0) ? Host_Random() % 4 : 0);
+                    state = Host_Random();
+                    // fall through
+                case 2:
+                    ReceiveState(sequence, age, state, 0);
+                    model.Pending = true;
+                    model.Sequence = sequence;
+                    model.State = state;
+                    if (age > maxAge)
+                      maxAge = age;
+                    break;
+                case 3:
+                    ReceiveState(sequence + 1, age, Host_Random(), 1 << (Host_Random() % 8));
+                    bad++;
+                    break;
+                case 4:
+                    ReceiveFrame(PASSTHROUGH_FRAME_STATE, payload, Host_Random() % PASSTHROUGH_PAYLOAD_SIZE, 0);
+                    bad++;
+                    break;
+                case 5:
+                    ReceiveFrame(0x01 + Host_Random() % 8, payload, Host_Random() % (TELEMETRY_MAX_PAYLOAD + 1), 0);
+                    break;
+            }
+        }
+
+        // The UART delivers the bytes over several main loop passes
+        while (rxHead != rxTail)
+        {
+            uint16_t tail = rxTail;
+            uint16_t chunk = 1 + Host_Random() % 8;
+
+            if ((uint16_t) (tail - rxHead) > chunk)
+              rxTail = rxHead + chunk;
+            Passthrough_Task();
+            rxTail = tail;
+        }
+
+        Scan();
+    }
+
+    s = Stats();
+    HOST_CHECK(s.Frames == (uint16_t) model.Frames);
+    HOST_CHECK(s.Lost == (uint16_t) model.Lost);
+    HOST_CHECK(s.Timeouts == (uint16_t) model.Timeouts);
+    HOST_CHECK(s.BadFrames == (uint16_t) bad);
+    HOST_CHECK(s.MaxAge == maxAge);
+    HOST_CHECK(s.MaxWait == PASSTHROUGH_FRAME_US);
+    HOST_CHECK(s.MaxLatency == maxAge + PASSTHROUGH_LINK_US + PASSTHROUGH_FRAME_US);
+
+    printf("random: %lu frames over %lu scans: %lu new states, %lu lost, %lu bad, %lu timeouts\n",
+           (unsigned long) sent, (unsigned long) scans, (unsigned long) model.Frames,
+           (unsigned long) model.Lost, (unsigned long) bad, (unsigned long) model.Timeouts);
+}
+
+int main(void)
+{
+    TestScripted();
+    TestRandom();
+
+    printf("Passthrough: OK\n");
+    return 0;
+}
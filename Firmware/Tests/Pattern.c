@@ -0,0 +1,156 @@
+/*
+  Pop'n Convertible Arcade Style Controller Project
+ 
+  Copyright 2011 Sam Wong (Sam /@/ hellosam /./ net)
+
+  This work is licensed under the Creative Commons Attribution 3.0 
+  Hong Kong License. 
+
+  To view a copy of this license, visit 
+  http://creativecommons.org/licenses/by/3.0/hk/ or send a letter to 
+  Creative Commons, 444 Castro Street, Suite 900, 
+  Mountain View, California, 94041, USA.  
+*/
+
+/** Pattern.c: step timing of the synthetic button patterns.
+ *
+ * Each pattern is played at several step times for three loops, one
+ * Pattern_Next() per millisecond: every step must hold for exactly its
+ * step time, in table order, and wrap to the first. Pattern_Restart()
+ * mid-step must start the first step afresh.
+ *
+ * A pattern selected mid-play keeps the position: a longer one goes on
+ * from the same step, and a shorter one, whose count the step is past,
+ * goes back to its first step for the rest of the step time. A shorter
+ * step time than has already elapsed ends the step at the next call.
+ * Bad selections are refused and leave the pattern playing.
+ */
+
+#include "Host/Host.h"
+
+// The firmware file itself, for the step tables
+#include "../Pattern.c"
+
+/// Step tables by pattern, and their counts
+#define STEPS(Pattern) ((const uint16_t*) patterns[Pattern].Steps)
+#define COUNT(Pattern) (patterns[Pattern].Count)
+
+/** The next calls, one per millisecond, must give the state for exactly ms calls */
+static void Expect(uint16_t state, uint16_t ms)
+{
+    while (ms--)
+      HOST_CHECK(Pattern_Next() == state);
+}
+
+static void TestTiming(void)
+{
+    static const uint8_t times[] = { 1, 2, 25, PATTERN_DEFAULT_STEP_TIME, 255 };
+
+    for (uint8_t pattern = 0; pattern < PATTERN_COUNT; pattern++)
+    {
+        for (uint8_t t = 0; t < sizeof(times); t++)
+        {
+            HOST_CHECK(Pattern_Select(pattern, times[t]) == CONFIG_STATUS_OK);
+            Pattern_Restart();
+
+            for (uint8_t loop = 0; loop < 3; loop++)
+            {
+                for (uint8_t i = 0; i < COUNT(pattern); i++)
+                  Expect(STEPS(pattern)[i], times[t]);
+            }
+        }
+    }
+}
+
+static void TestRestart(void)
+{
+    Pattern_Select(PATTERN_STREAM, 10);
+    Pattern_Restart();
+
+    // Part way into the fourth step
+    Expect(STEPS(PATTERN_STREAM)[0], 10);
+    Expect(STEPS(PATTERN_STREAM)[1], 10);
+    Expect(STEPS(PATTERN_STREAM)[2], 10);
+    Expect(STEPS(PATTERN_STREAM)[3], 4);
+
+    Pattern_Restart();
+    Expect(STEPS(PATTERN_STREAM)[0], 10);
+    Expect(STEPS(PATTERN_STREAM)[1], 10);
+
+    // At a step boundary
+    Pattern_Restart();
+    Expect(STEPS(PATTERN_STREAM)[0], 10);
+}
+
+static void TestSwitch(void)
+{
+    // To a longer pattern: the same step goes on
+    Pattern_Select(PATTERN_TRILL, 20);
+    Pattern_Restart();
+    Expect(STEPS(PATTERN_TRILL)[0], 20);
+    Expect(STEPS(PATTERN_TRILL)[1], 5);
+    Pattern_Select(PATTERN_STREAM, 20);
+    Expect(STEPS(PATTERN_STREAM)[1], 15);
+    Expect(STEPS(PATTERN_STREAM)[2], 20);
+
+    // To a shorter pattern past its end: its first step, for the rest of the step time
+    Pattern_Select(PATTERN_STREAM, 20);
+    Pattern_Restart();
+    for (uint8_t i = 0; i < 20; i++)
+      Expect(STEPS(PATTERN_STREAM)[i], 20);
+    Expect(STEPS(PATTERN_STREAM)[20], 7);
+    Pattern_Select(PATTERN_JACK, 20);
+    Expect(STEPS(PATTERN_JACK)[0], 13);
+    Expect(STEPS(PATTERN_JACK)[1], 20);
+    Expect(STEPS(PATTERN_JACK)[0], 20);
+
+    // Exactly at its end
+    Pattern_Select(PATTERN_CHORDS, 5);
+    Pattern_Restart();
+    for (uint8_t i = 0; i < COUNT(PATTERN_TRILL); i++)
+      Expect(STEPS(PATTERN_CHORDS)[i], 5);
+    Pattern_Select(PATTERN_TRILL, 5);
+    Expect(STEPS(PATTERN_TRILL)[0], 5);
+    Expect(STEPS(PATTERN_TRILL)[1], 5);
+
+    // To the one step pattern, and back
+    Pattern_Select(PATTERN_HOLD, 5);
+    Expect(0xFFFF, 50);
+    Pattern_Select(PATTERN_JACK, 5);
+    Expect(STEPS(PATTERN_JACK)[0], 5);
+    Expect(STEPS(PATTERN_JACK)[1], 5);
+
+    // A step time shorter than already elapsed ends the step at the next call
+    Pattern_Select(PATTERN_STREAM, 50);
+    Pattern_Restart();
+    Expect(STEPS(PATTERN_STREAM)[0], 30);
+    Pattern_Select(PATTERN_STREAM, 10);
+    Expect(STEPS(PATTERN_STREAM)[0], 1);
+    Expect(STEPS(PATTERN_STREAM)[1], 10);
+}
+
+static void TestSelect(void)
+{
+    Pattern_Select(PATTERN_JACK, 3);
+    Pattern_Restart();
+
+    HOST_CHECK(Pattern_Select(PATTERN_COUNT, 3) == CONFIG_STATUS_BAD_VALUE);
+    HOST_CHECK(Pattern_Select(PATTERN_STREAM, 0) == CONFIG_STATUS_BAD_VALUE);
+    Expect(STEPS(PATTERN_JACK)[0], 3);
+    Expect(STEPS(PATTERN_JACK)[1], 3);
+}
+
+int main(void)
+{
+    // Power-up: all keys down, as the debug button always did
+    Expect(0xFFFF, 1000);
+
+    TestTiming();
+    TestRestart();
+    TestSwitch();
+    TestSelect();
+
+    printf("%u patterns at 1 to 255 ms steps, restart and switching mid-play\n", PATTERN_COUNT);
+    printf("Pattern: OK\n");
+    return 0;
+}
@@ -0,0 +1,137 @@
+/*
+  Pop'n Convertible Arcade Style Controller Project
+ 
+  Copyright 2011 Sam Wong (Sam /@/ hellosam /./ net)
+
+  This work is licensed under the Creative Commons Attribution 3.0 
+  Hong Kong License. 
+
+  To view a copy of this license, visit 
+  http://creativecommons.org/licenses/by/3.0/hk/ or send a letter to 
+  Creative Commons, 444 Castro Street, Suite 900, 
+  Mountain View, California, 94041, USA.  
+*/
+
+/** Remap.c: exhaustive test of the nibble tables.
+ *
+ * A nibble's table only depends on the map of its own 4 inputs, and
+ * Remap_Apply() ORs the tables together. So checking every map of each
+ * nibble's inputs (16 report bits or unmapped: 17^4 maps) at every
+ * nibble value covers every map of every input. Remap_Apply() is then
+ * checked over all 65536 input states for random whole maps, and
+ * Remap_FindInput() for every bit of those maps.
+ *
+ * Built twice: for the 9 direct buttons (3 nibbles, inputs 9-11 do not
+ * exist and must never map) and with SHIFT_REGISTER_INPUTS (4 nibbles).
+ */
+
+#include "Host/Host.h"
+
+#include "Remap.h"
+
+#include <string.h>
+
+/// Random whole maps applied over all input states
+#define APPLY_MAPS 200
+
+/** Report bits of the given input states, straight from the map */
+static uint16_t Reference(const uint8_t* map, const uint16_t inputs)
+{
+    uint16_t mapped = 0;
+
+    for (uint8_t input = 0; input < CONFIG_MAPPED_BUTTONS; input++)
+    {
+        if (input < BUTTON_COUNT && (inputs & (1 << input)) && map[input] != CONFIG_UNMAPPED)
+          mapped |= 1 << map[input];
+    }
+
+    return mapped;
+}
+
+/** Map entry 0 to 16 as a report bit, 16 being unmapped */
+static uint8_t MapEntry(const uint8_t choice)
+{
+    return (choice == 16) ? CONFIG_UNMAPPED : choice;
+}
+
+/** Every map of each nibble's inputs, the others unmapped */
+static void TestNibbles(void)
+{
+    uint8_t map[CONFIG_MAPPED_BUTTONS];
+    uint32_t checks = 0;
+
+    for (uint8_t nibble = 0; nibble < REMAP_NIBBLES; nibble++)
+    {
+        for (uint32_t maps = 0; maps < 17 * 17 * 17 * 17; maps++)
+        {
+            uint32_t choices = maps;
+
+            memset(map, CONFIG_UNMAPPED, sizeof(map));
+            for (uint8_t input = 0; input < 4; input++)
+            {
+                map[nibble * 4 + input] = MapEntry(choices % 17);
+                choices /= 17;
+            }
+
+            Remap_Compile(map);
+
+            for (uint8_t other = 0; other < REMAP_NIBBLES; other++)
+            {
+                for (uint8_t value = 0; value < 16; value++)
+                {
+                    uint16_t expected = (other == nibble) ? Reference(map, value << (nibble * 4)) : 0;
+
+                    HOST_CHECK(remapTable[other][value] == expected);
+                    checks++;
+                }
+            }
+        }
+    }
+
+    printf("nibbles: %u tables, every map of each nibble: %lu entries\n", REMAP_NIBBLES, (unsigned long) checks);
+}
+
+/** Random whole maps over all input states */
+static void TestApply(void)
+{
+    uint8_t map[CONFIG_MAPPED_BUTTONS];
+
+    for (uint16_t maps = 0; maps < APPLY_MAPS; maps++)
+    {
+        for (uint8_t input = 0; input < CONFIG_MAPPED_BUTTONS; input++)
+          map[input] = MapEntry(Host_Random() % 17);
+
+        Remap_Compile(map);
+        HOST_CHECK(!remapCompiling);
+
+        for (uint32_t inputs = 0; inputs < 0x10000; inputs++)
+          HOST_CHECK(Remap_Apply(inputs) == Reference(map, inputs));
+
+        for (uint8_t bit = 0; bit < 16; bit++)
+        {
+            uint8_t expected = CONFIG_MAPPED_BUTTONS;
+
+            for (uint8_t input = 0; input < REMAP_NIBBLES * 4 && input < BUTTON_COUNT; input++)
+            {
+                if (map[input] == bit)
+                {
+                    expected = input;
+                    break;
+                }
+            }
+
+            HOST_CHECK(Remap_FindInput(bit) == expected);
+        }
+    }
+
+    printf("apply: %u random maps, all 65536 input states\n", APPLY_MAPS);
+}
+
+int main(void)
+{
+    TestNibbles();
+    TestApply();
+
+    printf("Remap (%u inputs): OK\n", BUTTON_COUNT);
+    return 0;
+}
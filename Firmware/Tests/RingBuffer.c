@@ -0,0 +1,239 @@
+/*
+  Pop'n Convertible Arcade Style Controller Project
+ 
+  Copyright 2011 Sam Wong (Sam /@/ hellosam /./ net)
+
+  This work is licensed under the Creative Commons Attribution 3.0 
+  Hong Kong License. 
+
+  To view a copy of this license, visit 
+  http://creativecommons.org/licenses/by/3.0/hk/ or send a letter to 
+  Creative Commons, 444 Castro Street, Suite 900, 
+  Mountain View, California, 94041, USA.  
+*/
+
+/** SPSCRingBuffer.h: threaded stress test and benchmark.
+ *
+ * Stress: a producer and a consumer thread pass a counting byte sequence
+ * through buffers of 2, 16 and 128 bytes, each side switching between
+ * the single byte and the span calls at random. Any lost, repeated or
+ * reordered byte fails. Real threads interleave anywhere, not only at
+ * instruction boundaries as an ISR does, so this is a stronger test than
+ * the AVR needs. It relies on the host keeping stores in order (x86), as
+ * the AVR does; on other hosts only the benchmark runs.
+ *
+ * Benchmark: bytes through a 64 byte buffer in one thread, in bursts of
+ * 48, with the single byte and the span calls, against the locking
+ * RingBuffer.h. On the host interrupt locking is a plain variable, so
+ * these times understate the AVR's difference: there each RingBuffer.h
+ * call also saves SREG, disables interrupts and restores SREG, and
+ * updates a 16-bit count through a pointer.
+ */
+
+#include "Host/Host.h"
+
+#include <LUFA/Drivers/Misc/SPSCRingBuffer.h>
+#include <LUFA/Drivers/Misc/RingBuffer.h>
+
+#include <pthread.h>
+#include <sched.h>
+
+/// Bytes passed through each buffer size in the stress test
+#define STRESS_BYTES 2000000UL
+
+/// Bytes passed through in each benchmark
+#define BENCHMARK_BYTES 20000000UL
+
+/// Burst length of the benchmark
+#define BENCHMARK_BURST 48
+
+static SPSCRingBuffer_t stressBuffer;
+
+/** Producer thread: writes a counting sequence */
+static void* Producer(void* unused)
+{
+    uint32_t sent = 0;
+    uint32_t seed = 1;
+
+    while (sent < STRESS_BYTES)
+    {
+        uint8_t* span;
+        uint8_t length;
+        uint8_t i;
+
+        seed = seed * 1103515245 + 12345;
+
+        if (seed & 0x10000)
+        {
+            if (SPSCRingBuffer_IsFull(&stressBuffer))
+            {
+                sched_yield();
+                continue;
+            }
+
+            SPSCRingBuffer_Insert(&stressBuffer, (uint8_t) sent++);
+        }
+        else
+        {
+            length = SPSCRingBuffer_GetWriteSpan(&stressBuffer, &span);
+            if (length == 0)
+            {
+                sched_yield();
+                continue;
+            }
+
+            // Fill only part of the span at times
+            if (seed & 0x20000)
+              length = 1 + (seed >> 24) % length;
+            if (length > STRESS_BYTES - sent)
+              length = STRESS_BYTES - sent;
+
+            for (i = 0; i < length; i++)
+            {
+                span[i] = (uint8_t) sent++;
+            }
+
+            SPSCRingBuffer_CommitWrite(&stressBuffer, length);
+        }
+    }
+
+    return unused;
+}
+
+/** Run the stress test on one buffer size */
+static void Stress(uint8_t* storage, uint8_t size)
+{
+    pthread_t producer;
+    uint32_t received = 0;
+    uint32_t seed = 2;
+
+    SPSCRingBuffer_InitBufferMask(&stressBuffer, storage, size - 1);
+    HOST_CHECK(pthread_create(&producer, NULL, Producer, NULL) == 0);
+
+    while (received < STRESS_BYTES)
+    {
+        uint8_t* span;
+        uint8_t length;
+        uint8_t i;
+
+        seed = seed * 1103515245 + 12345;
+
+        if (seed & 0x10000)
+        {
+            if (SPSCRingBuffer_IsEmpty(&stressBuffer))
+            {
+                sched_yield();
+                continue;
+            }
+
+            HOST_CHECK(SPSCRingBuffer_Peek(&stressBuffer) == (uint8_t) received);
+            HOST_CHECK(SPSCRingBuffer_Remove(&stressBuffer) == (uint8_t) received);
+            received++;
+        }
+        else
+        {
+            length = SPSCRingBuffer_GetReadSpan(&stressBuffer, &span);
+            if (length == 0)
+            {
+                sched_yield();
+                continue;
+            }
+
+            HOST_CHECK(length <= size);
+            if (seed & 0x20000)
+              length = 1 + (seed >> 24) % length;
+
+            for (i = 0; i < length; i++)
+            {
+                HOST_CHECK(span[i] == (uint8_t) received);
+                received++;
+            }
+
+            SPSCRingBuffer_CommitRead(&stressBuffer, length);
+        }
+
+        HOST_CHECK(SPSCRingBuffer_GetCount(&stressBuffer) <= size);
+    }
+
+    HOST_CHECK(pthread_join(producer, NULL) == 0);
+    HOST_CHECK(SPSCRingBuffer_IsEmpty(&stressBuffer));
+
+    printf("stress: %lu bytes through %u byte buffer, in order\n", STRESS_BYTES, size);
+}
+
+/** Time a benchmark loop, in nanoseconds per byte */
+#define BENCHMARK(name, body)                                                            \
+    do                                                                                   \
+    {                                                                                    \
+        uint64_t start = Host_Nanoseconds();                                             \
+        uint32_t done;                                                                   \
+                                                                                         \
+        for (done = 0; done < BENCHMARK_BYTES; done += BENCHMARK_BURST)                  \
+        {                                                                                \
+            body                                                                         \
+        }                                                                                \
+                                                                                         \
+        printf("benchmark: %-22s %5.2f ns/byte\n", name,                                 \
+               (double) (Host_Nanoseconds() - start) / BENCHMARK_BYTES);                 \
+    } while (0)
+
+int main(void)
+{
+    static uint8_t storage2[2];
+    static uint8_t storage16[16];
+    static uint8_t storage128[128];
+    static uint8_t spscData[64];
+    static uint8_t lockedData[64];
+    static SPSCRingBuffer_t spsc = SPSC_RINGBUFFER_INITIALIZER(spscData);
+    static RingBuffer_t locked;
+    volatile uint8_t sink = 0;
+    uint8_t i;
+
+#if defined(__x86_64__) || defined(__i386__)
+    Stress(storage2, sizeof(storage2));
+    Stress(storage16, sizeof(storage16));
+    Stress(storage128, sizeof(storage128));
+#else
+    (void) storage2; (void) storage16; (void) storage128;
+    printf("stress: skipped, the host may reorder stores\n");
+#endif
+
+    RingBuffer_InitBuffer(&locked, lockedData, sizeof(lockedData));
+
+    BENCHMARK("RingBuffer.h byte",
+        for (i = 0; i < BENCHMARK_BURST; i++)
+          RingBuffer_Insert(&locked, i);
+        for (i = 0; i < BENCHMARK_BURST; i++)
+          sink += RingBuffer_Remove(&locked);
+    );
+
+    BENCHMARK("SPSCRingBuffer.h byte",
+        for (i = 0; i < BENCHMARK_BURST; i++)
+          SPSCRingBuffer_Insert(&spsc, i);
+        for (i = 0; i < BENCHMARK_BURST; i++)
+          sink += SPSCRingBuffer_Remove(&spsc);
+    );
+
+    BENCHMARK("SPSCRingBuffer.h span",
+        uint8_t* span;
+        uint8_t length;
+        uint8_t left;
+
+        for (left = BENCHMARK_BURST; left; left -= length)
+        {
+            length = MIN(SPSCRingBuffer_GetWriteSpan(&spsc, &span), left);
+            for (i = 0; i < length; i++)
+              span[i] = i;
+            SPSCRingBuffer_CommitWrite(&spsc, length);
+        }
+        for (left = BENCHMARK_BURST; left; left -= length)
+        {
+            length = MIN(SPSCRingBuffer_GetReadSpan(&spsc, &span), left);
+            for (i = 0; i < length; i++)
+              sink += span[i];
+            SPSCRingBuffer_CommitRead(&spsc, length);
+        }
+    );
+
+    return 0;
+}
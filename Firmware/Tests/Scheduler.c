@@ -0,0 +1,272 @@
+/*
+  Pop'n Convertible Arcade Style Controller Project
+ 
+  Copyright 2011 Sam Wong (Sam /@/ hellosam /./ net)
+
+  This work is licensed under the Creative Commons Attribution 3.0 
+  Hong Kong License. 
+
+  To view a copy of this license, visit 
+  http://creativecommons.org/licenses/by/3.0/hk/ or send a letter to 
+  Creative Commons, 444 Castro Street, Suite 900, 
+  Mountain View, California, 94041, USA.  
+*/
+
+/** DeadlineScheduler.c: start latency under a simulated Timer 1 and SOF.
+ *
+ * Timer 1 is emulated (HOST_TIMER_EMULATION): every read of TCNT1 takes
+ * a tick, tasks take their run time in ticks, and sleeping jumps to the
+ * next SOF or compare match. An SOF every millisecond is delivered as
+ * soon as time passes it with interrupts enabled, wherever the scheduler
+ * is, and releases the report and lamp tasks as the firmware's does. A
+ * periodic load task with random run times competes with them.
+ *
+ * Each run of a released task checks its true latency, from the SOF to
+ * the scheduler's pass that started it, against the worst latency the
+ * scheduler recorded: the recorded one must never be the smaller. The
+ * report task must run in every frame, within the run time of the
+ * longest task it can wait behind. With the firmware's 100us deadline
+ * the load task makes it miss some; with a deadline of that bound it
+ * must miss none.
+ */
+
+#include "Host/Host.h"
+
+#include <LUFA/Scheduler/DeadlineScheduler.h>
+
+#include <avr/interrupt.h>
+#include <string.h>
+
+/// Frames simulated in each run
+#define FRAMES 100000UL
+
+/// Ticks from one SOF to the next
+#define SOF_TICKS DEADLINE_SCHEDULER_US_TO_TICKS(1000)
+
+/// Longest run of each task, in ticks
+#define REPORT_MAX_COST 40
+#define LAMP_MAX_COST   60
+#define LOAD_MAX_COST   80
+
+/// Timer reads of a pass of the scheduler, on top of the task it waits behind
+#define PASS_TICKS 4
+
+enum
+{
+    REPORT_TASK,
+    LAMP_TASK,
+    LOAD_TASK,
+};
+
+DEADLINE_TASK(ReportTask);
+DEADLINE_TASK(LampTask);
+DEADLINE_TASK(LoadTask);
+
+/** As the firmware's, plus a periodic load at the lamp task's priority */
+DEADLINE_TASK_LIST
+{
+    [REPORT_TASK] = { .Task     = ReportTask,
+                      .Priority = 0,
+                      .Period   = DEADLINE_SCHEDULER_MS_TO_TICKS(1),
+                      .Deadline = DEADLINE_SCHEDULER_US_TO_TICKS(100),
+                      .Enabled  = true },
+    [LAMP_TASK]   = { .Task     = LampTask,
+                      .Priority = 1,
+                      .Period   = 0,
+                      .Deadline = DEADLINE_SCHEDULER_US_TO_TICKS(900),
+                      .Enabled  = true },
+    [LOAD_TASK]   = { .Task     = LoadTask,
+                      .Priority = 1,
+                      .Period   = DEADLINE_SCHEDULER_MS_TO_TICKS(3),
+                      .Deadline = DEADLINE_SCHEDULER_MS_TO_TICKS(2),
+                      .Enabled  = true },
+};
+
+/// Simulated time in ticks, and the TCNT1 value of the last read
+static uint32_t hostTime;
+static uint32_t lastRead;
+static uint16_t timer;
+
+/// Time of the next SOF
+static uint32_t nextSof;
+
+/// Per SOF released task: time of the SOF it has yet to serve, if any
+typedef struct
+{
+    bool     Released;
+    uint32_t Sof;
+    uint32_t MaxLatency;
+    uint32_t Runs;
+} Served_t;
+
+static Served_t report;
+static Served_t lamp;
+static uint32_t frames;
+static uint32_t sleeps;
+
+/** The SOF interrupt handler */
+static void StartOfFrame(const uint32_t sof)
+{
+    // Every frame's report is sent before the next SOF
+    HOST_CHECK(!report.Released);
+
+    report.Released = true;
+    report.Sof      = sof;
+    DeadlineScheduler_ReleaseTask(REPORT_TASK);
+
+    if (!lamp.Released)
+    {
+        lamp.Released = true;
+        lamp.Sof      = sof;
+    }
+    DeadlineScheduler_ReleaseTask(LAMP_TASK);
+
+    frames++;
+}
+
+/** Deliver the SOFs due by now, unless interrupts are disabled */
+static void Deliver(void)
+{
+    while (hostTime >= nextSof && (SREG & 0x80))
+    {
+        StartOfFrame(nextSof);
+        nextSof += SOF_TICKS;
+    }
+}
+
+/** Time passing in a task */
+static void Run(const uint32_t maxCost)
+{
+    uint32_t cost = Host_Random() % (maxCost + 1);
+
+    while (cost--)
+    {
+        hostTime++;
+        Deliver();
+    }
+}
+
+volatile uint16_t* Host_Timer1(void)
+{
+    Deliver();
+
+    lastRead = hostTime;
+    timer    = hostTime;
+    hostTime++;
+
+    return &timer;
+}
+
+void Host_Sleep(void)
+{
+    // No release may be left waiting for a wake event
+    for (uint8_t i = 0; i < DeadlineScheduler_TotalTasks; i++)
+      HOST_CHECK(!DeadlineScheduler_TaskList[i].Pending);
+
+    HOST_CHECK(SREG & 0x80);
+
+    uint32_t wake = nextSof;
+
+    if (TIMSK1 & (1 << OCIE1A))
+    {
+        uint16_t toMatch = OCR1A - (uint16_t) hostTime;
+        uint32_t match   = hostTime + (toMatch ? toMatch : 0x10000UL);
+
+        if (match < wake)
+          wake = match;
+    }
+
+    if (wake > hostTime)
+      hostTime = wake;
+
+    sleeps++;
+    Deliver();
+}
+
+/** True latency of an SOF released task, from the SOF to the pass that started it */
+static void Started(Served_t* served, const uint8_t task)
+{
+    if (served->Released)
+    {
+        uint32_t latency = lastRead - served->Sof;
+
+        // The scheduler may overstate a latency, but must never understate one
+        HOST_CHECK(latency <= DeadlineScheduler_TaskList[task].MaxStartLatency);
+
+        if (latency > served->MaxLatency)
+          served->MaxLatency = latency;
+
+        served->Released = false;
+    }
+
+    served->Runs++;
+}
+
+DEADLINE_TASK(ReportTask)
+{
+    Started(&report, REPORT_TASK);
+    Run(REPORT_MAX_COST);
+}
+
+DEADLINE_TASK(LampTask)
+{
+    Started(&lamp, LAMP_TASK);
+    Run(LAMP_MAX_COST);
+}
+
+DEADLINE_TASK(LoadTask)
+{
+    Run(LOAD_MAX_COST);
+}
+
+/** Simulate FRAMES frames, the report task having the given deadline */
+static void Simulate(const uint16_t deadline)
+{
+    DeadlineScheduler_TaskList[REPORT_TASK].Deadline = deadline;
+
+    memset(&report, 0, sizeof(report));
+    memset(&lamp, 0, sizeof(lamp));
+    frames = 0;
+    sleeps = 0;
+
+    // Start just before a wrap of the timer
+    hostTime = 0xFF00;
+    nextSof  = hostTime + SOF_TICKS;
+    sei();
+
+    DeadlineScheduler_Init();
+
+    while (frames < FRAMES)
+      DeadlineScheduler_RunOnce();
+
+    DeadlineTaskEntry_t* reportEntry = &DeadlineScheduler_TaskList[REPORT_TASK];
+    DeadlineTaskEntry_t* lampEntry   = &DeadlineScheduler_TaskList[LAMP_TASK];
+
+    printf("deadline %4luus: %lu frames, %lu reports, %lu sleeps\n",
+           (unsigned long) deadline * 8, (unsigned long) frames, (unsigned long) report.Runs, (unsigned long) sleeps);
+    printf("  report: latency %3luus, recorded %3luus, %3u late\n",
+           (unsigned long) report.MaxLatency * 8, (unsigned long) reportEntry->MaxStartLatency * 8,
+           reportEntry->DeadlineMisses);
+    printf("  lamp:   latency %3luus, recorded %3luus, %3u late\n",
+           (unsigned long) lamp.MaxLatency * 8, (unsigned long) lampEntry->MaxStartLatency * 8,
+           lampEntry->DeadlineMisses);
+
+    // Never longer than the longest task it can wait behind
+    HOST_CHECK(report.MaxLatency <= LOAD_MAX_COST + PASS_TICKS);
+    HOST_CHECK(reportEntry->MaxStartLatency <= LOAD_MAX_COST + PASS_TICKS);
+    HOST_CHECK(report.Runs >= frames);
+}
+
+int main(void)
+{
+    // The load task outlasts the firmware's deadline
+    Simulate(DEADLINE_SCHEDULER_US_TO_TICKS(100));
+    HOST_CHECK(DeadlineScheduler_TaskList[REPORT_TASK].DeadlineMisses > 0);
+
+    // But not the bound
+    Simulate(LOAD_MAX_COST + PASS_TICKS);
+    HOST_CHECK(DeadlineScheduler_TaskList[REPORT_TASK].DeadlineMisses == 0);
+
+    printf("Scheduler: OK\n");
+    return 0;
+}
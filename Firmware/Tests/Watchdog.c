@@ -0,0 +1,236 @@
+/*
+  Pop'n Convertible Arcade Style Controller Project
+ 
+  Copyright 2011 Sam Wong (Sam /@/ hellosam /./ net)
+
+  This work is licensed under the Creative Commons Attribution 3.0 
+  Hong Kong License. 
+
+  To view a copy of this license, visit 
+  http://creativecommons.org/licenses/by/3.0/hk/ or send a letter to 
+  Creative Commons, 444 Castro Street, Suite 900, 
+  Mountain View, California, 94041, USA.  
+*/
+
+/** Watchdog.c: heartbeats, pets and the reset record.
+ *
+ * Pets are counted through the host's wdt_reset(), and the first timeout
+ * is played as the hardware takes it: WDIE cleared, then the interrupt.
+ *
+ * Watchdog_Service() must pet only once every required heartbeat has
+ * come in since the last pet: the SOF scan and the report task while
+ * configured, only the task otherwise. Random beats and service calls are
+ * checked against that. Watchdog_Progress() pets whatever the beats.
+ *
+ * A pet after the first timeout is late: it must re-arm WDIE, clear the
+ * record the interrupt left, and count Late, saturating. A timeout that is
+ * not recovered leaves the missing beats and the operation in .noinit.
+ *
+ * Watchdog_Init() is run on faked .noinit records and reset flags: a
+ * watchdog reset reports the record and counts the reset, saturating; a
+ * power-on, a brown-out or a bad magic clears the record first.
+ */
+
+#include "Host/Host.h"
+
+// The firmware file itself, for its .noinit record
+#include "../Watchdog.c"
+
+/// Random service calls
+#define SERVICES 1000000UL
+
+volatile uint8_t USB_DeviceState = DEVICE_STATE_Configured;
+
+/** First timeout: the hardware clears WDIE and takes the interrupt */
+static void Timeout(void)
+{
+    HOST_CHECK(WDTCSR & _BV(WDIE));
+    WDTCSR &= ~_BV(WDIE);
+    WDT_vect();
+}
+
+/** Reset with the given MCUSR, and boot as far as Watchdog_Init() */
+static void Reset(uint8_t flags)
+{
+    MCUSR = flags;
+    WDTCSR = 0;
+    Watchdog_CatchReset();
+    HOST_CHECK(MCUSR == 0);
+
+    memset(&report, 0, sizeof(report));
+    Watchdog_Init();
+    HOST_CHECK(WDTCSR == (_BV(WDIE) | _BV(WDE) | WATCHDOG_PRESCALER));
+}
+
+static WatchdogReport_t Report(void)
+{
+    uint8_t data[WATCHDOG_FEATURE_REPORT_SIZE];
+    WatchdogReport_t copy;
+
+    Watchdog_CreateFeatureReport(data);
+    memcpy(&copy, data, sizeof(copy));
+    return copy;
+}
+
+static void TestInit(void)
+{
+    WatchdogReport_t r;
+
+    // Power-on with whatever was in RAM
+    memset(&resetLog, 0xA5, sizeof(resetLog));
+    Reset(_BV(PORF));
+    r = Report();
+    HOST_CHECK(r.ResetFlags == _BV(PORF));
+    HOST_CHECK(r.Missing == 0 && r.Operation == WATCHDOG_OP_NONE && r.Resets == 0 && r.Late == 0);
+    HOST_CHECK(resetLog.Magic == WATCHDOG_MAGIC);
+
+    // A watchdog reset with a record left by the interrupt
+    resetLog.Missing = WATCHDOG_BEAT_SOF;
+    resetLog.Operation = WATCHDOG_OP_DRIVE_WRITE;
+    resetLog.Resets = 3;
+    Reset(_BV(WDRF));
+    r = Report();
+    HOST_CHECK(r.ResetFlags == _BV(WDRF));
+    HOST_CHECK(r.Missing == WATCHDOG_BEAT_SOF);
+    HOST_CHECK(r.Operation == WATCHDOG_OP_DRIVE_WRITE);
+    HOST_CHECK(r.Resets == 4);
+    HOST_CHECK(resetLog.Missing == 0 && resetLog.Operation == WATCHDOG_OP_NONE);
+
+    // Another reset, external this time: reported, the count kept
+    Reset(_BV(EXTRF));
+    r = Report();
+    HOST_CHECK(r.ResetFlags == _BV(EXTRF) && r.Missing == 0 && r.Resets == 4);
+
+    // A watchdog reset count saturates
+    resetLog.Resets = 0xFE;
+    Reset(_BV(WDRF));
+    HOST_CHECK(Report().Resets == 0xFF);
+    Reset(_BV(WDRF));
+    HOST_CHECK(Report().Resets == 0xFF);
+
+    // A bad magic is not a record, even after a watchdog reset
+    resetLog.Magic = ~WATCHDOG_MAGIC;
+    resetLog.Missing = WATCHDOG_BEAT_REPORT;
+    resetLog.Resets = 7;
+    Reset(_BV(WDRF));
+    r = Report();
+    HOST_CHECK(r.Missing == 0 && r.Resets == 1);
+
+    // A brown-out clears the count
+    Reset(_BV(BORF));
+    HOST_CHECK(Report().Resets == 0);
+}
+
+static void TestService(void)
+{
+    uint32_t pets = 0;
+    uint32_t notConfigured = 0;
+    uint8_t seen = 0;
+
+    Reset(_BV(PORF));
+
+    for (uint32_t i = 0; i < SERVICES; i++)
+    {
+        uint8_t required;
+        uint32_t before = Host_WdtResets;
+
+        // Now and then the device is not configured, and there are no SOFs
+        USB_DeviceState = (Host_Random() % 16 == 0) ? DEVICE_STATE_Powered : DEVICE_STATE_Configured;
+        required = (USB_DeviceState == DEVICE_STATE_Configured) ?
+                   (WATCHDOG_BEAT_SOF | WATCHDOG_BEAT_REPORT) : WATCHDOG_BEAT_REPORT;
+        notConfigured += (USB_DeviceState != DEVICE_STATE_Configured);
+
+        if (Host_Random() % 3 == 0)
+          Watchdog_Beat(WATCHDOG_BEAT_SOF), seen |= WATCHDOG_BEAT_SOF;
+        if (Host_Random() % 3 == 0)
+          Watchdog_Beat(WATCHDOG_BEAT_REPORT), seen |= WATCHDOG_BEAT_REPORT;
+
+        Watchdog_Service();
+
+        if ((seen & required) == required)
+        {
+            HOST_CHECK(Host_WdtResets == before + 1);
+            seen = 0;
+            pets++;
+        } else {
+            HOST_CHECK(Host_WdtResets == before);
+        }
+    }
+
+    USB_DeviceState = DEVICE_STATE_Configured;
+    HOST_CHECK(Report().Late == 0);
+
+    printf("%lu service calls, %lu pets, %lu not configured\n",
+           (unsigned long) SERVICES, (unsigned long) pets, (unsigned long) notConfigured);
+}
+
+static void TestLate(void)
+{
+    uint32_t before;
+
+    Reset(_BV(PORF));
+
+    // The task stops: the first timeout records the missing beat
+    Watchdog_Beat(WATCHDOG_BEAT_SOF);
+    Watchdog_Service();
+    Timeout();
+    HOST_CHECK(resetLog.Missing == WATCHDOG_BEAT_REPORT);
+    HOST_CHECK(resetLog.Operation == WATCHDOG_OP_NONE);
+
+    // It comes back before the second: a late pet, the interrupt armed again
+    before = Host_WdtResets;
+    Watchdog_Beat(WATCHDOG_BEAT_REPORT);
+    Watchdog_Service();
+    HOST_CHECK(Host_WdtResets == before + 1);
+    HOST_CHECK(WDTCSR & _BV(WDIE));
+    HOST_CHECK(resetLog.Missing == 0);
+    HOST_CHECK(Report().Late == 1);
+
+    // An on-time pet is not late
+    Watchdog_Beat(WATCHDOG_BEAT_SOF | WATCHDOG_BEAT_REPORT);
+    Watchdog_Service();
+    HOST_CHECK(Report().Late == 1);
+
+    // A long operation: its breadcrumb is recorded, and a progress pet is late like any other
+    Watchdog_Progress(WATCHDOG_OP_DRIVE_READ);
+    Timeout();
+    HOST_CHECK(resetLog.Missing == (WATCHDOG_BEAT_SOF | WATCHDOG_BEAT_REPORT | WATCHDOG_BEAT_LOOP));
+    HOST_CHECK(resetLog.Operation == WATCHDOG_OP_DRIVE_READ);
+    Watchdog_Progress(WATCHDOG_OP_DRIVE_READ);
+    HOST_CHECK(WDTCSR & _BV(WDIE));
+    HOST_CHECK(resetLog.Operation == WATCHDOG_OP_NONE);
+    HOST_CHECK(Report().Late == 2);
+
+    // Progress pets without any beats; the main loop's pet ends the operation
+    before = Host_WdtResets;
+    Watchdog_Progress(WATCHDOG_OP_DRIVE_READ);
+    Watchdog_Progress(WATCHDOG_OP_DRIVE_READ);
+    HOST_CHECK(Host_WdtResets == before + 2);
+    Watchdog_Beat(WATCHDOG_BEAT_SOF | WATCHDOG_BEAT_REPORT);
+    Watchdog_Service();
+    Timeout();
+    HOST_CHECK(resetLog.Operation == WATCHDOG_OP_NONE);
+
+    // Not recovered: the record survives into the next boot
+    Reset(_BV(WDRF));
+    HOST_CHECK(Report().Missing == (WATCHDOG_BEAT_SOF | WATCHDOG_BEAT_REPORT | WATCHDOG_BEAT_LOOP));
+    HOST_CHECK(Report().Late == 0 && Report().Resets == 1);
+
+    // Late saturates
+    for (uint32_t i = 0; i < 0x10000; i++)
+    {
+        Timeout();
+        Watchdog_Progress(WATCHDOG_OP_NONE);
+    }
+    HOST_CHECK(Report().Late == 0xFFFF);
+}
+
+int main(void)
+{
+    TestInit();
+    TestService();
+    TestLate();
+
+    printf("Watchdog: OK\n");
+    return 0;
+}
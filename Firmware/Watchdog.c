@@ -0,0 +1,199 @@
+/*
+  Pop'n Convertible Arcade Style Controller Project
+ 
+  Copyright 2011 Sam Wong (Sam /@/ hellosam /./ net)
+
+  This work is licensed under the Creative Commons Attribution 3.0 
+  Hong Kong License. 
+
+  To view a copy of this license, visit 
+  http://creativecommons.org/licenses/by/3.0/hk/ or send a letter to 
+  Creative Commons, 444 Castro Street, Suite 900, 
+  Mountain View, California, 94041, USA.  
+*/
+
+#include "Watchdog.h"
+#include "Telemetry.h"
+#include "Console.h"
+
+#include <LUFA/Drivers/USB/USB.h>
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+#include <string.h>
+
+/// Marks a reset log that has survived a reset
+#define WATCHDOG_MAGIC 0x5744
+
+/// WDTCSR prescaler bits of WATCHDOG_TIMEOUT
+#define WATCHDOG_PRESCALER (((WATCHDOG_TIMEOUT & 0x08) ? _BV(WDP3) : 0) | (WATCHDOG_TIMEOUT & 0x07))
+
+/** Kept across resets, and cleared at power-on, brown-out or a bad magic */
+typedef struct
+{
+    uint16_t Magic;
+    uint8_t  Missing;
+    uint8_t  Operation;
+    uint8_t  Resets;
+} WatchdogLog_t;
+
+/// Record left by the watchdog interrupt for the next boot
+static WatchdogLog_t resetLog __attribute__((section(".noinit")));
+/// MCUSR as found at reset
+static uint8_t resetFlags __attribute__((section(".noinit")));
+
+/// The last reset, as reported
+static WatchdogReport_t report;
+/// [Bitmap] WATCHDOG_BEAT_* seen since the last pet
+static volatile uint8_t beats;
+/// WATCHDOG_OP_* of the last progress pet, until the main loop pets again
+static volatile uint8_t operation;
+
+void Watchdog_CatchReset(void) __attribute__((naked, used, section(".init3")));
+
+/** Save and clear the reset flags, then stop the watchdog: after a watchdog reset it is still
+ *  running, and would reset again before main(). In .init3, ahead of the .data and .bss setup,
+ *  so only .noinit may be written. Naked, as the code falls through into .init4.
+ */
+void Watchdog_CatchReset(void)
+{
+    resetFlags = MCUSR;
+    MCUSR = 0;
+    wdt_disable();
+}
+
+/** [Bitmap] Heartbeats needed for a pet; there are no SOFs until configured */
+static uint8_t Watchdog_Required(void)
+{
+    if (USB_DeviceState == DEVICE_STATE_Configured)
+      return WATCHDOG_BEAT_LOOP | WATCHDOG_BEAT_REPORT | WATCHDOG_BEAT_SOF;
+
+    return WATCHDOG_BEAT_LOOP | WATCHDOG_BEAT_REPORT;
+}
+
+/** Restart the timeouts, with interrupts disabled. If the first timeout has been taken,
+ *  this is a late pet: the record is not of a reset, and the interrupt is armed again.
+ */
+static void Watchdog_Pet(void)
+{
+    wdt_reset();
+    beats = 0;
+
+    if (!(WDTCSR & _BV(WDIE)))
+    {
+        resetLog.Missing = 0;
+        resetLog.Operation = WATCHDOG_OP_NONE;
+        if (report.Late != 0xFFFF)
+          report.Late++;
+        CONSOLE_LOG("watchdog late ", report.Late);
+
+        // Only WDE and the prescaler need the timed sequence
+        WDTCSR |= _BV(WDIE);
+    }
+}
+
+/** First timeout: record what was missing, for the reset that follows at the second */
+ISR(WDT_vect)
+{
+    resetLog.Missing = Watchdog_Required() & ~beats;
+    resetLog.Operation = operation;
+}
+
+/** Report why the last reset happened, then start the watchdog */
+void Watchdog_Init(void)
+{
+    if ((resetFlags & (_BV(PORF) | _BV(BORF))) || resetLog.Magic != WATCHDOG_MAGIC)
+    {
+        memset(&resetLog, 0, sizeof(resetLog));
+        resetLog.Magic = WATCHDOG_MAGIC;
+    }
+
+    report.ResetFlags = resetFlags;
+    if (resetFlags & _BV(WDRF))
+    {
+        report.Missing = resetLog.Missing;
+        report.Operation = resetLog.Operation;
+        if (resetLog.Resets != 0xFF)
+          resetLog.Resets++;
+    }
+    report.Resets = resetLog.Resets;
+
+    resetLog.Missing = 0;
+    resetLog.Operation = WATCHDOG_OP_NONE;
+
+    Watchdog_Start();
+}
+
+/** Run the watchdog in interrupt and reset mode */
+void Watchdog_Start(void)
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        beats = 0;
+        wdt_reset();
+        WDTCSR = _BV(WDCE) | _BV(WDE);
+        WDTCSR = _BV(WDIE) | _BV(WDE) | WATCHDOG_PRESCALER;
+    }
+}
+
+void Watchdog_Stop(void)
+{
+    wdt_disable();
+}
+
+void Watchdog_Beat(uint8_t beat)
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        beats |= beat;
+    }
+}
+
+/** Pet from the main loop, once every required heartbeat has come in */
+void Watchdog_Service(void)
+{
+    uint8_t required = Watchdog_Required();
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        beats |= WATCHDOG_BEAT_LOOP;
+
+        if ((beats & required) == required)
+        {
+            operation = WATCHDOG_OP_NONE;
+            Watchdog_Pet();
+        }
+    }
+}
+
+/** Pet from inside a long operation, after a step which got somewhere */
+void Watchdog_Progress(uint8_t op)
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        operation = op;
+        Watchdog_Pet();
+    }
+}
+
+void Watchdog_CreateFeatureReport(uint8_t* data)
+{
+    memcpy(data, &report, sizeof(report));
+}
+
+#if defined(TELEMETRY_ENABLED)
+/** Send the reset record; from the SOF event. Late is only counted with interrupts disabled, so it reads whole. */
+void Watchdog_SendReset(void)
+{
+    Telemetry_SendFrame(TELEMETRY_FRAME_RESET, (const uint8_t*) &report, sizeof(report));
+}
+#endif
+
+#if defined(DEBUG_CONSOLE_ENABLED)
+/** Log the reset flags (high byte) and the heartbeats missing at a watchdog reset (low byte) */
+void Watchdog_LogReset(void)
+{
+    CONSOLE_LOG("reset ", ((uint16_t) report.ResetFlags << 8) | report.Missing);
+}
+#endif
@@ -0,0 +1,95 @@
+/*
+  Pop'n Convertible Arcade Style Controller Project
+ 
+  Copyright 2011 Sam Wong (Sam /@/ hellosam /./ net)
+
+  This work is licensed under the Creative Commons Attribution 3.0 
+  Hong Kong License. 
+
+  To view a copy of this license, visit 
+  http://creativecommons.org/licenses/by/3.0/hk/ or send a letter to 
+  Creative Commons, 444 Castro Street, Suite 900, 
+  Mountain View, California, 94041, USA.  
+*/
+
+#ifndef _WATCHDOG_H_
+#define _WATCHDOG_H_
+
+#include <avr/wdt.h>
+#include <stdint.h>
+
+/** Watchdog supervisor.
+ *
+ * The watchdog is only petted by Watchdog_Service() from the main loop,
+ * and only once every required heartbeat has been seen since the last
+ * pet: the SOF scan (while configured) and the report task. A loop that
+ * still runs while the scan or the task has stopped thus resets too.
+ * Long operations which hold up the main loop for good reason pet it
+ * with Watchdog_Progress() after each step of real progress instead,
+ * leaving their WATCHDOG_OP_* as a breadcrumb.
+ *
+ * The watchdog runs in interrupt and reset mode. The first timeout calls
+ * the interrupt, which records the missing heartbeats and the breadcrumb
+ * in .noinit; the second one resets. The record survives the reset, and
+ * is reported at the next boot with the reset flags and a count of
+ * watchdog resets since power-on. A watchdog reset without a record had
+ * interrupts disabled. A late pet between the two timeouts recovers and
+ * is only counted.
+ *
+ * Feature report (HID_REPORTID_WATCHDOG, WATCHDOG_FEATURE_REPORT_SIZE
+ * bytes), and with TELEMETRY_ENABLED a TELEMETRY_FRAME_RESET payload
+ * sent from the SOF event after the boot frame, see Boot.h (with
+ * DEBUG_CONSOLE_ENABLED, bytes 0 and 1 are also logged at boot):
+ *  GET: Byte 0:   MCUSR reset flags of the last reset
+ *       Byte 1:   [Bitmap] WATCHDOG_BEAT_* missing at a watchdog reset,
+ *                 0 if none was recorded
+ *       Byte 2:   WATCHDOG_OP_* in progress at a watchdog reset
+ *       Byte 3:   Watchdog resets since power-on (saturating)
+ *       Byte 4-5: Late pets recovered since this reset (saturating)
+ */
+
+/// Time to each of the two timeouts, as a WDTO_* value
+#ifndef WATCHDOG_TIMEOUT
+#define WATCHDOG_TIMEOUT WDTO_250MS
+#endif
+
+/// Feature report payload size, excluding the report ID
+#define WATCHDOG_FEATURE_REPORT_SIZE 32
+
+/// Heartbeats, as bits
+#define WATCHDOG_BEAT_SOF    0x01
+#define WATCHDOG_BEAT_REPORT 0x02
+#define WATCHDOG_BEAT_LOOP   0x80
+
+/// Long operations, as breadcrumbs
+enum
+{
+    WATCHDOG_OP_NONE,
+    WATCHDOG_OP_DRIVE_READ,
+    WATCHDOG_OP_DRIVE_WRITE,
+};
+
+typedef struct
+{
+    uint8_t  ResetFlags;
+    uint8_t  Missing;
+    uint8_t  Operation;
+    uint8_t  Resets;
+    uint16_t Late;
+} WatchdogReport_t;
+
+void Watchdog_Init(void);
+void Watchdog_Start(void);
+void Watchdog_Stop(void);
+void Watchdog_Beat(uint8_t beat);
+void Watchdog_Service(void);
+void Watchdog_Progress(uint8_t operation);
+void Watchdog_CreateFeatureReport(uint8_t* data);
+#if defined(TELEMETRY_ENABLED)
+void Watchdog_SendReset(void);
+#endif
+#if defined(DEBUG_CONSOLE_ENABLED)
+void Watchdog_LogReset(void);
+#endif
+
+#endif
@@ -0,0 +1,104 @@
+#!/usr/bin/env python3
+"""Dump and decode the Pop'n controller's black-box recording.
+
+The firmware must be built with RECORDER_ENABLED (see Firmware/Recorder.h).
+
+    recorder.py dump FILE     save the raw pages of the dataflash to FILE
+    recorder.py decode FILE   print the button edges in a saved dump
+    recorder.py               dump and print straight away
+
+Dumping needs pyusb, and on Windows a WinUSB driver bound to the
+recorder interface.
+"""
+
+import struct
+import sys
+
+VENDOR_ID = 0x03EB
+PRODUCT_ID = 0x2042
+
+# Must match Recorder.h and Descriptors.h
+REQUEST_DUMP = 0x01
+PAGE_SIZE = 1024
+HEADER = struct.Struct('<IHBB')   # Sequence, Session, Count, Dropped
+RECORD = struct.Struct('<II')     # Time (ms), State
+SEQUENCE_ERASED = 0xFFFFFFFF
+
+
+def dump():
+    import usb.core
+    import usb.util
+
+    device = usb.core.find(idVendor=VENDOR_ID, idProduct=PRODUCT_ID)
+    if device is None:
+        sys.exit('Controller not found')
+
+    interface = usb.util.find_descriptor(device.get_active_configuration(),
+                                         bInterfaceClass=0xFF)
+    if interface is None:
+        sys.exit('No recorder interface; is the firmware built with RECORDER_ENABLED?')
+
+    endpoint = interface[0].bEndpointAddress
+    request_type = usb.util.build_request_type(usb.util.CTRL_OUT, usb.util.CTRL_TYPE_VENDOR,
+                                               usb.util.CTRL_RECIPIENT_INTERFACE)
+    device.ctrl_transfer(request_type, REQUEST_DUMP, 0, interface.bInterfaceNumber)
+
+    # Whole pages, then a zero length packet; a read ends short only at
+    # that packet, and one that ended on it exactly is followed by an empty read
+    data = bytearray()
+    while True:
+        chunk = device.read(endpoint, PAGE_SIZE * 16, timeout=5000)
+        data += chunk
+        if len(chunk) < PAGE_SIZE * 16:
+            break
+
+    return bytes(data)
+
+
+def decode(data, out=sys.stdout):
+    session = None
+    last_state = 0
+
+    for offset in range(0, len(data) - PAGE_SIZE + 1, PAGE_SIZE):
+        sequence, page_session, count, dropped = HEADER.unpack_from(data, offset)
+        if sequence == SEQUENCE_ERASED:
+            continue
+
+        if page_session != session:
+            session = page_session
+            last_state = 0
+            out.write('Session %d\n' % session)
+
+        if dropped:
+            out.write('  %d edge(s) dropped\n' % dropped)
+
+        for i in range(count):
+            time, state = RECORD.unpack_from(data, offset + HEADER.size + i * RECORD.size)
+            change = state ^ last_state
+            pressed = [bit for bit in range(32) if change & state & (1 << bit)]
+            released = [bit for bit in range(32) if change & ~state & (1 << bit)]
+            last_state = state
+
+            out.write('  %8.3f  state %08X' % (time / 1000.0, state))
+            if pressed:
+                out.write('  down %s' % ' '.join(str(bit) for bit in pressed))
+            if released:
+                out.write('  up %s' % ' '.join(str(bit) for bit in released))
+            out.write('\n')
+
+
+def main(args):
+    if len(args) == 2 and args[0] == 'dump':
+        with open(args[1], 'wb') as f:
+            f.write(dump())
+    elif len(args) == 2 and args[0] == 'decode':
+        with open(args[1], 'rb') as f:
+            decode(f.read())
+    elif not args:
+        decode(dump())
+    else:
+        sys.exit(__doc__)
+
+
+if __name__ == '__main__':
+    main(sys.argv[1:])
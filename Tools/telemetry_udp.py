@@ -0,0 +1,104 @@
+#!/usr/bin/env python3
+"""Receive the Pop'n controller's telemetry over Ethernet-over-USB.
+
+The firmware must be built with TELEMETRY_ENABLED and NETWORK_ENABLED
+(see Firmware/Network.h), and the RNDIS interface needs a link-local
+address, e.g. on Linux:
+
+    ip addr add 169.254.80.1/16 dev usb0 && ip link set usb0 up
+
+    telemetry_udp.py          print each frame, and the rate every second
+    telemetry_udp.py -q       print the rate only
+
+The rate line counts datagrams and bytes per second, bad frames, and the
+device's own count of frames dropped because its queue was full (from the
+status frames).
+"""
+
+import socket
+import struct
+import sys
+import time
+
+# Must match Network.h and Telemetry.h
+UDP_PORT = 5005
+SYNC = 0xA5
+FRAME_BUTTON_EDGE = 0x01
+FRAME_STATUS = 0x02
+FRAME_BOOT = 0x03
+FRAME_RESET = 0x04
+
+
+def crc8(data):
+    """CRC-8 as _crc_ibutton_update"""
+    crc = 0
+    for byte in data:
+        crc ^= byte
+        for _ in range(8):
+            crc = (crc >> 1) ^ 0x8C if crc & 1 else crc >> 1
+    return crc
+
+
+def describe(kind, payload):
+    if kind == FRAME_BUTTON_EDGE:
+        size = (len(payload) - 2) // 2
+        frame, = struct.unpack_from('<H', payload)
+        state = int.from_bytes(payload[2:2 + size], 'little')
+        change = int.from_bytes(payload[2 + size:], 'little')
+        return 'edge   frame %5d  state %0*X  change %0*X' % (frame, size * 2, state, size * 2, change)
+    if kind == FRAME_STATUS:
+        return 'status dropped %d  rx dropped %d  rx overruns %d' % struct.unpack_from('<HHH', payload)
+    if kind == FRAME_BOOT:
+        return 'boot   ' + '  '.join('%.3fms' % (t / 1000.0) for t in struct.unpack_from('<4I', payload))
+    if kind == FRAME_RESET:
+        return 'reset  flags %02X  missing %02X  op %d  watchdog resets %d  late %d' % struct.unpack_from('<BBBBH', payload)
+    return 'type %02X  %s' % (kind, payload.hex())
+
+
+def main(args):
+    quiet = args == ['-q']
+    if args and not quiet:
+        sys.exit(__doc__)
+
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    sock.bind(('', UDP_PORT))
+    sock.settimeout(1.0)
+
+    datagrams = octets = bad = 0
+    dropped = None
+    start = time.monotonic()
+
+    while True:
+        try:
+            data = sock.recv(2048)
+        except socket.timeout:
+            data = None
+
+        if data:
+            datagrams += 1
+            octets += len(data)
+
+            if len(data) < 4 or data[0] != SYNC or data[2] + 4 != len(data) or crc8(data[1:-1]) != data[-1]:
+                bad += 1
+            else:
+                payload = data[3:-1]
+                if data[1] == FRAME_STATUS:
+                    dropped, = struct.unpack_from('<H', payload)
+                if not quiet:
+                    print(describe(data[1], payload))
+
+        now = time.monotonic()
+        if now - start >= 1.0:
+            print('-- %d datagrams/s  %d bytes/s  %d bad  device dropped %s' %
+                  (datagrams / (now - start), octets / (now - start), bad,
+                   '?' if dropped is None else dropped))
+            datagrams = octets = bad = 0
+            start = now
+
+
+if __name__ == '__main__':
+    try:
+        main(sys.argv[1:])
+    except KeyboardInterrupt:
+        pass